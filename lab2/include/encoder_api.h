@@ -0,0 +1,108 @@
+#ifndef ENCODER_API_H
+#define ENCODER_API_H
+
+/**
+ * @file encoder_api.h
+ * @brief Rotary encoder input API with GPIO and evdev backends
+ *
+ * This header provides one interface for reading a quadrature rotary
+ * encoder (plus an optional push switch). The GPIO backend decodes the
+ * Gray code in userspace from edge events on the A/B lines. The evdev
+ * backend reads the kernel rotary-encoder (EV_REL) and gpio-keys (EV_KEY)
+ * drivers through /dev/input/eventX, so the kernel does the decoding and
+ * userspace wakes once per batch of detents.
+ */
+
+#include <gpiod.h>
+#include <stddef.h>
+#include "pinmap_api.h"
+#include <time.h>
+#include <linux/input-event-codes.h>
+
+#define ENCODER_EVDEV_AXIS REL_X    // rotary-encoder default (linux,axis = <0>)
+#define ENCODER_EVDEV_KEY KEY_ENTER // Push switch code in the gpio-keys node
+
+/**
+ * @brief Input accumulated by one encoder_read() call
+ */
+struct encoder_report {
+    int steps;   /**< Net detents: positive = forward, negative = backward */
+    int presses; /**< Push-switch presses (key down events) */
+};
+
+/**
+ * @brief Initializes the GPIO backend
+ *
+ * Both pins must be PIN_EDGE_BOTH entries of a pin map. The current
+ * line levels are read once to seed the decoder state.
+ *
+ * @param a The edge pin for encoder channel A
+ * @param b The edge pin for encoder channel B
+ * @param debounce_ms Minimum time between two accepted steps
+ * @return 0 on success, -1 on error
+ */
+int encoder_init_gpio(struct pin_edge a, struct pin_edge b, int debounce_ms);
+
+/**
+ * @brief Initializes the evdev backend
+ *
+ * Opens the input device(s) non-blocking. The rotary-encoder driver and
+ * gpio-keys usually register separate devices; pass NULL for key_path if
+ * there is no push switch or both are reported by the same device.
+ *
+ * Only rel_axis counts as steps and only key_code as presses; other axes
+ * and keys on the same devices are ignored. Events are applied a frame
+ * (SYN_REPORT) at a time. After SYN_DROPPED the broken frame is thrown
+ * away and the switch state is re-read with EVIOCGKEY; detents lost in
+ * the overflow cannot be recovered, since EV_REL has no absolute state.
+ *
+ * @param rel_path Device path reporting EV_REL (e.g. /dev/input/event0)
+ * @param key_path Device path reporting EV_KEY, or NULL
+ * @param rel_axis The encoder's axis (ENCODER_EVDEV_AXIS)
+ * @param key_code The push switch's key code (ENCODER_EVDEV_KEY)
+ * @return 0 on success, -1 on error
+ */
+int encoder_init_evdev(const char *rel_path, const char *key_path, int rel_axis, int key_code);
+
+/**
+ * @brief Finds an input device by its name
+ *
+ * Scans /dev/input/event* and compares each device's EVIOCGNAME string
+ * with the requested name.
+ *
+ * @param name The device name (e.g. "rotary@e" or a uinput device name)
+ * @param path Buffer receiving the matching /dev/input/eventX path
+ * @param len Size of the path buffer
+ * @return 0 if found, -1 otherwise
+ */
+int encoder_find_evdev(const char *name, char *path, size_t len);
+
+/**
+ * @brief Waits for encoder input
+ *
+ * @param timeout Maximum time to wait, or NULL to wait forever
+ * @return 1 if input is ready, 0 on timeout, -1 on error
+ */
+int encoder_wait(const struct timespec *timeout);
+
+/**
+ * @brief Drains all pending encoder input
+ *
+ * Reads queued events in batches until none are left and decodes them
+ * into a net step count and number of presses. Does not block. The GPIO
+ * backend merges at most 1024 edges per call; anything beyond that stays
+ * queued and is returned by the next call.
+ *
+ * @param report Receives the accumulated steps and presses
+ * @return Number of raw events consumed, or -1 on error
+ */
+int encoder_read(struct encoder_report *report);
+
+/**
+ * @brief Releases the resources held by the active backend
+ *
+ * GPIO pins stay owned by the caller's pin map; evdev file descriptors are closed.
+ */
+void encoder_close(void);
+
+#endif // ENCODER_API_H
@@ -0,0 +1,45 @@
+#ifndef SYSCALL_COUNT_API_H
+#define SYSCALL_COUNT_API_H
+
+/**
+ * @file syscall_count_api.h
+ * @brief Counts the calling thread's syscalls for the benchmarks
+ *
+ * Uses a perf counter on the raw_syscalls:sys_enter tracepoint, which needs
+ * root or perf_event_paranoid <= 1. Without it syscall_count_open() fails
+ * and syscall_count_take() returns -1, so callers can print "n/a" (or fall
+ * back to strace -c).
+ *
+ * The counter starts disabled at zero. Enable it around the code to be
+ * measured with syscall_count_start() / syscall_count_pause(), then read
+ * and clear the total with syscall_count_take().
+ */
+
+/**
+ * @brief Opens the counter for the calling thread
+ * @return 0 on success, -1 if syscalls cannot be counted
+ */
+int syscall_count_open(void);
+
+/**
+ * @brief Starts (or resumes) counting
+ */
+void syscall_count_start(void);
+
+/**
+ * @brief Stops counting, keeping the total
+ */
+void syscall_count_pause(void);
+
+/**
+ * @brief Stops counting and returns the total, then resets it to zero
+ * @return Syscalls counted since the last take, or -1 if not available
+ */
+long long syscall_count_take(void);
+
+/**
+ * @brief Closes the counter
+ */
+void syscall_count_close(void);
+
+#endif // SYSCALL_COUNT_API_H
@@ -0,0 +1,351 @@
+#include "encoder_api.h"
+#include "trace_api.h"
+#include <gpiod.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+
+// Max events pulled from the kernel per line / device per read
+#define MAX_EVENTS 64
+#define MAX_DRAIN_EDGES (16 * MAX_EVENTS)  // Edges merged by one encoder_read()
+
+enum backend { BACKEND_NONE, BACKEND_GPIO, BACKEND_EVDEV };
+
+static enum backend backend = BACKEND_NONE;
+
+// GPIO backend state
+static struct pin_edge pin_a, pin_b;
+static int last_state;
+static long long last_change_ms;
+static int debounce;
+
+// evdev backend state: per device, the frame being read (applied on
+// SYN_REPORT) and whether events are being skipped after SYN_DROPPED
+struct evdev_dev {
+    int dropping;
+    int frame_steps;
+    int frame_presses;
+    int frame_key_down;         // -1 until the frame reports the switch
+};
+
+static int fds[2] = {-1, -1};
+static struct evdev_dev devs[2];
+static int num_fds;
+static int evdev_axis, evdev_key;
+static int key_down;            // Switch state as of the last applied frame
+
+// One edge from either encoder channel
+struct enc_edge {
+    long long t_ns;
+    int is_a;
+    int level;
+};
+
+static int timeout_ms(const struct timespec *timeout) {
+    if (!timeout) return -1;
+    return (int)(timeout->tv_sec * 1000 + timeout->tv_nsec / 1000000);
+}
+
+// Gray code transition table indexed by (last_state << 2) | state:
+// forward is 00->10->11->01->00, backward is the reverse
+static int decode_step(int from, int to) {
+    static const signed char STEP[16] = {
+         0, -1,  1,  0,
+         1,  0,  0, -1,
+        -1,  0,  0,  1,
+         0,  1, -1,  0,
+    };
+    return STEP[(from << 2) | to];
+}
+
+int encoder_init_gpio(struct pin_edge a_pin, struct pin_edge b_pin, int debounce_ms) {
+    int a = pin_edge_value(a_pin);
+    int b = pin_edge_value(b_pin);
+    if (a < 0 || b < 0) {
+        return -1;
+    }
+
+    pin_a = a_pin;
+    pin_b = b_pin;
+    last_state = (a << 1) | b;
+    last_change_ms = 0;
+    debounce = debounce_ms;
+    backend = BACKEND_GPIO;
+    return 0;
+}
+
+// Reads the switch's current state from the kernel after events were lost
+static int evdev_key_state(int fd) {
+    unsigned char keys[KEY_MAX / 8 + 1];
+    memset(keys, 0, sizeof(keys));
+    if (ioctl(fd, EVIOCGKEY(sizeof(keys)), keys) < 0) {
+        return -1;
+    }
+    return (keys[evdev_key / 8] >> (evdev_key % 8)) & 1;
+}
+
+int encoder_init_evdev(const char *rel_path, const char *key_path, int rel_axis, int key_code) {
+    num_fds = 0;
+    evdev_axis = rel_axis;
+    evdev_key = key_code;
+    key_down = 0;
+    memset(devs, 0, sizeof(devs));
+    devs[0].frame_key_down = devs[1].frame_key_down = -1;
+
+    fds[num_fds] = open(rel_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fds[num_fds] < 0) {
+        perror(rel_path);
+        return -1;
+    }
+    num_fds++;
+
+    if (key_path && strcmp(key_path, rel_path) != 0) {
+        fds[num_fds] = open(key_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fds[num_fds] < 0) {
+            perror(key_path);
+            close(fds[0]);
+            num_fds = 0;
+            return -1;
+        }
+        num_fds++;
+    }
+
+    backend = BACKEND_EVDEV;
+    return 0;
+}
+
+int encoder_find_evdev(const char *name, char *path, size_t len) {
+    glob_t g;
+    int found = -1;
+
+    if (glob("/dev/input/event*", 0, NULL, &g) != 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < g.gl_pathc && found < 0; i++) {
+        int fd = open(g.gl_pathv[i], O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) continue;
+
+        char dev_name[256] = "";
+        if (ioctl(fd, EVIOCGNAME(sizeof(dev_name)), dev_name) >= 0 &&
+            strcmp(dev_name, name) == 0) {
+            snprintf(path, len, "%s", g.gl_pathv[i]);
+            found = 0;
+        }
+        close(fd);
+    }
+
+    globfree(&g);
+    return found;
+}
+
+// Fills pfd with the active backend's file descriptors; returns how many
+static int fill_pollfds(struct pollfd *pfd) {
+    int n = 0;
+    if (backend == BACKEND_GPIO) {
+        pfd[n++].fd = pin_edge_fd(pin_a);
+        pfd[n++].fd = pin_edge_fd(pin_b);
+    } else {
+        for (int i = 0; i < num_fds; i++) {
+            pfd[n++].fd = fds[i];
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        pfd[i].events = POLLIN;
+        pfd[i].revents = 0;
+    }
+    return n;
+}
+
+int encoder_wait(const struct timespec *timeout) {
+    if (backend == BACKEND_NONE) {
+        return -1;
+    }
+
+    struct pollfd pfd[2];
+    int n = fill_pollfds(pfd);
+    int ret = poll(pfd, n, timeout_ms(timeout));
+    if (ret < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    return ret > 0 ? 1 : 0;
+}
+
+static int gpio_read(struct encoder_report *report) {
+    // Drain both channels until neither has events queued (or the buffer
+    // is full), then merge by kernel timestamp so the quadrature sequence
+    // is decoded in the order the edges happened
+    static struct enc_edge edges[MAX_DRAIN_EDGES];
+    int num_edges = 0;
+
+    while (num_edges <= MAX_DRAIN_EDGES - MAX_EVENTS) {
+        struct pollfd pfd[2];
+        fill_pollfds(pfd);
+
+        // The line fds block on read, so only read the ones poll reports
+        int ret = poll(pfd, 2, 0);
+        if (ret < 0 && errno != EINTR) {
+            return -1;
+        }
+        if (ret <= 0) {
+            break;
+        }
+
+        for (int i = 0; i < 2; i++) {
+            if (!(pfd[i].revents & POLLIN) || num_edges > MAX_DRAIN_EDGES - MAX_EVENTS) {
+                continue;
+            }
+            struct pin_event evs[MAX_EVENTS];
+            int n = pin_edge_read(i == 0 ? pin_a : pin_b, evs, MAX_EVENTS);
+            if (n < 0) {
+                return -1;
+            }
+            for (int k = 0; k < n; k++) {
+                struct enc_edge edge = {
+                    .t_ns = (long long)evs[k].ts_ns,
+                    .is_a = (i == 0),
+                    .level = (evs[k].type == PIN_EVENT_RISING),
+                };
+                // Insertion sort: each channel is already in order
+                int j = num_edges++;
+                while (j > 0 && edges[j - 1].t_ns > edge.t_ns) {
+                    edges[j] = edges[j - 1];
+                    j--;
+                }
+                edges[j] = edge;
+            }
+        }
+    }
+
+    for (int k = 0; k < num_edges; k++) {
+        int state = edges[k].is_a
+            ? (edges[k].level << 1) | (last_state & 1)
+            : (last_state & 2) | edges[k].level;
+
+        if (state == last_state) {
+            continue;
+        }
+
+        // Debounce on the edge's own timestamp, not the wake-up time
+        long long t = edges[k].t_ns / 1000000LL;
+        if (t - last_change_ms >= debounce) {
+            int direction = decode_step(last_state, state);
+            if (direction != 0) {
+                last_change_ms = t;
+                report->steps += direction;
+            }
+        }
+
+        last_state = state;
+    }
+
+    return num_edges;
+}
+
+// Applies one event of device i to its frame, and completed frames to
+// the report
+static void evdev_event(int i, const struct input_event *ev, struct encoder_report *report) {
+    struct evdev_dev *d = &devs[i];
+
+    if (d->dropping) {
+        // Skip up to the next report, then resynchronize the switch
+        if (ev->type == EV_SYN && ev->code == SYN_REPORT) {
+            d->dropping = 0;
+            int down = evdev_key_state(fds[i]);
+            if (down > 0 && !key_down) {
+                report->presses++;
+            }
+            if (down >= 0) {
+                key_down = down;
+            }
+        }
+        return;
+    }
+
+    switch (ev->type) {
+    case EV_SYN:
+        if (ev->code == SYN_REPORT) {
+            report->steps += d->frame_steps;
+            report->presses += d->frame_presses;
+            if (d->frame_key_down >= 0) {
+                key_down = d->frame_key_down;
+            }
+        } else if (ev->code == SYN_DROPPED) {
+            d->dropping = 1;
+        } else {
+            break;
+        }
+        d->frame_steps = 0;
+        d->frame_presses = 0;
+        d->frame_key_down = -1;
+        break;
+    case EV_REL:
+        if (ev->code == evdev_axis) {
+            d->frame_steps += ev->value;
+        }
+        break;
+    case EV_KEY:
+        // value 2 is autorepeat of a key already down
+        if (ev->code == evdev_key) {
+            int was_down = d->frame_key_down >= 0 ? d->frame_key_down : key_down;
+            if (ev->value == 1 && !was_down) {
+                d->frame_presses++;
+            }
+            d->frame_key_down = ev->value != 0;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static int evdev_read(struct encoder_report *report) {
+    int consumed = 0;
+
+    for (int i = 0; i < num_fds; i++) {
+        struct input_event evs[MAX_EVENTS];
+        ssize_t len;
+
+        while ((len = read(fds[i], evs, sizeof(evs))) > 0) {
+            int n = (int)(len / sizeof(evs[0]));
+            for (int k = 0; k < n; k++) {
+                evdev_event(i, &evs[k], report);
+            }
+            consumed += n;
+        }
+
+        if (len < 0 && errno != EAGAIN && errno != EINTR) {
+            return -1;
+        }
+    }
+
+    return consumed;
+}
+
+int encoder_read(struct encoder_report *report) {
+    report->steps = 0;
+    report->presses = 0;
+
+    TRACE_BEGIN(TRACE_ENCODER_READ, 0);
+    int n = -1;
+    if (backend == BACKEND_GPIO) n = gpio_read(report);
+    else if (backend == BACKEND_EVDEV) n = evdev_read(report);
+    TRACE_END(TRACE_ENCODER_READ, n);
+    return n;
+}
+
+void encoder_close(void) {
+    for (int i = 0; i < num_fds; i++) {
+        close(fds[i]);
+        fds[i] = -1;
+    }
+    num_fds = 0;
+    pin_a.group = pin_b.group = NULL;
+    backend = BACKEND_NONE;
+}
@@ -0,0 +1,159 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/uinput.h>
+
+#include "encoder_api.h"
+
+/*
+ * Self-check for the evdev encoder backend using a virtual uinput device.
+ * Runs on any Linux host with /dev/uinput (no Pi, no encoder needed):
+ *
+ *   sudo modprobe uinput
+ *   sudo ./encoder_uinput_check
+ *
+ * A fake "rotary encoder + push switch" emits a known sequence of REL_X
+ * detents and KEY_ENTER presses in bursts; the totals decoded through
+ * encoder_read() must match exactly.
+ */
+
+#define DEVICE_NAME "lab2-uinput-encoder"
+#define NUM_BURSTS 500
+#define BURST_LEN 8         // Detents emitted between two reads
+#define PRESS_EVERY 50      // One key press every N bursts
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int emit(int fd, int type, int code, int value) {
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    return write(fd, &ev, sizeof(ev)) == (ssize_t)sizeof(ev) ? 0 : -1;
+}
+
+static int create_device(void) {
+    int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    if (fd < 0) {
+        perror("/dev/uinput");
+        return -1;
+    }
+
+    ioctl(fd, UI_SET_EVBIT, EV_REL);
+    ioctl(fd, UI_SET_RELBIT, REL_X);
+    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(fd, UI_SET_KEYBIT, KEY_ENTER);
+
+    struct uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1234;
+    setup.id.product = 0x5678;
+    snprintf(setup.name, UINPUT_MAX_NAME_SIZE, "%s", DEVICE_NAME);
+
+    if (ioctl(fd, UI_DEV_SETUP, &setup) < 0 || ioctl(fd, UI_DEV_CREATE) < 0) {
+        perror("uinput setup");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(void) {
+    int ufd = create_device();
+    if (ufd < 0) {
+        return 1;
+    }
+
+    // Wait for udev to publish the event node
+    char path[64];
+    int found = -1;
+    for (int i = 0; i < 100 && found < 0; i++) {
+        found = encoder_find_evdev(DEVICE_NAME, path, sizeof(path));
+        if (found < 0) usleep(10000);
+    }
+    if (found < 0) {
+        fprintf(stderr, "uinput device node did not appear\n");
+        ioctl(ufd, UI_DEV_DESTROY);
+        close(ufd);
+        return 1;
+    }
+
+    if (encoder_init_evdev(path, NULL, ENCODER_EVDEV_AXIS, ENCODER_EVDEV_KEY) < 0) {
+        ioctl(ufd, UI_DEV_DESTROY);
+        close(ufd);
+        return 1;
+    }
+    printf("Virtual encoder at %s\n", path);
+
+    int sent_steps = 0, sent_presses = 0;
+    int got_steps = 0, got_presses = 0;
+    long wakeups = 0, events = 0;
+    long long start = now_ns();
+
+    for (int burst = 0; burst < NUM_BURSTS; burst++) {
+        // Alternate direction every 10 bursts to exercise negative values
+        int dir = ((burst / 10) % 2) ? -1 : 1;
+        for (int k = 0; k < BURST_LEN; k++) {
+            emit(ufd, EV_REL, REL_X, dir);
+            emit(ufd, EV_SYN, SYN_REPORT, 0);
+            sent_steps += dir;
+        }
+        if (burst % PRESS_EVERY == 0) {
+            emit(ufd, EV_KEY, KEY_ENTER, 1);
+            emit(ufd, EV_SYN, SYN_REPORT, 0);
+            emit(ufd, EV_KEY, KEY_ENTER, 0);
+            emit(ufd, EV_SYN, SYN_REPORT, 0);
+            sent_presses++;
+        }
+
+        while (encoder_wait(&(struct timespec){ .tv_sec = 0, .tv_nsec = 0 }) > 0) {
+            struct encoder_report report;
+            int n = encoder_read(&report);
+            if (n < 0) {
+                perror("encoder_read");
+                break;
+            }
+            wakeups++;
+            events += n;
+            got_steps += report.steps;
+            got_presses += report.presses;
+        }
+    }
+
+    // Collect stragglers
+    while (encoder_wait(&(struct timespec){ .tv_sec = 0, .tv_nsec = 50000000 }) > 0) {
+        struct encoder_report report;
+        int n = encoder_read(&report);
+        if (n <= 0) break;
+        wakeups++;
+        events += n;
+        got_steps += report.steps;
+        got_presses += report.presses;
+    }
+    long long elapsed_ns = now_ns() - start;
+
+    encoder_close();
+    ioctl(ufd, UI_DEV_DESTROY);
+    close(ufd);
+
+    printf("Steps:   sent %d, decoded %d\n", sent_steps, got_steps);
+    printf("Presses: sent %d, decoded %d\n", sent_presses, got_presses);
+    printf("Reads:   %ld wake-ups, %ld events (%.1f events/wake-up), %.0f events/s\n",
+           wakeups, events, wakeups ? (double)events / wakeups : 0.0,
+           events * 1e9 / (double)elapsed_ns);
+
+    int ok = (sent_steps == got_steps) && (sent_presses == got_presses);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+#define _GNU_SOURCE
+#include <gpiod.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdint.h>
+
+#include "lcd_api.h"
+#include "pinmap_api.h"
+#include "syscall_count_api.h"
+
+/*
+ * GPIO bring-up benchmark: line-by-line requests vs the pin map.
+ *
+ * Brings up the scroll_base_interrupt pin set (LED, LCD, encoder A/B) both
+ * ways, the old way with one gpiod_chip_get_line() and one request call per
+ * pin, and with pinmap_open() grouping the pins into bulk requests. Then
+ * writes LCD nibbles both ways: four data writes plus an E pulse per
+ * nibble, against staging the group and committing it once.
+ *
+ * For each it reports the mean and best wall time and the number of
+ * syscalls made, counted with the raw_syscalls:sys_enter tracepoint (needs
+ * root or perf_event_paranoid <= 1; "n/a" otherwise, in which case compare
+ * with: sudo strace -c ./gpio_bringup -n 1).
+ *
+ * Nothing may hold the pins while it runs. The LCD shows garbage afterwards
+ * until a program initializes it again.
+ *
+ * Run: sudo ./gpio_bringup [-n reps] [-w nibbles] [-c chip]
+ */
+
+#define CHIP "/dev/gpiochip4"
+#define REPS 100
+#define NIBBLES 1000
+
+static const struct pin_desc PINS[] = {
+    { "led", 21, PIN_OUTPUT, 0, 1, 0 },
+    LCD_PIN_DESCS,
+    { "encoder_a", 14, PIN_EDGE_BOTH, 0, 0, 0 },
+    { "encoder_b", 15, PIN_EDGE_BOTH, 0, 0, 0 },
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
+
+// Line-by-line bring-up, as the programs did it before the pin map
+struct legacy_pins {
+    struct gpiod_chip *chip;
+    struct gpiod_line *lines[NUM_PINS];
+};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int legacy_open(struct legacy_pins *lp, const char *chip_path) {
+    lp->chip = gpiod_chip_open(chip_path);
+    if (!lp->chip) {
+        return -1;
+    }
+    for (size_t i = 0; i < NUM_PINS; i++) {
+        const struct pin_desc *d = &PINS[i];
+        struct gpiod_line *line = gpiod_chip_get_line(lp->chip, d->offset);
+        int ret = -1;
+        if (line) {
+            ret = d->mode == PIN_OUTPUT
+                ? gpiod_line_request_output(line, d->name, d->initial)
+                : gpiod_line_request_both_edges_events(line, d->name);
+        }
+        if (ret < 0) {
+            gpiod_chip_close(lp->chip);     // Releases the lines requested so far
+            return -1;
+        }
+        lp->lines[i] = line;
+    }
+    return 0;
+}
+
+static void legacy_close(struct legacy_pins *lp) {
+    for (size_t i = 0; i < NUM_PINS; i++) {
+        gpiod_line_release(lp->lines[i]);
+    }
+    gpiod_chip_close(lp->chip);
+}
+
+static struct gpiod_line *legacy_line(struct legacy_pins *lp, const char *name) {
+    for (size_t i = 0; i < NUM_PINS; i++) {
+        if (strcmp(PINS[i].name, name) == 0) return lp->lines[i];
+    }
+    return NULL;
+}
+
+static void print_row(const char *what, const char *how, long long sum_ns,
+                      long long best_ns, long long syscalls, int reps) {
+    printf("%-9s %-8s %10.1f %10.1f", what, how, sum_ns / 1e3 / reps, best_ns / 1e3);
+    if (syscalls >= 0) {
+        printf(" %10.1f\n", (double)syscalls / reps);
+    } else {
+        printf(" %10s\n", "n/a");
+    }
+}
+
+static int bench_bringup(const char *chip_path, int reps) {
+    long long sum[2] = {0, 0}, best[2] = {-1, -1}, calls[2] = {0, 0};
+
+    for (int r = 0; r < reps; r++) {
+        // Alternate so both see the same system state on average
+        struct legacy_pins lp;
+        syscall_count_start();
+        long long t0 = now_ns();
+        if (legacy_open(&lp, chip_path) < 0) {
+            perror("legacy bring-up");
+            return -1;
+        }
+        long long dt = now_ns() - t0;
+        long long n = syscall_count_take();
+        legacy_close(&lp);
+        sum[0] += dt;
+        if (best[0] < 0 || dt < best[0]) best[0] = dt;
+        calls[0] = (n < 0 || calls[0] < 0) ? -1 : calls[0] + n;
+
+        struct pinmap pm;
+        syscall_count_start();
+        t0 = now_ns();
+        if (pinmap_open(&pm, chip_path, "gpio_bringup", PINS, NUM_PINS) < 0) {
+            perror("pinmap_open");
+            return -1;
+        }
+        dt = now_ns() - t0;
+        n = syscall_count_take();
+        pinmap_close(&pm);
+        sum[1] += dt;
+        if (best[1] < 0 || dt < best[1]) best[1] = dt;
+        calls[1] = (n < 0 || calls[1] < 0) ? -1 : calls[1] + n;
+    }
+
+    printf("\n%zu pins, %d bring-ups each\n", NUM_PINS, reps);
+    printf("%-9s %-8s %10s %10s %10s\n", "", "", "mean us", "best us", "syscalls");
+    print_row("bring-up", "legacy", sum[0], best[0], calls[0], reps);
+    print_row("bring-up", "pinmap", sum[1], best[1], calls[1], reps);
+    return 0;
+}
+
+static int bench_nibbles(const char *chip_path, int nibbles) {
+    static const char *const LCD[] = { "d4", "d5", "d6", "d7", "e", "rs" };
+    long long sum[2], calls[2];
+
+    struct legacy_pins lp;
+    if (legacy_open(&lp, chip_path) < 0) {
+        perror("legacy bring-up");
+        return -1;
+    }
+    struct gpiod_line *l[6];
+    for (int i = 0; i < 6; i++) l[i] = legacy_line(&lp, LCD[i]);
+
+    syscall_count_start();
+    long long t0 = now_ns();
+    for (int k = 0; k < nibbles; k++) {
+        for (int b = 0; b < 4; b++) gpiod_line_set_value(l[b], (k >> b) & 1);
+        gpiod_line_set_value(l[4], 1);
+        gpiod_line_set_value(l[4], 0);
+    }
+    sum[0] = now_ns() - t0;
+    calls[0] = syscall_count_take();
+    legacy_close(&lp);
+
+    struct pinmap pm;
+    if (pinmap_open(&pm, chip_path, "gpio_bringup", PINS, NUM_PINS) < 0) {
+        perror("pinmap_open");
+        return -1;
+    }
+    struct pin_out p[6];
+    for (int i = 0; i < 6; i++) {
+        if (pinmap_out(&pm, LCD[i], &p[i]) < 0) {
+            perror(LCD[i]);
+            pinmap_close(&pm);
+            return -1;
+        }
+    }
+
+    syscall_count_start();
+    t0 = now_ns();
+    for (int k = 0; k < nibbles; k++) {
+        for (int b = 0; b < 4; b++) pin_stage(p[b], (k >> b) & 1);
+        pin_stage(p[4], 1);
+        pin_commit(p[4]);
+        pin_write(p[4], 0);
+    }
+    sum[1] = now_ns() - t0;
+    calls[1] = syscall_count_take();
+    pinmap_close(&pm);
+
+    printf("\n%d LCD nibbles each (data + E pulse, no controller delays)\n", nibbles);
+    printf("%-9s %-8s %10s %10s %10s\n", "", "", "mean us", "total us", "syscalls");
+    print_row("nibble", "legacy", sum[0], sum[0], calls[0], nibbles);
+    print_row("nibble", "pinmap", sum[1], sum[1], calls[1], nibbles);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *chip_path = CHIP;
+    int reps = REPS;
+    int nibbles = NIBBLES;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:w:c:")) != -1) {
+        switch (opt) {
+        case 'n': reps = atoi(optarg); break;
+        case 'w': nibbles = atoi(optarg); break;
+        case 'c': chip_path = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-n reps] [-w nibbles] [-c chip]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps <= 0) reps = REPS;
+    if (nibbles <= 0) nibbles = NIBBLES;
+
+    if (syscall_count_open() < 0) {
+        fprintf(stderr, "Warning: cannot count syscalls (need root or a lower "
+                        "perf_event_paranoid)\n");
+    }
+
+    if (bench_bringup(chip_path, reps) < 0 || bench_nibbles(chip_path, nibbles) < 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,569 @@
+#define _GNU_SOURCE
+#include <gpiod.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/*
+ * GPIO edge latency: interrupt (edge events) vs polling.
+ *
+ * A driver thread produces one edge at a time and timestamps the write
+ * (CLOCK_MONOTONIC, just before the syscall). The main thread, blocked the
+ * same way base_interrupt.c / hw_base_interrupt.c / sw_base_interrupt.c
+ * block, records when it wakes up and reads the kernel event timestamp.
+ * Per load level it prints histograms for:
+ *
+ *   write        time spent in the write syscall itself
+ *   edge->kernel kernel event timestamp - write timestamp
+ *   kernel->user wake-up time - kernel event timestamp
+ *   edge->user   wake-up time - write timestamp (the only one in poll mode)
+ *
+ * Edge sources:
+ *
+ *   Loopback (Pi): jumper OUT_PIN to IN_PIN.
+ *     sudo ./gpio_latency -o 20 -i 21
+ *
+ *   gpio-sim (any Linux host, no hardware): the edge is injected by writing
+ *   the line's simulated pull through sysfs.
+ *     sudo modprobe gpio-sim
+ *     cd /sys/kernel/config/gpio-sim && sudo mkdir -p lat/bank0
+ *     echo 4 | sudo tee lat/bank0/num_lines
+ *     echo 1 | sudo tee lat/live
+ *     chip=$(cat lat/bank0/chip_name); dev=$(cat lat/dev_name)
+ *     sudo ./gpio_latency -c /dev/$chip -i 0 \
+ *         -p /sys/devices/platform/$dev/$chip/sim_gpio0/pull
+ *
+ * Load: -L takes a comma-separated list of background thread counts and
+ * runs one measurement per entry; -k picks what those threads do ("cpu"
+ * spins in userspace, "sys" hammers the syscall path).
+ *
+ * Event timestamps from the v1 uAPI are CLOCK_MONOTONIC on kernels >= 5.7;
+ * older kernels use CLOCK_REALTIME and the edge->kernel column is garbage.
+ */
+
+#define CHIP "/dev/gpiochip4"
+#define OUT_PIN 20
+#define IN_PIN 21
+
+#define DEFAULT_SAMPLES 2000
+#define DEFAULT_GAP_US 1000     // Idle time between two edges
+#define EDGE_TIMEOUT_MS 1000    // Give up on an edge after this long
+#define MAX_LOADS 16
+#define NUM_BUCKETS 20          // log2 buckets: <1us, 1-2us, ... >=256ms
+#define BAR_WIDTH 40
+
+enum mode { MODE_EVENT, MODE_POLL };
+enum load_kind { LOAD_CPU, LOAD_SYS };
+
+struct options {
+    const char *chip;
+    const char *pull_path;       // gpio-sim pull attribute, NULL = loopback
+    unsigned int out_pin;
+    unsigned int in_pin;
+    enum mode mode;
+    int poll_us;                 // Sleep between polls, 0 = spin
+    int samples;
+    int gap_us;
+    enum load_kind load_kind;
+    int loads[MAX_LOADS];
+    int num_loads;
+};
+
+// Shared between the driver thread and the measuring thread
+struct edge_driver {
+    struct gpiod_line *out;      // Loopback output, or NULL
+    int pull_fd;                 // gpio-sim pull attribute, or -1
+    int gap_us;
+    atomic_int level;            // Level the driver will write next
+    atomic_llong t_write;        // Write timestamp of the edge in flight
+    atomic_llong t_write_end;    // When the write syscall returned
+    atomic_int seq;              // Bumped by the driver per edge
+    atomic_int ack;              // Bumped by the reader once it has the edge
+    atomic_int stop;
+};
+
+struct loader {
+    enum load_kind kind;
+    atomic_int *stop;
+};
+
+struct samples {
+    long long *write_ns;
+    long long *kernel_ns;        // edge->kernel
+    long long *user_ns;          // kernel->user
+    long long *total_ns;         // edge->user
+    int count;
+    int missed;
+    int clock_mismatch;
+};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static long long ts_ns(const struct timespec *ts) {
+    return (long long)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+static void sleep_us(long us) {
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000 };
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+    }
+}
+
+// ── Edge source ─────────────────────────────────────────────────────────────
+
+static int drive_level(struct edge_driver *d, int level) {
+    if (d->out) {
+        return gpiod_line_set_value(d->out, level);
+    }
+
+    const char *val = level ? "pull-up" : "pull-down";
+    if (pwrite(d->pull_fd, val, strlen(val), 0) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Produce one edge, wait for the reader to pick it up, idle, repeat
+static void *driver_thread(void *arg) {
+    struct edge_driver *d = arg;
+
+    while (!atomic_load(&d->stop)) {
+        int seq = atomic_load(&d->seq);
+        int level = atomic_load(&d->level);
+
+        long long t0 = now_ns();
+        if (drive_level(d, level) < 0) {
+            perror("drive_level");
+            break;
+        }
+        long long t1 = now_ns();
+
+        atomic_store(&d->t_write, t0);
+        atomic_store(&d->t_write_end, t1);
+        atomic_store(&d->level, !level);
+        atomic_store(&d->seq, seq + 1);
+
+        // One edge in flight at a time, so queued edges never skew a sample
+        long long give_up = t1 + (long long)EDGE_TIMEOUT_MS * 1000000LL;
+        while (atomic_load(&d->ack) != seq + 1 && !atomic_load(&d->stop)) {
+            if (now_ns() > give_up) {
+                atomic_store(&d->ack, seq + 1);
+                break;
+            }
+            sched_yield();
+        }
+        sleep_us(d->gap_us);
+    }
+    return NULL;
+}
+
+// ── Background load ─────────────────────────────────────────────────────────
+
+static void *load_thread(void *arg) {
+    struct loader *l = arg;
+    volatile unsigned long sink = 0;
+
+    while (!atomic_load(l->stop)) {
+        if (l->kind == LOAD_SYS) {
+            sink += (unsigned long)getppid();
+        } else {
+            for (int i = 0; i < 10000; i++) {
+                sink += i;
+            }
+        }
+    }
+    return NULL;
+}
+
+// ── Measurement ─────────────────────────────────────────────────────────────
+
+static void record(struct samples *s, long long t_write, long long t_write_end,
+                   long long t_kernel, long long t_wake) {
+    int i = s->count++;
+    s->write_ns[i] = t_write_end - t_write;
+    s->total_ns[i] = t_wake - t_write;
+    if (t_kernel) {
+        // A kernel stamp before the write started means another clock
+        if (t_kernel < t_write - 1000000000LL || t_kernel > t_wake + 1000000000LL) {
+            s->clock_mismatch = 1;
+        }
+        s->kernel_ns[i] = t_kernel - t_write;
+        s->user_ns[i] = t_wake - t_kernel;
+    }
+}
+
+// Interrupt style: block on the edge event, like the *_interrupt programs
+static int measure_event(struct gpiod_line *in, struct edge_driver *d,
+                         struct samples *s, int n) {
+    struct gpiod_line_event ev;
+    int last_seq = atomic_load(&d->seq);
+
+    while (s->count + s->missed < n) {
+        int ret = gpiod_line_event_wait(in, &(struct timespec){ .tv_sec = EDGE_TIMEOUT_MS / 1000,
+                                                                .tv_nsec = (EDGE_TIMEOUT_MS % 1000) * 1000000L });
+        long long t_wake = now_ns();
+        if (ret < 0) {
+            perror("gpiod_line_event_wait");
+            return -1;
+        }
+        if (ret == 0) {
+            s->missed++;
+            last_seq = atomic_load(&d->seq);
+            atomic_store(&d->ack, last_seq);
+            continue;
+        }
+        if (gpiod_line_event_read(in, &ev) < 0) {
+            perror("gpiod_line_event_read");
+            return -1;
+        }
+
+        // The edge can wake us before the driver's write syscall returns
+        // and publishes its timestamps, so give it a moment to catch up
+        int seq;
+        long long give_up = t_wake + 100000000LL;
+        while ((seq = atomic_load(&d->seq)) == last_seq && now_ns() < give_up) {
+            sched_yield();
+        }
+        if (seq == last_seq) {
+            // Stray edge (bounce, or left over from setup): not ours
+            continue;
+        }
+        last_seq = seq;
+
+        record(s, atomic_load(&d->t_write), atomic_load(&d->t_write_end),
+               ts_ns(&ev.ts), t_wake);
+        atomic_store(&d->ack, seq);
+    }
+    return 0;
+}
+
+// Polling style: sample the input level until it follows the output
+static int measure_poll(struct gpiod_line *in, struct edge_driver *d,
+                        struct samples *s, int n, int poll_us) {
+    int last_seq = atomic_load(&d->seq);
+
+    while (s->count + s->missed < n) {
+        int seq;
+        while ((seq = atomic_load(&d->seq)) == last_seq) {
+            sched_yield();
+        }
+        last_seq = seq;
+
+        // The driver flips its level after writing, so the target is the inverse
+        int want = !atomic_load(&d->level);
+        long long give_up = atomic_load(&d->t_write_end) + (long long)EDGE_TIMEOUT_MS * 1000000LL;
+        int got = -1;
+        long long t_seen = 0;
+
+        while (1) {
+            got = gpiod_line_get_value(in);
+            t_seen = now_ns();
+            if (got < 0) {
+                perror("gpiod_line_get_value");
+                return -1;
+            }
+            if (got == want || t_seen > give_up) break;
+            if (poll_us > 0) sleep_us(poll_us);
+        }
+
+        if (got == want) {
+            record(s, atomic_load(&d->t_write), atomic_load(&d->t_write_end), 0, t_seen);
+        } else {
+            s->missed++;
+        }
+        atomic_store(&d->ack, seq);
+    }
+    return 0;
+}
+
+// ── Reporting ───────────────────────────────────────────────────────────────
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static int bucket_of(long long ns) {
+    long long us = ns / 1000;
+    int b = 0;
+    while (us > 0 && b < NUM_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static void format_us(char *buf, size_t len, long long us) {
+    if (us >= 1000) {
+        snprintf(buf, len, "%lldms", us / 1000);
+    } else {
+        snprintf(buf, len, "%lldus", us);
+    }
+}
+
+static void print_histogram(const char *name, long long *v, int n) {
+    if (n == 0) return;
+
+    qsort(v, n, sizeof(v[0]), cmp_ll);
+    printf("  %s: min %.1f  p50 %.1f  p99 %.1f  max %.1f us\n", name,
+           v[0] / 1e3, v[n / 2] / 1e3, v[(n * 99) / 100] / 1e3, v[n - 1] / 1e3);
+
+    int counts[NUM_BUCKETS] = {0};
+    int negative = 0;
+    for (int i = 0; i < n; i++) {
+        if (v[i] < 0) negative++;
+        else counts[bucket_of(v[i])]++;
+    }
+
+    int peak = 1;
+    for (int b = 0; b < NUM_BUCKETS; b++) {
+        if (counts[b] > peak) peak = counts[b];
+    }
+
+    int first = 0, last = NUM_BUCKETS - 1;
+    while (first < last && counts[first] == 0) first++;
+    while (last > first && counts[last] == 0) last--;
+
+    for (int b = first; b <= last; b++) {
+        char lo[16], hi[16];
+        format_us(lo, sizeof(lo), b ? 1LL << (b - 1) : 0);
+        format_us(hi, sizeof(hi), 1LL << b);
+        int width = counts[b] * BAR_WIDTH / peak;
+        printf("    %6s-%-6s %7d |%.*s\n", lo, hi, counts[b], width,
+               "########################################");
+    }
+    if (negative) {
+        printf("    %13s %7d (kernel stamp before write)\n", "<0", negative);
+    }
+}
+
+static void print_report(const struct options *o, int load, struct samples *s) {
+    printf("\n== %s, %d %s load thread%s: %d edges, %d missed ==\n",
+           o->mode == MODE_EVENT ? "event" : "poll",
+           load, o->load_kind == LOAD_CPU ? "cpu" : "sys", load == 1 ? "" : "s",
+           s->count, s->missed);
+
+    print_histogram("write       ", s->write_ns, s->count);
+    if (o->mode == MODE_EVENT) {
+        print_histogram("edge->kernel", s->kernel_ns, s->count);
+        print_histogram("kernel->user", s->user_ns, s->count);
+        if (s->clock_mismatch) {
+            printf("  warning: kernel timestamps are not CLOCK_MONOTONIC (kernel < 5.7?)\n");
+        }
+    }
+    print_histogram("edge->user  ", s->total_ns, s->count);
+    fflush(stdout);
+}
+
+// ── Setup ───────────────────────────────────────────────────────────────────
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-c chip] [-o out_pin] [-i in_pin] [-p pull_path]\n"
+            "          [-m event|poll] [-t poll_us] [-n samples] [-g gap_us]\n"
+            "          [-L loads] [-k cpu|sys]\n"
+            "  -p      drive a gpio-sim line through its sysfs pull attribute\n"
+            "          instead of a loopback output (-o is ignored)\n"
+            "  -L      comma-separated load thread counts, e.g. 0,1,4\n",
+            prog);
+}
+
+static int parse_loads(const char *arg, struct options *o) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s", arg);
+
+    o->num_loads = 0;
+    for (char *tok = strtok(buf, ","); tok && o->num_loads < MAX_LOADS; tok = strtok(NULL, ",")) {
+        int n = atoi(tok);
+        if (n < 0) return -1;
+        o->loads[o->num_loads++] = n;
+    }
+    return o->num_loads > 0 ? 0 : -1;
+}
+
+static int parse_options(int argc, char **argv, struct options *o) {
+    *o = (struct options){
+        .chip = CHIP,
+        .pull_path = NULL,
+        .out_pin = OUT_PIN,
+        .in_pin = IN_PIN,
+        .mode = MODE_EVENT,
+        .poll_us = 0,
+        .samples = DEFAULT_SAMPLES,
+        .gap_us = DEFAULT_GAP_US,
+        .load_kind = LOAD_CPU,
+        .loads = {0},
+        .num_loads = 1,
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:o:i:p:m:t:n:g:L:k:h")) != -1) {
+        switch (opt) {
+        case 'c': o->chip = optarg; break;
+        case 'o': o->out_pin = (unsigned int)atoi(optarg); break;
+        case 'i': o->in_pin = (unsigned int)atoi(optarg); break;
+        case 'p': o->pull_path = optarg; break;
+        case 't': o->poll_us = atoi(optarg); break;
+        case 'n': o->samples = atoi(optarg); break;
+        case 'g': o->gap_us = atoi(optarg); break;
+        case 'm':
+            if (strcmp(optarg, "event") == 0) o->mode = MODE_EVENT;
+            else if (strcmp(optarg, "poll") == 0) o->mode = MODE_POLL;
+            else return -1;
+            break;
+        case 'k':
+            if (strcmp(optarg, "cpu") == 0) o->load_kind = LOAD_CPU;
+            else if (strcmp(optarg, "sys") == 0) o->load_kind = LOAD_SYS;
+            else return -1;
+            break;
+        case 'L':
+            if (parse_loads(optarg, o) < 0) return -1;
+            break;
+        default:
+            return -1;
+        }
+    }
+    return o->samples > 0 ? 0 : -1;
+}
+
+static int run_load_level(const struct options *o, struct gpiod_line *in,
+                          struct edge_driver *d, int load) {
+    struct samples s = {0};
+    s.write_ns = calloc(o->samples, sizeof(long long));
+    s.kernel_ns = calloc(o->samples, sizeof(long long));
+    s.user_ns = calloc(o->samples, sizeof(long long));
+    s.total_ns = calloc(o->samples, sizeof(long long));
+    pthread_t *loaders = calloc(load ? load : 1, sizeof(pthread_t));
+    int ret = -1;
+    if (!s.write_ns || !s.kernel_ns || !s.user_ns || !s.total_ns || !loaders) {
+        perror("calloc");
+        goto out;
+    }
+
+    atomic_int stop_load = 0;
+    struct loader l = { .kind = o->load_kind, .stop = &stop_load };
+    int started = 0;
+    for (; started < load; started++) {
+        if (pthread_create(&loaders[started], NULL, load_thread, &l) != 0) {
+            perror("pthread_create(load)");
+            break;
+        }
+    }
+
+    atomic_store(&d->stop, 0);
+    atomic_store(&d->ack, atomic_load(&d->seq));
+    pthread_t driver;
+    if (pthread_create(&driver, NULL, driver_thread, d) == 0) {
+        if (o->mode == MODE_EVENT) {
+            ret = measure_event(in, d, &s, o->samples);
+        } else {
+            ret = measure_poll(in, d, &s, o->samples, o->poll_us);
+        }
+        atomic_store(&d->stop, 1);
+        pthread_join(driver, NULL);
+    } else {
+        perror("pthread_create(driver)");
+    }
+
+    atomic_store(&stop_load, 1);
+    for (int i = 0; i < started; i++) {
+        pthread_join(loaders[i], NULL);
+    }
+
+    if (ret == 0) {
+        print_report(o, load, &s);
+    }
+
+out:
+    free(loaders);
+    free(s.write_ns);
+    free(s.kernel_ns);
+    free(s.user_ns);
+    free(s.total_ns);
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    struct options o;
+    if (parse_options(argc, argv, &o) < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct gpiod_chip *chip = gpiod_chip_open(o.chip);
+    if (!chip) {
+        perror("gpiod_chip_open");
+        return 1;
+    }
+
+    struct edge_driver d = { .out = NULL, .pull_fd = -1, .gap_us = o.gap_us };
+
+    if (o.pull_path) {
+        d.pull_fd = open(o.pull_path, O_WRONLY | O_CLOEXEC);
+        if (d.pull_fd < 0) {
+            perror(o.pull_path);
+            gpiod_chip_close(chip);
+            return 1;
+        }
+    } else {
+        d.out = gpiod_chip_get_line(chip, o.out_pin);
+        if (!d.out || gpiod_line_request_output(d.out, "latency_out", 0) < 0) {
+            perror("latency output");
+            gpiod_chip_close(chip);
+            return 1;
+        }
+    }
+
+    // Start from a known low level before the input is requested
+    if (drive_level(&d, 0) < 0) {
+        perror("drive_level");
+        gpiod_chip_close(chip);
+        return 1;
+    }
+    atomic_store(&d.level, 1);
+    usleep(10000);
+
+    struct gpiod_line *in = gpiod_chip_get_line(chip, o.in_pin);
+    int req = -1;
+    if (in) {
+        req = (o.mode == MODE_EVENT)
+            ? gpiod_line_request_both_edges_events(in, "latency_in")
+            : gpiod_line_request_input(in, "latency_in");
+    }
+    if (req < 0) {
+        perror("latency input");
+        if (d.out) gpiod_line_release(d.out);
+        if (d.pull_fd >= 0) close(d.pull_fd);
+        gpiod_chip_close(chip);
+        return 1;
+    }
+
+    printf("GPIO latency: %s -> %s line %u, %s mode, %d edges per load level\n",
+           o.pull_path ? "gpio-sim pull" : "loopback output",
+           o.chip, o.in_pin, o.mode == MODE_EVENT ? "event" : "poll", o.samples);
+
+    int status = 0;
+    for (int i = 0; i < o.num_loads; i++) {
+        if (run_load_level(&o, in, &d, o.loads[i]) < 0) {
+            status = 1;
+            break;
+        }
+    }
+
+    gpiod_line_release(in);
+    if (d.out) gpiod_line_release(d.out);
+    if (d.pull_fd >= 0) close(d.pull_fd);
+    gpiod_chip_close(chip);
+    return status;
+}
@@ -9,27 +9,26 @@
 
 #include "lcd_api.h"
 #include "keyp_api.h"
+#include "pinmap_api.h"
 
 #define CHIP "/dev/gpiochip4"
-#define LED_TEST 21
-
-#define RS 5
-#define E  16
-#define D4 6
-#define D5 13
-#define D6 19
-#define D7 26
-
-// Keypad pins
-#define COL1 14
-#define COL2 15
-#define COL3 18
-#define ROW1 27
-#define ROW2 22
-#define ROW3 23
-#define ROW4 24
-
-static struct gpiod_line *rs, *e, *d4, *d5, *d6, *d7;
+
+// Keypad columns are inputs with edge events, rows are outputs held high
+static const struct pin_desc PINS[] = {
+    { "led",  21, PIN_OUTPUT, 0, 1, 0 },   // LED test, on while running
+    LCD_PIN_DESCS,
+    { "col1", 14, PIN_EDGE_BOTH, 0, 0, 0 },
+    { "col2", 15, PIN_EDGE_BOTH, 0, 0, 0 },
+    { "col3", 18, PIN_EDGE_BOTH, 0, 0, 0 },
+    { "row1", 27, PIN_OUTPUT, 0, 1, 0 },
+    { "row2", 22, PIN_OUTPUT, 0, 1, 0 },
+    { "row3", 23, PIN_OUTPUT, 0, 1, 0 },
+    { "row4", 24, PIN_OUTPUT, 0, 1, 0 },
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
+
+// Max edge events pulled from the kernel per wake-up
+#define MAX_EVENTS 16
 
 static long long now_ms(void) {
     struct timespec ts;
@@ -40,74 +39,32 @@ static long long now_ms(void) {
 int main(void) {
     const int debounce_ms = 30;
 
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip) {
-        perror("gpiod_chip_open");
+    // Every pin of the board in one pass: one bulk request per group
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "keyp_base_interrupt", PINS, NUM_PINS) < 0) {
+        perror("pinmap_open");
         return 1;
     }
 
-    // Set up the LED line as output test
-    struct gpiod_line *led = gpiod_chip_get_line(chip, LED_TEST);
-    if (!led) {
-        perror("gpiod_chip_get_line");
-        gpiod_chip_close(chip);
+    struct pin_edge col1, col2, col3;
+    struct pin_out row1, row2, row3, row4;
+    if (pinmap_edge(&pm, "col1", &col1) < 0 || pinmap_edge(&pm, "col2", &col2) < 0 ||
+        pinmap_edge(&pm, "col3", &col3) < 0 ||
+        pinmap_out(&pm, "row1", &row1) < 0 || pinmap_out(&pm, "row2", &row2) < 0 ||
+        pinmap_out(&pm, "row3", &row3) < 0 || pinmap_out(&pm, "row4", &row4) < 0) {
+        perror("pinmap(keypad)");
+        pinmap_close(&pm);
         return 1;
     }
 
-    if (gpiod_line_request_output(led, "led", 0) < 0) { 
-        perror("led"); return 1; 
-    }
-    gpiod_line_set_value(led, 1); // turn on the LED
-
-    // LCD lines
-    rs = gpiod_chip_get_line(chip, RS);
-    e  = gpiod_chip_get_line(chip, E);
-    d4 = gpiod_chip_get_line(chip, D4);
-    d5 = gpiod_chip_get_line(chip, D5);
-    d6 = gpiod_chip_get_line(chip, D6);
-    d7 = gpiod_chip_get_line(chip, D7);
-
-    if (!rs || !e || !d4 || !d5 || !d6 || !d7) {
-        perror("gpiod_chip_get_line(lcd)");
-        return 1;
-    }
+    // Initialize keypad
+    keyp_init(col1, col2, col3, row1, row2, row3, row4);
 
-    if (gpiod_line_request_output(rs, "rs", 0) < 0) { perror("rs"); return 1; }
-    if (gpiod_line_request_output(e,  "e",  0) < 0) { perror("e");  return 1; }
-    if (gpiod_line_request_output(d4, "d4", 0) < 0) { perror("d4"); return 1; }
-    if (gpiod_line_request_output(d5, "d5", 0) < 0) { perror("d5"); return 1; }
-    if (gpiod_line_request_output(d6, "d6", 0) < 0) { perror("d6"); return 1; }
-    if (gpiod_line_request_output(d7, "d7", 0) < 0) { perror("d7"); return 1; }
-
-    // Keypad setup - 3 columns (inputs with pull-down) and 4 rows (outputs)
-    struct gpiod_line *col1 = gpiod_chip_get_line(chip, COL1);
-    struct gpiod_line *col2 = gpiod_chip_get_line(chip, COL2);
-    struct gpiod_line *col3 = gpiod_chip_get_line(chip, COL3);
-    struct gpiod_line *row1 = gpiod_chip_get_line(chip, ROW1);
-    struct gpiod_line *row2 = gpiod_chip_get_line(chip, ROW2);
-    struct gpiod_line *row3 = gpiod_chip_get_line(chip, ROW3);
-    struct gpiod_line *row4 = gpiod_chip_get_line(chip, ROW4);
-
-    if (!col1 || !col2 || !col3 || !row1 || !row2 || !row3 || !row4) {
-        perror("gpiod_chip_get_line(keypad)");
+    if (lcd_init_pinmap(&pm) < 0) {
+        perror("lcd_init_pinmap");
+        pinmap_close(&pm);
         return 1;
     }
-
-    // Configure columns as inputs with pull-down and rising edge events
-    if (gpiod_line_request_both_edges_events(col1, "col1") < 0) { perror("col1"); return 1; }
-    if (gpiod_line_request_both_edges_events(col2, "col2") < 0) { perror("col2"); return 1; }
-    if (gpiod_line_request_both_edges_events(col3, "col3") < 0) { perror("col3"); return 1; }
-
-    // Configure rows as outputs (start low)
-    if (gpiod_line_request_output(row1, "row1", 0) < 0) { perror("row1"); return 1; }
-    if (gpiod_line_request_output(row2, "row2", 0) < 0) { perror("row2"); return 1; }
-    if (gpiod_line_request_output(row3, "row3", 0) < 0) { perror("row3"); return 1; }
-    if (gpiod_line_request_output(row4, "row4", 0) < 0) { perror("row4"); return 1; }
-
-    // Initialize keypad
-    keyp_init(chip, col1, col2, col3, row1, row2, row3, row4);
-
-    lcd_init(chip, rs, e, d4, d5, d6, d7);
     lcd_clear();
     
     // State variables for displaying keys
@@ -123,24 +80,32 @@ int main(void) {
 
     while (1) {
         // Check keypad column events (check each column)
-        struct gpiod_line **cols = keyp_get_cols();
+        struct pin_edge *cols = keyp_get_cols();
         for (int i = 0; i < 3; i++) {
-            int ret = gpiod_line_event_wait(cols[i], &(struct timespec){ .tv_sec = 0, .tv_nsec = 10000000L }); // 10ms
+            int ret = pin_edge_wait(cols[i], &(struct timespec){ .tv_sec = 0, .tv_nsec = 10000000L }); // 10ms
             if (ret < 0) {
-                perror("gpiod_line_event_wait(col)");
+                perror("pin_edge_wait(col)");
                 return 1;
             }
             if (ret == 0) {
                 continue; // no event on this column
             }
 
-            struct gpiod_line_event ev;
-            if (gpiod_line_event_read(cols[i], &ev) < 0) {
-                perror("gpiod_line_event_read");
+            // Pull the whole burst of bounces on this column in one read
+            struct pin_event evs[MAX_EVENTS];
+            int n = pin_edge_read(cols[i], evs, MAX_EVENTS);
+            if (n < 0) {
+                perror("pin_edge_read");
                 break;
             }
 
-            if (ev.event_type != GPIOD_LINE_EVENT_RISING_EDGE) {
+            int rising = 0;
+            for (int k = 0; k < n; k++) {
+                if (evs[k].type == PIN_EVENT_RISING) {
+                    rising = 1;
+                }
+            }
+            if (!rising) {
                 continue;
             } 
 
@@ -155,9 +120,10 @@ int main(void) {
                     
                     // Drain all pending events from all columns caused by scanning
                     for (int j = 0; j < 3; j++) {
-                        struct gpiod_line_event drain_ev;
-                        while (gpiod_line_event_wait(cols[j], &(struct timespec){0, 0}) > 0) {
-                            gpiod_line_event_read(cols[j], &drain_ev);
+                        while (pin_edge_wait(cols[j], &(struct timespec){0, 0}) > 0) {
+                            if (pin_edge_read(cols[j], evs, MAX_EVENTS) < 0) {
+                                break;
+                            }
                         }
                     }
                     
@@ -200,14 +166,6 @@ int main(void) {
         fflush(stdout);
     }
 
-    gpiod_line_release(led);
-    gpiod_line_release(col1);
-    gpiod_line_release(col2);
-    gpiod_line_release(col3);
-    gpiod_line_release(row1);
-    gpiod_line_release(row2);
-    gpiod_line_release(row3);
-    gpiod_line_release(row4);
-    gpiod_chip_close(chip);
+    pinmap_close(&pm);
     return 0;
 }
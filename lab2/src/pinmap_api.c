@@ -0,0 +1,393 @@
+#include "pinmap_api.h"
+#include "trace_api.h"
+#include <gpiod.h>
+#include <errno.h>
+#include <string.h>
+
+static int is_edge(enum pin_mode mode) {
+    return mode == PIN_EDGE_RISING || mode == PIN_EDGE_FALLING || mode == PIN_EDGE_BOTH;
+}
+
+#ifdef PINMAP_GPIOD_V2
+
+// ---- libgpiod v2: one gpiod_line_request per group ----
+
+const char *pinmap_backend(void) {
+    return "libgpiod v2";
+}
+
+static int request_group(struct gpiod_chip *chip, const char *consumer,
+                         struct pin_group *grp, const unsigned int *offsets,
+                         unsigned int count) {
+    struct gpiod_line_settings *settings = gpiod_line_settings_new();
+    struct gpiod_line_config *line_cfg = gpiod_line_config_new();
+    struct gpiod_request_config *req_cfg = gpiod_request_config_new();
+    int ret = -1;
+
+    if (!settings || !line_cfg || !req_cfg) {
+        goto out;
+    }
+
+    if (grp->mode == PIN_OUTPUT) {
+        gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_OUTPUT);
+    } else {
+        gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+        if (grp->flags & PIN_PULL_UP) {
+            gpiod_line_settings_set_bias(settings, GPIOD_LINE_BIAS_PULL_UP);
+        } else if (grp->flags & PIN_PULL_DOWN) {
+            gpiod_line_settings_set_bias(settings, GPIOD_LINE_BIAS_PULL_DOWN);
+        }
+        gpiod_line_settings_set_debounce_period_us(settings, grp->debounce_us);
+    }
+    if (is_edge(grp->mode)) {
+        gpiod_line_settings_set_edge_detection(settings,
+            grp->mode == PIN_EDGE_RISING ? GPIOD_LINE_EDGE_RISING :
+            grp->mode == PIN_EDGE_FALLING ? GPIOD_LINE_EDGE_FALLING : GPIOD_LINE_EDGE_BOTH);
+        gpiod_line_settings_set_event_clock(settings, GPIOD_LINE_CLOCK_MONOTONIC);
+    }
+
+    // Per-line settings only differ in the initial output level
+    for (unsigned int i = 0; i < count; i++) {
+        if (grp->mode == PIN_OUTPUT) {
+            gpiod_line_settings_set_output_value(settings,
+                grp->values[i] ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE);
+        }
+        if (gpiod_line_config_add_line_settings(line_cfg, &offsets[i], 1, settings) < 0) {
+            goto out;
+        }
+        grp->offsets[i] = offsets[i];
+    }
+    grp->num_lines = count;
+
+    gpiod_request_config_set_consumer(req_cfg, consumer);
+    if (is_edge(grp->mode)) {
+        gpiod_request_config_set_event_buffer_size(req_cfg, PINMAP_EVENT_BUFFER);
+        grp->events = gpiod_edge_event_buffer_new(PINMAP_EVENT_BUFFER);
+        if (!grp->events) {
+            goto out;
+        }
+    }
+
+    grp->request = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+    if (!grp->request) {
+        gpiod_edge_event_buffer_free(grp->events);
+        grp->events = NULL;
+        goto out;
+    }
+    ret = 0;
+
+out:
+    gpiod_request_config_free(req_cfg);
+    gpiod_line_config_free(line_cfg);
+    gpiod_line_settings_free(settings);
+    return ret;
+}
+
+static void release_group(struct pin_group *grp) {
+    gpiod_line_request_release(grp->request);
+    gpiod_edge_event_buffer_free(grp->events);
+    grp->request = NULL;
+    grp->events = NULL;
+}
+
+static int write_group(struct pin_group *grp) {
+    enum gpiod_line_value vals[PINMAP_MAX_PINS];
+    for (unsigned int i = 0; i < grp->num_lines; i++) {
+        vals[i] = grp->values[i] ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+    }
+    return gpiod_line_request_set_values_subset(grp->request, grp->num_lines,
+                                                grp->offsets, vals);
+}
+
+static int read_group(struct pin_group *grp) {
+    enum gpiod_line_value vals[PINMAP_MAX_PINS];
+    if (gpiod_line_request_get_values_subset(grp->request, grp->num_lines,
+                                             grp->offsets, vals) < 0) {
+        return -1;
+    }
+    for (unsigned int i = 0; i < grp->num_lines; i++) {
+        grp->values[i] = vals[i] == GPIOD_LINE_VALUE_ACTIVE;
+    }
+    return 0;
+}
+
+unsigned int pin_edge_offset(struct pin_edge p) {
+    return p.group->offsets[0];
+}
+
+int pin_edge_value(struct pin_edge p) {
+    enum gpiod_line_value v = gpiod_line_request_get_value(p.group->request, p.group->offsets[0]);
+    return v == GPIOD_LINE_VALUE_ERROR ? -1 : v == GPIOD_LINE_VALUE_ACTIVE;
+}
+
+int pin_edge_fd(struct pin_edge p) {
+    return gpiod_line_request_get_fd(p.group->request);
+}
+
+int pin_edge_wait(struct pin_edge p, const struct timespec *timeout) {
+    int64_t ns = timeout ? (int64_t)timeout->tv_sec * 1000000000LL + timeout->tv_nsec : -1;
+    return gpiod_line_request_wait_edge_events(p.group->request, ns);
+}
+
+int pin_edge_read(struct pin_edge p, struct pin_event *evs, unsigned int max) {
+    if (max > PINMAP_EVENT_BUFFER) {
+        max = PINMAP_EVENT_BUFFER;
+    }
+
+    TRACE_BEGIN(TRACE_EVENT_READ, p.group->offsets[0]);
+    int n = gpiod_line_request_read_edge_events(p.group->request, p.group->events, max);
+    for (int i = 0; i < n; i++) {
+        struct gpiod_edge_event *ev = gpiod_edge_event_buffer_get_event(p.group->events, i);
+        evs[i].ts_ns = gpiod_edge_event_get_timestamp_ns(ev);
+        evs[i].type = gpiod_edge_event_get_event_type(ev) == GPIOD_EDGE_EVENT_RISING_EDGE
+            ? PIN_EVENT_RISING : PIN_EVENT_FALLING;
+    }
+    TRACE_END(TRACE_EVENT_READ, n);
+    return n;
+}
+
+#else
+
+// ---- libgpiod v1: one gpiod_line_bulk per group ----
+
+const char *pinmap_backend(void) {
+    return "libgpiod v1";
+}
+
+static int request_type(enum pin_mode mode) {
+    switch (mode) {
+    case PIN_OUTPUT:       return GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
+    case PIN_INPUT:        return GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+    case PIN_EDGE_RISING:  return GPIOD_LINE_REQUEST_EVENT_RISING_EDGE;
+    case PIN_EDGE_FALLING: return GPIOD_LINE_REQUEST_EVENT_FALLING_EDGE;
+    case PIN_EDGE_BOTH:    return GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES;
+    }
+    return GPIOD_LINE_REQUEST_DIRECTION_AS_IS;
+}
+
+static int request_flags(int flags) {
+    int f = 0;
+    if (flags & PIN_PULL_UP) f |= GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP;
+    if (flags & PIN_PULL_DOWN) f |= GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_DOWN;
+    return f;
+}
+
+static int request_group(struct gpiod_chip *chip, const char *consumer,
+                         struct pin_group *grp, const unsigned int *offsets,
+                         unsigned int count) {
+    struct gpiod_line_request_config config = {
+        .consumer = consumer,
+        .request_type = request_type(grp->mode),
+        .flags = request_flags(grp->flags),
+    };
+
+    if (gpiod_chip_get_lines(chip, (unsigned int *)offsets, count, &grp->bulk) < 0) {
+        return -1;
+    }
+    return gpiod_line_request_bulk(&grp->bulk, &config,
+                                   grp->mode == PIN_OUTPUT ? grp->values : NULL);
+}
+
+static void release_group(struct pin_group *grp) {
+    gpiod_line_release_bulk(&grp->bulk);
+}
+
+static int write_group(struct pin_group *grp) {
+    return gpiod_line_set_value_bulk(&grp->bulk, grp->values);
+}
+
+static int read_group(struct pin_group *grp) {
+    return gpiod_line_get_value_bulk(&grp->bulk, grp->values);
+}
+
+static struct gpiod_line *edge_line(struct pin_edge p) {
+    return gpiod_line_bulk_get_line(&p.group->bulk, 0);
+}
+
+unsigned int pin_edge_offset(struct pin_edge p) {
+    return gpiod_line_offset(edge_line(p));
+}
+
+int pin_edge_value(struct pin_edge p) {
+    return gpiod_line_get_value(edge_line(p));
+}
+
+int pin_edge_fd(struct pin_edge p) {
+    return gpiod_line_event_get_fd(edge_line(p));
+}
+
+int pin_edge_wait(struct pin_edge p, const struct timespec *timeout) {
+    return gpiod_line_event_wait(edge_line(p), timeout);
+}
+
+int pin_edge_read(struct pin_edge p, struct pin_event *evs, unsigned int max) {
+    struct gpiod_line_event raw[PINMAP_EVENT_BUFFER];
+    if (max > PINMAP_EVENT_BUFFER) {
+        max = PINMAP_EVENT_BUFFER;
+    }
+
+    TRACE_BEGIN(TRACE_EVENT_READ, pin_edge_offset(p));
+    int n = gpiod_line_event_read_multiple(edge_line(p), raw, max);
+    for (int i = 0; i < n; i++) {
+        evs[i].ts_ns = (uint64_t)raw[i].ts.tv_sec * 1000000000ULL + (uint64_t)raw[i].ts.tv_nsec;
+        evs[i].type = raw[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE
+            ? PIN_EVENT_RISING : PIN_EVENT_FALLING;
+    }
+    TRACE_END(TRACE_EVENT_READ, n);
+    return n;
+}
+
+#endif
+
+// ---- Common to both backends ----
+
+static void release_groups(struct pinmap *pm, unsigned int n) {
+    for (unsigned int g = 0; g < n; g++) {
+        release_group(&pm->groups[g]);
+    }
+}
+
+int pinmap_open(struct pinmap *pm, const char *chip_path, const char *consumer,
+                const struct pin_desc *pins, unsigned int num_pins) {
+    if (num_pins > PINMAP_MAX_PINS) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(pm, 0, sizeof(*pm));
+    pm->pins = pins;
+    pm->num_pins = num_pins;
+
+    // Group pins by configuration, keeping table order inside each group;
+    // edge pins always get a group (and so an event fd) of their own
+    unsigned int offsets[PINMAP_MAX_GROUPS][PINMAP_MAX_PINS];
+    unsigned int counts[PINMAP_MAX_GROUPS] = {0};
+    for (unsigned int i = 0; i < num_pins; i++) {
+        unsigned int g = 0;
+        while (g < pm->num_groups &&
+               (is_edge(pins[i].mode) ||
+                pm->groups[g].mode != pins[i].mode ||
+                pm->groups[g].flags != pins[i].flags ||
+                pm->groups[g].debounce_us != pins[i].debounce_us)) {
+            g++;
+        }
+        if (g == pm->num_groups) {
+            if (g == PINMAP_MAX_GROUPS) {
+                errno = EINVAL;
+                return -1;
+            }
+            pm->groups[g].mode = pins[i].mode;
+            pm->groups[g].flags = pins[i].flags;
+            pm->groups[g].debounce_us = pins[i].debounce_us;
+            pm->num_groups++;
+        }
+        pm->group_of[i] = (unsigned char)g;
+        pm->index_of[i] = (unsigned char)counts[g];
+        pm->groups[g].values[counts[g]] = pins[i].initial ? 1 : 0;
+        offsets[g][counts[g]++] = pins[i].offset;
+    }
+
+    pm->chip = gpiod_chip_open(chip_path);
+    if (!pm->chip) {
+        return -1;
+    }
+
+    for (unsigned int g = 0; g < pm->num_groups; g++) {
+        if (request_group(pm->chip, consumer, &pm->groups[g], offsets[g], counts[g]) < 0) {
+            int saved = errno;
+            release_groups(pm, g);
+            gpiod_chip_close(pm->chip);
+            pm->chip = NULL;
+            errno = saved;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void pinmap_close(struct pinmap *pm) {
+    if (!pm->chip) {
+        return;
+    }
+    release_groups(pm, pm->num_groups);
+    gpiod_chip_close(pm->chip);
+    pm->chip = NULL;
+}
+
+// Finds a pin of the wanted kind; returns its table index or -1
+static int find_pin(const struct pinmap *pm, const char *name, int want_edge, int want_mode) {
+    for (unsigned int i = 0; i < pm->num_pins; i++) {
+        if (strcmp(pm->pins[i].name, name) != 0) {
+            continue;
+        }
+        enum pin_mode mode = pm->pins[i].mode;
+        if (want_edge ? is_edge(mode) : (int)mode == want_mode) {
+            return (int)i;
+        }
+        break;
+    }
+    errno = ENOENT;
+    return -1;
+}
+
+int pinmap_out(struct pinmap *pm, const char *name, struct pin_out *out) {
+    int i = find_pin(pm, name, 0, PIN_OUTPUT);
+    if (i < 0) {
+        return -1;
+    }
+    out->group = &pm->groups[pm->group_of[i]];
+    out->index = pm->index_of[i];
+    return 0;
+}
+
+int pinmap_in(struct pinmap *pm, const char *name, struct pin_in *in) {
+    int i = find_pin(pm, name, 0, PIN_INPUT);
+    if (i < 0) {
+        return -1;
+    }
+    in->group = &pm->groups[pm->group_of[i]];
+    in->index = pm->index_of[i];
+    return 0;
+}
+
+int pinmap_edge(struct pinmap *pm, const char *name, struct pin_edge *edge) {
+    int i = find_pin(pm, name, 1, 0);
+    if (i < 0) {
+        return -1;
+    }
+    edge->group = &pm->groups[pm->group_of[i]];
+    return 0;
+}
+
+void pin_stage(struct pin_out p, int value) {
+    value = value ? 1 : 0;
+    if (p.group->values[p.index] != value) {
+        p.group->values[p.index] = value;
+        p.group->dirty = 1;
+    }
+}
+
+int pin_commit(struct pin_out p) {
+    if (!p.group->dirty) {
+        return 0;
+    }
+    if (write_group(p.group) < 0) {
+        return -1;
+    }
+    p.group->dirty = 0;
+    p.group->writes++;
+    return 0;
+}
+
+int pin_write(struct pin_out p, int value) {
+    pin_stage(p, value);
+    return pin_commit(p);
+}
+
+int pin_read(struct pin_in p) {
+    if (read_group(p.group) < 0) {
+        return -1;
+    }
+    return p.group->values[p.index];
+}
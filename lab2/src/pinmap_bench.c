@@ -0,0 +1,212 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdint.h>
+
+#include "lcd_api.h"
+#include "pinmap_api.h"
+#include "syscall_count_api.h"
+
+/*
+ * Pin map backend benchmark: libgpiod v1 vs v2.
+ *
+ * Uses only the pin map, so the same source builds on either backend.
+ * Build it twice and compare the two outputs:
+ *
+ *   cmake -S . -B build-v1 && cmake --build build-v1
+ *   cmake -S . -B build-v2 -DUSE_LIBGPIOD_V2=ON && cmake --build build-v2
+ *   sudo build-v1/pinmap_bench; sudo build-v2/pinmap_bench
+ *
+ * Two measurements:
+ *
+ *   bring-up    pinmap_open() + pinmap_close() of the LCD pins and the
+ *               loopback pair, mean time and syscalls per bring-up
+ *   throughput  Loopback: jumper OUT_PIN to IN_PIN. Toggles the output
+ *               `batch` times, then drains the input's events. Reports
+ *               edges/s, lost edges and syscalls per event on the read
+ *               side, for several batch sizes (1 = one event per wake-up)
+ *
+ * -d sets a kernel debounce period on the input (v2 only). Edges closer
+ * together than that are then dropped in the kernel and show up as lost,
+ * which is the point: they never reach the program.
+ *
+ * Syscalls are counted with the raw_syscalls:sys_enter tracepoint (needs
+ * root or perf_event_paranoid <= 1; "n/a" otherwise).
+ *
+ * Run: sudo ./pinmap_bench [-n edges] [-r reps] [-o out] [-i in] [-d us] [-c chip]
+ */
+
+#define CHIP "/dev/gpiochip4"
+#define OUT_PIN 20
+#define IN_PIN 21
+#define REPS 100
+#define EDGES 10000
+#define DRAIN_TIMEOUT_MS 100    // Give up on the rest of a batch after this long
+
+static const unsigned int BATCHES[] = { 1, 16, PINMAP_EVENT_BUFFER };
+#define NUM_BATCHES (sizeof(BATCHES) / sizeof(BATCHES[0]))
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int bench_bringup(const char *chip_path, const struct pin_desc *pins,
+                         unsigned int num_pins, int reps) {
+    long long sum = 0, best = -1;
+    unsigned int num_groups = 0;
+
+    syscall_count_take();
+    for (int r = 0; r < reps; r++) {
+        struct pinmap pm;
+        syscall_count_start();
+        long long t0 = now_ns();
+        if (pinmap_open(&pm, chip_path, "pinmap_bench", pins, num_pins) < 0) {
+            perror("pinmap_open");
+            return -1;
+        }
+        long long dt = now_ns() - t0;
+        syscall_count_pause();
+        num_groups = pm.num_groups;
+        pinmap_close(&pm);
+        sum += dt;
+        if (best < 0 || dt < best) best = dt;
+    }
+    long long calls = syscall_count_take();
+
+    printf("\nbring-up: %u pins in %u groups, %d reps\n", num_pins, num_groups, reps);
+    printf("  mean %.1f us, best %.1f us, ", sum / 1e3 / reps, best / 1e3);
+    if (calls >= 0) {
+        printf("%.1f syscalls\n", (double)calls / reps);
+    } else {
+        printf("syscalls n/a\n");
+    }
+    return 0;
+}
+
+// Drains up to `want` events; returns how many arrived before the timeout
+static long drain(struct pin_edge in, unsigned int want) {
+    struct pin_event evs[PINMAP_EVENT_BUFFER];
+    struct timespec timeout = { .tv_sec = 0, .tv_nsec = DRAIN_TIMEOUT_MS * 1000000L };
+    long got = 0;
+
+    while (got < (long)want) {
+        int ret = pin_edge_wait(in, &timeout);
+        if (ret <= 0) {
+            break;      // Timeout: the rest were lost (or debounced away)
+        }
+        int n = pin_edge_read(in, evs, PINMAP_EVENT_BUFFER);
+        if (n < 0) {
+            perror("pin_edge_read");
+            return -1;
+        }
+        got += n;
+    }
+    return got;
+}
+
+static int bench_throughput(struct pin_out out, struct pin_edge in, long edges) {
+    printf("\nthroughput: %ld edges per batch size (read side only)\n", edges);
+    printf("  %6s %12s %8s %12s\n", "batch", "edges/s", "lost", "syscalls/ev");
+
+    for (size_t b = 0; b < NUM_BATCHES; b++) {
+        unsigned int batch = BATCHES[b];
+        long got = 0, sent = 0;
+        long long busy_ns = 0;
+        int level = pin_edge_value(in);
+
+        syscall_count_take();
+        while (sent < edges) {
+            unsigned int k = batch;
+            if (sent + k > edges) k = (unsigned int)(edges - sent);
+            for (unsigned int i = 0; i < k; i++) {
+                level = !level;
+                pin_write(out, level);
+            }
+            sent += k;
+
+            syscall_count_start();
+            long long t0 = now_ns();
+            long n = drain(in, k);
+            busy_ns += now_ns() - t0;
+            syscall_count_pause();
+            if (n < 0) {
+                return -1;
+            }
+            got += n;
+        }
+        long long calls = syscall_count_take();
+
+        printf("  %6u %12.0f %8ld ", batch, busy_ns > 0 ? got * 1e9 / busy_ns : 0.0,
+               sent - got);
+        if (calls >= 0 && got > 0) {
+            printf("%12.2f\n", (double)calls / got);
+        } else {
+            printf("%12s\n", "n/a");
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *chip_path = CHIP;
+    unsigned int out_pin = OUT_PIN, in_pin = IN_PIN, debounce_us = 0;
+    int reps = REPS;
+    long edges = EDGES;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:o:i:d:c:")) != -1) {
+        switch (opt) {
+        case 'n': edges = atol(optarg); break;
+        case 'r': reps = atoi(optarg); break;
+        case 'o': out_pin = (unsigned int)atoi(optarg); break;
+        case 'i': in_pin = (unsigned int)atoi(optarg); break;
+        case 'd': debounce_us = (unsigned int)atoi(optarg); break;
+        case 'c': chip_path = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-n edges] [-r reps] [-o out] [-i in] "
+                            "[-d us] [-c chip]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps <= 0) reps = REPS;
+    if (edges <= 0) edges = EDGES;
+
+    const struct pin_desc pins[] = {
+        LCD_PIN_DESCS,
+        { "out", out_pin, PIN_OUTPUT, 0, 0, 0 },
+        { "in", in_pin, PIN_EDGE_BOTH, 0, 0, debounce_us },
+    };
+    const unsigned int num_pins = sizeof(pins) / sizeof(pins[0]);
+
+    printf("Backend: %s\n", pinmap_backend());
+    if (syscall_count_open() < 0) {
+        fprintf(stderr, "Warning: cannot count syscalls (need root or a lower "
+                        "perf_event_paranoid)\n");
+    }
+
+    if (bench_bringup(chip_path, pins, num_pins, reps) < 0) {
+        return 1;
+    }
+
+    struct pinmap pm;
+    struct pin_out out;
+    struct pin_edge in;
+    if (pinmap_open(&pm, chip_path, "pinmap_bench", pins, num_pins) < 0) {
+        perror("pinmap_open");
+        return 1;
+    }
+    if (pinmap_out(&pm, "out", &out) < 0 || pinmap_edge(&pm, "in", &in) < 0) {
+        perror("loopback pins");
+        pinmap_close(&pm);
+        return 1;
+    }
+
+    int ret = bench_throughput(out, in, edges);
+    pinmap_close(&pm);
+    return ret < 0 ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+#ifndef ADPCM_API_H
+#define ADPCM_API_H
+
+/**
+ * @file adpcm_api.h
+ * @brief IMA (DVI) ADPCM: 4 bits per sample, in WAV blocks
+ *
+ * Each sample is coded as a 4-bit step relative to a predictor, with the
+ * step size adapting through the standard 89-entry table. 16-bit mono
+ * audio shrinks 4:1 (a little less, for the block headers), and decoding
+ * is a fixed handful of adds and compares per sample with no multiplies.
+ *
+ * The layout is Microsoft's WAVE_FORMAT_IMA_ADPCM, so files from sox or
+ * ffmpeg play too. Data comes in blocks of block_align bytes. Each block
+ * starts with a 4-byte header per channel: the first sample (int16), the
+ * step index and a reserved byte. After the headers come 4-byte groups
+ * per channel (8 samples each), low nibble first. Every block decodes on
+ * its own, so playback can start at any block.
+ *
+ * Encoding is done offline (adpcm_encode); wav_api decodes ADPCM files
+ * like any other format, one block at a time, as the player reads them.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WAV_FORMAT_IMA_ADPCM 0x0011
+#define ADPCM_BLOCK_ALIGN 512       // Default block: 1017 mono samples, ~23 ms at 44.1 kHz
+#define ADPCM_MAX_BLOCK_ALIGN 8192
+#define ADPCM_MAX_CHANNELS 32
+
+/**
+ * @brief Predictor and step index, carried from sample to sample
+ */
+struct adpcm_state {
+    int32_t predictor;
+    int32_t index;              /**< 0..88 */
+};
+
+extern const int16_t adpcm_step_table[89];
+extern const int8_t adpcm_index_table[16];
+
+/**
+ * @brief Decodes one nibble
+ *
+ * @return The reconstructed sample
+ */
+static inline int16_t adpcm_decode_nibble(struct adpcm_state *s, unsigned nibble) {
+    int32_t step = adpcm_step_table[s->index];
+    int32_t diff = step >> 3;
+    if (nibble & 1) diff += step >> 2;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 4) diff += step;
+    int32_t p = nibble & 8 ? s->predictor - diff : s->predictor + diff;
+    s->predictor = p < -32768 ? -32768 : p > 32767 ? 32767 : p;
+
+    int32_t i = s->index + adpcm_index_table[nibble];
+    s->index = i < 0 ? 0 : i > 88 ? 88 : i;
+    return (int16_t)s->predictor;
+}
+
+/**
+ * @brief Encodes one sample, updating the state as the decoder will
+ *
+ * @return The nibble
+ */
+unsigned adpcm_encode_nibble(struct adpcm_state *s, int16_t sample);
+
+/**
+ * @brief Returns the samples per channel in a block of block_align bytes
+ *
+ * @return The count, or 0 if block_align does not fit the channel count
+ */
+unsigned adpcm_samples_per_block(unsigned block_align, unsigned channels);
+
+/**
+ * @brief Returns the frames in a block cut to bytes (the last of a file)
+ */
+size_t adpcm_block_frames(size_t bytes, unsigned channels);
+
+/**
+ * @brief Encodes one mono block
+ *
+ * The block's header stores in[0] exactly and the state's step index;
+ * the state carries on into the next block. A short final block is padded
+ * with silence to whole 8-sample groups.
+ *
+ * @param s Encoder state
+ * @param in Samples, at most adpcm_samples_per_block(block_align, 1)
+ * @param count Samples in
+ * @param out Receives the block
+ * @return Bytes written (block_align, or less for a short final block)
+ */
+size_t adpcm_encode_block(struct adpcm_state *s, const int16_t *in, size_t count, uint8_t *out);
+
+/**
+ * @brief Decodes a whole block to mono, averaging the channels
+ *
+ * @param block The block
+ * @param bytes Its length (block_align, or less for a cut final block)
+ * @param channels Channels in the block
+ * @param out Receives adpcm_block_frames(bytes, channels) samples
+ * @return Frames decoded
+ */
+size_t adpcm_decode_block(const uint8_t *block, size_t bytes, unsigned channels, int16_t *out);
+
+/**
+ * @brief Builds a mono IMA ADPCM WAV file in memory
+ *
+ * @param in 16-bit mono samples
+ * @param frames How many
+ * @param sample_rate Their rate
+ * @param block_align Block size (ADPCM_BLOCK_ALIGN, or 8 + 4n up to
+ *        ADPCM_MAX_BLOCK_ALIGN)
+ * @param len Receives the file's length
+ * @return The file (free() it), or NULL (errno set)
+ */
+uint8_t *adpcm_wav_encode(const int16_t *in, size_t frames, uint32_t sample_rate,
+                          unsigned block_align, size_t *len);
+
+#endif // ADPCM_API_H
@@ -0,0 +1,146 @@
+#ifndef AUDIO_PIPE_API_H
+#define AUDIO_PIPE_API_H
+
+/**
+ * @file audio_pipe_api.h
+ * @brief Decoder thread feeding the sample task through a lock-free ring
+ *
+ * Anything slow between the file and the pin (format conversion today;
+ * decompression or resampling later) runs on a decoder thread, not in the
+ * sample task. The decoder fills fixed-size blocks of 16-bit mono samples
+ * into a single-producer/single-consumer ring; the sample task takes one
+ * sample per tick with audio_pipe_pop(), which never blocks, locks or
+ * calls the kernel.
+ *
+ * The ring holds AUDIO_PIPE_BLOCKS blocks of AUDIO_PIPE_BLOCK_FRAMES
+ * frames (85 ms at 48 kHz), so the decoder can stall that long without
+ * the output noticing. Sources that react to input (the mixer) trade that
+ * margin for latency with audio_pipe_set_depth(). If it stalls longer, the ring runs dry: each tick
+ * with no sample ready is counted as an underrun and the caller holds its
+ * last output until samples arrive again. The clock never waits for the
+ * decoder.
+ *
+ * Only the head and tail block counters are shared. The decoder publishes
+ * a block with a release store of head after filling it; the output
+ * releases it with a release store of tail after its last sample. Each
+ * counter sits on its own cache line.
+ *
+ * The decoder thread runs under SCHED_OTHER even when the process is in
+ * real-time mode, so on a shared CPU the SCHED_FIFO sample task always
+ * preempts it.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AUDIO_PIPE_BLOCK_FRAMES 256
+#define AUDIO_PIPE_BLOCKS 16            // Power of two
+#define AUDIO_PIPE_PREFILL 2            // Blocks decoded before audio_pipe_start() returns
+#define AUDIO_PIPE_POLL_US 1000         // Decoder sleep while the ring is full
+
+/**
+ * @brief Decoder callback
+ *
+ * @param arg The pointer passed to audio_pipe_start()
+ * @param frame First frame wanted
+ * @param out Receives up to count samples
+ * @param count Frames wanted
+ * @return Frames produced; 0 at the end of the stream
+ */
+typedef size_t (*audio_decode_fn)(void *arg, size_t frame, int16_t *out, size_t count);
+
+struct audio_pipe_block {
+    size_t len;                                 /**< Samples in this block */
+    int16_t samples[AUDIO_PIPE_BLOCK_FRAMES];
+};
+
+/**
+ * @brief Ring state, decoder statistics and output statistics
+ */
+struct audio_pipe {
+    struct audio_pipe_block blocks[AUDIO_PIPE_BLOCKS];
+
+    _Alignas(64) atomic_size_t head;    /**< Blocks filled (decoder writes) */
+    atomic_size_t depth;                /**< Blocks the decoder keeps ahead */
+    atomic_int done;                    /**< Decoder reached the end */
+    atomic_int stop;                    /**< Set to end the decoder early */
+    audio_decode_fn decode;
+    void *arg;
+    size_t next_frame;                  /**< Next frame to decode */
+    pthread_t thread;
+    int running;                        /**< thread needs joining */
+    long long decode_ns_max;            /**< Slowest block */
+    long long decode_ns_total;
+    long blocks_decoded;
+
+    _Alignas(64) atomic_size_t tail;    /**< Blocks consumed (output writes) */
+    size_t pos;                         /**< Next sample in the tail block */
+    int starving;                       /**< Last pop was an underrun */
+    atomic_long underruns;              /**< Ticks with no sample ready */
+    atomic_long underrun_runs;          /**< Separate stretches of underruns */
+};
+
+/**
+ * @brief Decodes the first blocks and starts the decoder thread
+ *
+ * @param p Pipe state (owned by the caller, must outlive the thread)
+ * @param decode Decoder callback, called from the decoder thread
+ * @param arg Passed to decode
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int audio_pipe_start(struct audio_pipe *p, audio_decode_fn decode, void *arg);
+
+/**
+ * @brief Takes the next sample; for the sample task
+ *
+ * @param p The pipe
+ * @param sample Receives the sample when 1 is returned
+ * @return 1 with a sample, 0 at the end of the stream, -1 on underrun
+ */
+static inline int audio_pipe_pop(struct audio_pipe *p, int16_t *sample) {
+    size_t tail = atomic_load_explicit(&p->tail, memory_order_relaxed);
+    if (tail == atomic_load_explicit(&p->head, memory_order_acquire)) {
+        // done is set after the last head store, so recheck head after it
+        if (atomic_load_explicit(&p->done, memory_order_acquire) &&
+            tail == atomic_load_explicit(&p->head, memory_order_acquire)) {
+            return 0;
+        }
+        atomic_fetch_add_explicit(&p->underruns, 1, memory_order_relaxed);
+        if (!p->starving) {
+            atomic_fetch_add_explicit(&p->underrun_runs, 1, memory_order_relaxed);
+            p->starving = 1;
+        }
+        return -1;
+    }
+    p->starving = 0;
+
+    const struct audio_pipe_block *b = &p->blocks[tail % AUDIO_PIPE_BLOCKS];
+    *sample = b->samples[p->pos];
+    if (++p->pos == b->len) {
+        p->pos = 0;
+        atomic_store_explicit(&p->tail, tail + 1, memory_order_release);
+    }
+    return 1;
+}
+
+/**
+ * @brief Limits how far ahead of the output the decoder runs
+ *
+ * Fewer blocks mean less delay between the source changing (a new voice)
+ * and the output hearing it, and less margin for decoder stalls.
+ *
+ * @param p The pipe
+ * @param blocks 1 to AUDIO_PIPE_BLOCKS (clamped)
+ */
+void audio_pipe_set_depth(struct audio_pipe *p, size_t blocks);
+
+/**
+ * @brief Stops the decoder thread (if still running) and waits for it
+ *
+ * @param p The pipe
+ */
+void audio_pipe_stop(struct audio_pipe *p);
+
+#endif // AUDIO_PIPE_API_H
@@ -0,0 +1,234 @@
+#ifndef AUDIO_SINK_API_H
+#define AUDIO_SINK_API_H
+
+/**
+ * @file audio_sink_api.h
+ * @brief Where the sample task's output goes
+ *
+ * The sample task hands each tick's output, a bit for the 1-bit path or a
+ * sample for the PWM path, to a sink. Swapping the sink is how the audio
+ * path is checked without a Pi:
+ *
+ *   AUDIO_SINK_LINE  a GPIO line, through a setter the program supplies;
+ *                    written only when the level changes
+ *   AUDIO_SINK_PWM   the hardware PWM duty cycle (pwm_audio_api.h)
+ *   AUDIO_SINK_FILE  the output stream, written to a file: bits packed
+ *                    8 per byte MSB first (as sdm_offline -o writes them),
+ *                    samples as native-endian signed 16-bit
+ *   AUDIO_SINK_NULL  discarded; only counted
+ *   AUDIO_SINK_MOCK  a stand-in line that records the CLOCK_MONOTONIC
+ *                    time of every tick, for jitter and drift analysis
+ *
+ * File and null sinks are meant for rendering as fast as possible; the
+ * mock sink for running against the real clock. The mock's timestamp
+ * array is allocated when it is opened, so open it before rt_apply() and
+ * mlockall() faults it in; recording a tick is then one clock_gettime()
+ * and a store.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "pwm_audio_api.h"
+
+#define AUDIO_SINK_FILE_BUFFER 4096     // Bytes collected per fwrite()
+
+enum audio_sink_kind {
+    AUDIO_SINK_LINE,
+    AUDIO_SINK_PWM,
+    AUDIO_SINK_FILE,
+    AUDIO_SINK_NULL,
+    AUDIO_SINK_MOCK,
+};
+
+/**
+ * @brief Sets a GPIO line; ctx is the pointer given to audio_sink_line()
+ */
+typedef void (*audio_line_fn)(void *ctx, int level);
+
+/**
+ * @brief An output sink and its counters
+ */
+struct audio_sink {
+    enum audio_sink_kind kind;
+    uint64_t ticks;                 /**< Bits or samples received */
+    uint64_t writes;                /**< Level changes (line, mock) */
+    uint64_t skipped;               /**< Ticks passed over by audio_sink_skip() */
+    int level;                      /**< Last level, -1 before the first */
+
+    audio_line_fn set_line;         /**< LINE */
+    void *line_ctx;
+    struct pwm_audio *pwm;          /**< PWM */
+
+    FILE *file;                     /**< FILE */
+    uint8_t buf[AUDIO_SINK_FILE_BUFFER];
+    size_t buf_len;
+    unsigned bit_byte;              /**< Bits collected for the next byte */
+    int bit_count;
+    int file_error;
+
+    int64_t *stamps;                /**< MOCK: ns of each tick, -1 if skipped */
+    uint64_t max_stamps;
+};
+
+/**
+ * @brief A sink driving a GPIO line through set_line
+ */
+void audio_sink_line(struct audio_sink *s, audio_line_fn set_line, void *ctx);
+
+/**
+ * @brief A sink writing PWM duty cycles; pwm must already be open
+ */
+void audio_sink_pwm(struct audio_sink *s, struct pwm_audio *pwm);
+
+/**
+ * @brief A sink writing the stream to a file
+ *
+ * @param s Filled in on success
+ * @param path The file, created or truncated
+ * @return 0 on success, -1 on error (errno set)
+ */
+int audio_sink_file(struct audio_sink *s, const char *path);
+
+/**
+ * @brief A sink that only counts
+ */
+void audio_sink_null(struct audio_sink *s);
+
+/**
+ * @brief A mock line recording one timestamp per tick
+ *
+ * Ticks beyond max_ticks are counted but not recorded.
+ *
+ * @param s Filled in on success
+ * @param max_ticks Timestamps to allocate room for
+ * @return 0 on success, -1 if out of memory
+ */
+int audio_sink_mock(struct audio_sink *s, uint64_t max_ticks);
+
+// Slow paths, out of line
+void audio_sink_put_byte(struct audio_sink *s, uint8_t byte);
+void audio_sink_put_line(struct audio_sink *s, int level);
+
+/**
+ * @brief Outputs one bit (1-bit path)
+ */
+static inline void audio_sink_bit(struct audio_sink *s, int level) {
+    switch (s->kind) {
+    case AUDIO_SINK_LINE:
+        if (level != s->level) {
+            audio_sink_put_line(s, level);
+        }
+        break;
+    case AUDIO_SINK_FILE:
+        s->bit_byte = s->bit_byte << 1 | (unsigned)level;
+        if (++s->bit_count == 8) {
+            audio_sink_put_byte(s, (uint8_t)s->bit_byte);
+            s->bit_byte = 0;
+            s->bit_count = 0;
+        }
+        break;
+    case AUDIO_SINK_MOCK:
+        if (s->ticks < s->max_stamps) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            s->stamps[s->ticks] = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+        }
+        if (level != s->level) {
+            s->level = level;
+            s->writes++;
+        }
+        break;
+    default:
+        break;
+    }
+    s->ticks++;
+}
+
+/**
+ * @brief Outputs one sample (multi-level path)
+ *
+ * The line and mock sinks output its sign, as the clipper would.
+ */
+static inline void audio_sink_sample(struct audio_sink *s, int16_t sample) {
+    switch (s->kind) {
+    case AUDIO_SINK_PWM:
+        pwm_audio_write(s->pwm, sample);
+        s->ticks++;
+        break;
+    case AUDIO_SINK_FILE:
+        audio_sink_put_byte(s, (uint8_t)((uint16_t)sample & 0xFF));
+        audio_sink_put_byte(s, (uint8_t)((uint16_t)sample >> 8));
+        s->ticks++;
+        break;
+    default:
+        audio_sink_bit(s, sample >= 0);
+        break;
+    }
+}
+
+/**
+ * @brief Passes over ticks the clock skipped
+ *
+ * Nothing is output and the level holds; the tick count moves on, so the
+ * mock's timestamps stay indexed by tick.
+ */
+static inline void audio_sink_skip(struct audio_sink *s, unsigned n) {
+    if (s->kind == AUDIO_SINK_MOCK) {
+        for (uint64_t i = s->ticks; i < s->ticks + n && i < s->max_stamps; i++) {
+            s->stamps[i] = -1;
+        }
+    }
+    s->ticks += n;
+    s->skipped += n;
+}
+
+/**
+ * @brief Flushes and closes a file, frees the mock's timestamps
+ *
+ * Does not close a PWM channel or GPIO line; their owner does.
+ *
+ * @return 0, or -1 if writing the file failed (errno set)
+ */
+int audio_sink_close(struct audio_sink *s);
+
+/**
+ * @brief Timing of the ticks a mock sink recorded
+ */
+struct audio_sink_timing {
+    uint64_t ticks;                 /**< Timestamps analysed (skipped ticks excluded) */
+    double period_ns;               /**< Mean interval */
+    double interval_min_ns;
+    double interval_max_ns;
+    double interval_sd_ns;          /**< Standard deviation of the interval */
+    double drift_ns;                /**< Elapsed time minus the ideal, at the end */
+    double drift_ppm;
+    double late_max_ns;             /**< Worst lateness against the ideal grid */
+};
+
+/**
+ * @brief Analyses the recorded ticks against an ideal tick rate
+ *
+ * The ideal grid starts at the first tick and advances by exactly
+ * 1e9 / ideal_hz ns, so a timer period truncated to whole nanoseconds
+ * shows up as drift. Skipped ticks keep their place on the grid; the
+ * intervals are taken between consecutive ticks that both played.
+ *
+ * @param s A mock sink
+ * @param ideal_hz The intended tick rate (sample rate times OSR)
+ * @param t Filled in
+ * @return 0, or -1 if fewer than two ticks were recorded
+ */
+int audio_sink_timing(const struct audio_sink *s, double ideal_hz, struct audio_sink_timing *t);
+
+/**
+ * @brief Writes the recorded ticks as text, one "tick ns" line each
+ *
+ * Times are relative to the first tick; skipped ticks are left out.
+ *
+ * @return 0, or -1 on error (errno set)
+ */
+int audio_sink_write_log(const struct audio_sink *s, const char *path);
+
+#endif // AUDIO_SINK_API_H
@@ -0,0 +1,118 @@
+#ifndef BITCACHE_API_H
+#define BITCACHE_API_H
+
+/**
+ * @file bitcache_api.h
+ * @brief Pre-rendered 1-bit audio, cached on disk
+ *
+ * Modulating in the sample task means converting the WAV format,
+ * interpolating and running the modulator on every tick. The bit cache
+ * does all of that once: it renders the file to the bitstream the pin
+ * will output (SDM_CLIP, or sigma-delta PDM at any oversampling ratio),
+ * packed 8 ticks per byte, MSB first, and stores it on disk. The sample
+ * task then only shifts the next bit out of the current byte.
+ *
+ * The cache file is named after a 64-bit FNV-1a hash (a word at a time)
+ * of the sample data, the format and the modulator settings, so an edited
+ * file or different settings render again, and a second run of the same
+ * file maps the stored bitstream straight away. At 1x the bitstream is 16 times smaller
+ * than 16-bit mono data (8 times smaller than 8-bit); at OSR n it is n
+ * times larger than that.
+ *
+ * Rendering is serial where it has to be (a sigma-delta loop feeds each
+ * bit back into the next); the clipper at 1x is a plain compare the
+ * compiler vectorizes, and packing turns 8 bit-bytes into one with a
+ * single multiply.
+ *
+ * If the cache directory cannot be written, the bitstream is rendered
+ * into memory and playback goes ahead uncached.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdm_api.h"
+#include "wav_api.h"
+
+#define BITCACHE_VERSION 2
+#define BITCACHE_SUBDIR "chipi_chapa"   // Under $XDG_CACHE_HOME or ~/.cache
+
+/**
+ * @brief Where a bitstream came from
+ */
+enum bitcache_source {
+    BITCACHE_HIT,       /**< Mapped from an existing cache file */
+    BITCACHE_RENDERED,  /**< Rendered and written to the cache */
+    BITCACHE_MEMORY,    /**< Rendered, but the cache could not be written */
+};
+
+/**
+ * @brief A rendered bitstream
+ */
+struct bitcache {
+    const uint8_t *bits;        /**< Packed ticks, MSB first */
+    uint64_t num_bits;          /**< Ticks: frames * osr */
+    uint64_t key;               /**< Hash the cache file is named after */
+    enum bitcache_source source;
+    long long render_ns;        /**< Time spent hashing and rendering or loading */
+    char path[256];             /**< Cache file, or empty */
+
+    void *map;                  /**< Mapped cache file, or NULL */
+    size_t map_size;
+    void *buffer;               /**< Bitstream in memory, or NULL */
+};
+
+/**
+ * @brief Default cache directory: $XDG_CACHE_HOME/chipi_chapa, else
+ *        ~/.cache/chipi_chapa, else /tmp/chipi_chapa
+ *
+ * @param buf Receives the path
+ * @param len Size of buf
+ * @return buf
+ */
+const char *bitcache_default_dir(char *buf, size_t len);
+
+/**
+ * @brief Hashes a WAV file's samples and format with the modulator settings
+ */
+uint64_t bitcache_key(const struct wav *w, enum sdm_order order, int osr);
+
+/**
+ * @brief Gets the bitstream for a file, from the cache or by rendering it
+ *
+ * @param c Filled in on success
+ * @param w The parsed WAV file
+ * @param order Modulator
+ * @param osr Output bits per sample
+ * @param dir Cache directory (created if missing), or NULL to not cache
+ * @return 0 on success, -1 on error (errno set)
+ */
+int bitcache_open(struct bitcache *c, const struct wav *w, enum sdm_order order,
+                  int osr, const char *dir);
+
+/**
+ * @brief Renders a WAV file to packed bits without touching the cache
+ *
+ * @param w The parsed WAV file
+ * @param order Modulator
+ * @param osr Output bits per sample
+ * @param out Receives (frames * osr + 7) / 8 bytes
+ * @return 0 on success, -1 if out of memory
+ */
+int bitcache_render(const struct wav *w, enum sdm_order order, int osr, uint8_t *out);
+
+/**
+ * @brief Returns tick k of a bitstream (for checks; the sample task shifts)
+ */
+static inline int bitcache_bit(const struct bitcache *c, uint64_t k) {
+    return c->bits[k >> 3] >> (7 - (k & 7)) & 1;
+}
+
+/**
+ * @brief Unmaps or frees the bitstream
+ *
+ * @param c The bitstream
+ */
+void bitcache_close(struct bitcache *c);
+
+#endif // BITCACHE_API_H
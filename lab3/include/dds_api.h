@@ -0,0 +1,189 @@
+#ifndef DDS_API_H
+#define DDS_API_H
+
+/**
+ * @file dds_api.h
+ * @brief Direct digital synthesis of square-wave tones, and a sequencer
+ *
+ * Instead of reprogramming a timer to half the tone's period (only
+ * periods that are whole nanoseconds, and a restart for every change),
+ * the buzzer is driven from one fixed-rate tick, DDS_TICK_HZ. Each tick
+ * adds a 32-bit increment to a phase accumulator and outputs its top bit:
+ *
+ *   increment = f * 2^32 / DDS_TICK_HZ
+ *
+ * The accumulator wraps f times per second on average, so any frequency
+ * up to DDS_TICK_HZ / 2 is produced to within DDS_TICK_HZ / 2^32 (about
+ * 10 uHz). Each edge still lands on a tick, so a single period can be up
+ * to one tick (25 us) off; the average is exact. DDS_TICK_HZ is chosen so
+ * the tick period is a whole number of nanoseconds, which keeps the tick
+ * rate itself exact.
+ *
+ * Changing the tone is one store of the increment, safe from another
+ * thread while the tick runs. Ticks the clock skipped (see
+ * sample_clock_api.h) are passed over with dds_skip(), which moves the
+ * phase on as if they had run, so the tone stays in phase with the clock.
+ *
+ * The sequencer plays a table of notes (frequency and duration) from the
+ * same tick: it counts down each note's ticks and loads the next
+ * increment, so a melody needs no timer changes at all. rtttl_parse()
+ * builds such a table from an RTTTL ringtone string, e.g.
+ *
+ *   "scale:d=8,o=5,b=120:c,d,e,f,g,a,b,c6"
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DDS_TICK_HZ 40000           // 25000 ns tick
+#define DDS_NOTE_GAP_MS 10          // Silence at the end of each note, so repeats are heard
+#define RTTTL_MAX_NOTES 256
+
+/**
+ * @brief Phase accumulator
+ */
+struct dds {
+    uint32_t phase;
+    atomic_uint increment;          /**< Phase step per tick */
+    uint32_t tick_hz;
+};
+
+/**
+ * @brief One entry of a melody; freq_mhz 0 is a rest
+ */
+struct dds_note {
+    uint32_t freq_mhz;              /**< Frequency in millihertz */
+    uint32_t ms;                    /**< Duration */
+};
+
+/**
+ * @brief Plays a note table from the tick
+ */
+struct dds_seq {
+    struct dds dds;
+    const struct dds_note *notes;
+    int num_notes;
+    int index;                      /**< Note playing */
+    uint32_t ticks_left;            /**< Ticks left in this note */
+    uint32_t gap_ticks;             /**< Final ticks of each note kept silent */
+    int sounding;                   /**< Current note is not a rest */
+};
+
+/**
+ * @brief Returns the increment for a frequency, rounded to nearest
+ *
+ * @param tick_hz Tick rate
+ * @param freq_mhz Frequency in millihertz (below tick_hz / 2)
+ */
+uint32_t dds_increment(uint32_t tick_hz, uint32_t freq_mhz);
+
+/**
+ * @brief Returns the frequency an increment actually produces, in Hz
+ */
+double dds_actual_hz(uint32_t tick_hz, uint32_t increment);
+
+/**
+ * @brief Resets an accumulator to silence
+ */
+void dds_init(struct dds *d, uint32_t tick_hz);
+
+/**
+ * @brief Changes the tone; callable while the tick runs
+ *
+ * @param d The accumulator
+ * @param freq_mhz Frequency in millihertz, 0 for silence
+ */
+void dds_set_freq(struct dds *d, uint32_t freq_mhz);
+
+/**
+ * @brief Advances one tick
+ *
+ * @return The output level, 0 or 1
+ */
+static inline int dds_step(struct dds *d) {
+    d->phase += atomic_load_explicit(&d->increment, memory_order_relaxed);
+    return (int)(d->phase >> 31);
+}
+
+/**
+ * @brief Advances n ticks without output
+ */
+static inline void dds_skip(struct dds *d, unsigned n) {
+    d->phase += atomic_load_explicit(&d->increment, memory_order_relaxed) * n;
+}
+
+/**
+ * @brief Prepares a note table for playback
+ *
+ * @param s The sequencer
+ * @param notes The table; must outlive the playback
+ * @param num_notes Entries
+ * @param tick_hz Tick rate
+ */
+void dds_seq_init(struct dds_seq *s, const struct dds_note *notes, int num_notes,
+                  uint32_t tick_hz);
+
+// Loads the note at s->index
+void dds_seq_load(struct dds_seq *s);
+
+/**
+ * @brief Advances one tick of the melody
+ *
+ * @param s The sequencer
+ * @return The output level (0 or 1), or -1 once the last note has ended
+ */
+static inline int dds_seq_step(struct dds_seq *s) {
+    if (s->ticks_left == 0) {
+        if (++s->index >= s->num_notes) {
+            return -1;
+        }
+        dds_seq_load(s);
+    }
+    s->ticks_left--;
+    int level = dds_step(&s->dds);
+    return s->sounding && s->ticks_left >= s->gap_ticks ? level : 0;
+}
+
+/**
+ * @brief Advances n ticks of the melody without output
+ *
+ * Notes that end within the skipped ticks are passed over, so the tempo
+ * holds through an overrun.
+ *
+ * @return 0, or -1 if the melody ended
+ */
+static inline int dds_seq_skip(struct dds_seq *s, unsigned n) {
+    while (n > 0) {
+        if (s->ticks_left == 0) {
+            if (++s->index >= s->num_notes) {
+                return -1;
+            }
+            dds_seq_load(s);
+        }
+        uint32_t run = s->ticks_left < n ? s->ticks_left : n;
+        s->ticks_left -= run;
+        dds_skip(&s->dds, run);
+        n -= run;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses an RTTTL ringtone into a note table
+ *
+ * Accepts "name:d=N,o=N,b=N:notes" with the usual note syntax
+ * ([duration]note[#][.][octave][.], notes a-g, p for a pause). Missing
+ * defaults are d=4, o=6, b=63. Whitespace is ignored.
+ *
+ * @param text The ringtone
+ * @param notes Receives the notes
+ * @param max_notes Size of notes
+ * @param name Receives the name (may be NULL)
+ * @param name_len Size of name
+ * @return Number of notes, or -1 if malformed (errno = EINVAL)
+ */
+int rtttl_parse(const char *text, struct dds_note *notes, int max_notes,
+                char *name, size_t name_len);
+
+#endif // DDS_API_H
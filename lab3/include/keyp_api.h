@@ -10,30 +10,26 @@
  */
 
 #include <gpiod.h>
+#include "pinmap_api.h"
 
 /**
  * @brief Initializes the keypad
  * 
- * Sets up the GPIO lines for the keypad matrix. Columns are configured as
- * inputs with interrupts, rows are configured as outputs.
+ * Takes the keypad pins from a pin map (see pinmap_api.h). Columns are
+ * inputs with edge events, rows are outputs; keeping the rows in one
+ * output group lets a scan step drive all four with one group write.
  * 
- * @param chip_arg The gpiod_chip containing the keypad GPIO lines
- * @param c1_line The GPIO line for column 1
- * @param c2_line The GPIO line for column 2
- * @param c3_line The GPIO line for column 3
- * @param r1_line The GPIO line for row 1
- * @param r2_line The GPIO line for row 2
- * @param r3_line The GPIO line for row 3
- * @param r4_line The GPIO line for row 4
+ * @param c1 The edge pin for column 1
+ * @param c2 The edge pin for column 2
+ * @param c3 The edge pin for column 3
+ * @param r1 The output for row 1
+ * @param r2 The output for row 2
+ * @param r3 The output for row 3
+ * @param r4 The output for row 4
  */
-void keyp_init(struct gpiod_chip *chip_arg, 
-              struct gpiod_line *c1_line, 
-              struct gpiod_line *c2_line,
-              struct gpiod_line *c3_line, 
-              struct gpiod_line *r1_line,
-              struct gpiod_line *r2_line, 
-              struct gpiod_line *r3_line,
-              struct gpiod_line *r4_line);
+void keyp_init(struct pin_edge c1, struct pin_edge c2, struct pin_edge c3,
+               struct pin_out r1, struct pin_out r2,
+               struct pin_out r3, struct pin_out r4);
 
 /**
  * @brief Scans the keypad to detect which key is pressed
@@ -46,10 +42,10 @@ void keyp_init(struct gpiod_chip *chip_arg,
 char keyp_scan(void);
 
 /**
- * @brief Gets the column GPIO lines array
+ * @brief Gets the column edge pins
  * 
- * @return Pointer to the array of column GPIO lines
+ * @return Pointer to the array of the three column pins
  */
-struct gpiod_line** keyp_get_cols(void);
+struct pin_edge *keyp_get_cols(void);
 
 #endif // KEYP_API_H
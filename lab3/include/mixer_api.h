@@ -0,0 +1,162 @@
+#ifndef MIXER_API_H
+#define MIXER_API_H
+
+/**
+ * @file mixer_api.h
+ * @brief Sound-effect mixer: several clips at once, per-voice gain
+ *
+ * Clips are converted to 16-bit mono once, when loaded (wav_read()), so
+ * mixing is only scale-and-add. Up to MIXER_VOICES voices play at once;
+ * triggering a clip when all are busy takes over the voice closest to its
+ * end.
+ *
+ * The mixer is an audio_pipe decoder (mixer_decode()): each call mixes one
+ * block on the decoder thread, and the sample task plays it through the
+ * usual 1-bit or PWM path. Each voice is scaled by its Q15 gain and added
+ * into an int16 block with saturating adds, eight samples per instruction
+ * with NEON (the Pi) or SSE2 (a PC), with a scalar loop otherwise.
+ * Overload clips at full scale instead of wrapping around.
+ *
+ * Triggers come from another thread (keypad or button handling) through a
+ * small single-producer queue and start at the next block boundary, so a
+ * new voice never interrupts the ones already playing. The delay before it
+ * is heard is the pipe depth (MIXER_PIPE_DEPTH blocks) plus at most one
+ * block.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MIXER_VOICES 8
+#define MIXER_QUEUE 16              // Pending triggers (power of two)
+#define MIXER_PIPE_DEPTH 3          // audio_pipe blocks to run ahead: 16 ms at 48 kHz
+#define MIXER_GAIN_UNITY 32767      // Q15 gain of 1.0
+
+/**
+ * @brief A clip, converted to 16-bit mono at the mixer's rate
+ */
+struct mixer_clip {
+    int16_t *samples;
+    size_t len;
+    unsigned sample_rate;
+    char name[48];
+};
+
+/**
+ * @brief A playing clip
+ */
+struct mixer_voice {
+    const struct mixer_clip *clip;  /**< NULL when free */
+    size_t pos;                     /**< Next sample */
+    int16_t gain;                   /**< Q15 */
+};
+
+/**
+ * @brief A request from the trigger thread
+ */
+struct mixer_trigger {
+    int clip;                       /**< Clip index, or -1 to stop all voices */
+    int16_t gain;
+};
+
+/**
+ * @brief Mixer state
+ *
+ * Voices and statistics belong to the decoder thread; the queue is shared
+ * with one trigger thread.
+ */
+struct mixer {
+    const struct mixer_clip *clips;
+    int num_clips;
+    struct mixer_voice voices[MIXER_VOICES];
+
+    struct mixer_trigger queue[MIXER_QUEUE];
+    atomic_uint queue_head;         /**< Written by the trigger thread */
+    atomic_uint queue_tail;         /**< Written by the decoder thread */
+
+    atomic_int playing;             /**< Voices still playing after the last block */
+    long long mix_ns;               /**< Time spent mixing blocks with voices */
+    uint64_t voice_samples;         /**< Samples mixed, summed over voices */
+    uint64_t frames;                /**< Output samples produced */
+    long triggers;                  /**< Voices started */
+    long stolen;                    /**< Voices taken over while still playing */
+    int peak_voices;
+};
+
+/**
+ * @brief Loads a WAV file as a clip
+ *
+ * @param c Filled in on success
+ * @param path The file
+ * @return 0 on success, -1 on error (errno set)
+ */
+int mixer_clip_load(struct mixer_clip *c, const char *path);
+
+/**
+ * @brief Frees a clip's samples
+ */
+void mixer_clip_free(struct mixer_clip *c);
+
+/**
+ * @brief Sets up a mixer over a set of clips (all at the same rate)
+ *
+ * @param m The mixer
+ * @param clips The clips; must outlive the mixer
+ * @param num_clips How many
+ */
+void mixer_init(struct mixer *m, const struct mixer_clip *clips, int num_clips);
+
+/**
+ * @brief Queues a clip to start at the next block
+ *
+ * Call from one thread only (the one handling input).
+ *
+ * @param m The mixer
+ * @param clip Clip index, or -1 to stop every voice
+ * @param gain Q15 gain, 0 to MIXER_GAIN_UNITY
+ * @return 0 on success, -1 if the queue is full
+ */
+int mixer_trigger(struct mixer *m, int clip, int16_t gain);
+
+/**
+ * @brief Returns non-zero when no trigger is pending and no voice plays
+ *
+ * Blocks already in the audio pipe may still be playing.
+ */
+int mixer_idle(struct mixer *m);
+
+/**
+ * @brief Mixes the active voices into a block
+ *
+ * @param m The mixer
+ * @param out Receives count samples
+ * @param count Samples wanted
+ */
+void mixer_mix(struct mixer *m, int16_t *out, size_t count);
+
+/**
+ * @brief audio_pipe decoder callback: applies triggers and mixes a block
+ *
+ * Never ends the stream; silence is mixed while no voice plays.
+ *
+ * @param arg The mixer
+ */
+size_t mixer_decode(void *arg, size_t frame, int16_t *out, size_t count);
+
+/**
+ * @brief acc[i] = saturate(acc[i] + src[i] * gain), vectorized
+ */
+void mixer_add(int16_t *acc, const int16_t *src, size_t n, int16_t gain);
+
+/**
+ * @brief Scalar reference for mixer_add()
+ */
+void mixer_add_scalar(int16_t *acc, const int16_t *src, size_t n, int16_t gain);
+
+/**
+ * @brief Returns "neon", "sse2" or "scalar"
+ */
+const char *mixer_simd_name(void);
+
+#endif // MIXER_API_H
@@ -0,0 +1,291 @@
+#ifndef PINMAP_API_H
+#define PINMAP_API_H
+
+/**
+ * @file pinmap_api.h
+ * @brief Declarative GPIO pin map with grouped bulk requests
+ *
+ * A program describes its pins once in a table of struct pin_desc.
+ * pinmap_open() sorts them into groups of identical configuration (mode,
+ * bias and debounce) and requests each group with a single call, instead of
+ * one gpiod_chip_get_line() plus one gpiod_line_request_*() per pin.
+ *
+ * Pins are then looked up by name into typed handles: struct pin_out can
+ * only be written, struct pin_in only read, and struct pin_edge waited on
+ * for edge events. A handle to the wrong kind of pin is refused at lookup.
+ *
+ * Outputs in one group share one kernel request. With libgpiod v1, setting
+ * a single line of a bulk request writes every line of that request, so
+ * each group keeps a shadow of its output levels and always writes the
+ * whole group from it. This also lets a caller change several pins of a
+ * group with one ioctl: pin_stage() them, then pin_commit().
+ *
+ * Two backends implement this API, chosen at build time: libgpiod v1 (the
+ * default) and libgpiod v2, selected with -DUSE_LIBGPIOD_V2=ON, which
+ * defines PINMAP_GPIOD_V2. With v2 each group is one gpiod_line_request,
+ * edge events are read in batches through a gpiod_edge_event_buffer, and
+ * a pin's debounce_us is handed to the kernel (GPIO_V2_LINE_FLAG debounce),
+ * so bounces never wake the program. v1 has no debounce and ignores it.
+ *
+ * Each edge pin is requested on its own, with its own event fd, so waiting
+ * on or polling one pin only ever sees that pin's events.
+ *
+ * Example:
+ *
+ *   static const struct pin_desc PINS[] = {
+ *       { "led", 21, PIN_OUTPUT, 0, 1, 0 },
+ *       { "btn", 20, PIN_EDGE_BOTH, PIN_PULL_UP, 0, 10000 },
+ *   };
+ *   struct pinmap pm;
+ *   pinmap_open(&pm, "/dev/gpiochip4", "demo", PINS, 2);
+ */
+
+#include <gpiod.h>
+#include <stdint.h>
+#include <time.h>
+
+#define PINMAP_MAX_PINS 32
+#define PINMAP_MAX_GROUPS 16
+#define PINMAP_EVENT_BUFFER 64      // Edge events per read (v2 buffer size)
+
+/**
+ * @brief How a pin is requested
+ */
+enum pin_mode {
+    PIN_OUTPUT,         /**< Output, written through struct pin_out */
+    PIN_INPUT,          /**< Input, read through struct pin_in */
+    PIN_EDGE_RISING,    /**< Input with rising-edge events (struct pin_edge) */
+    PIN_EDGE_FALLING,   /**< Input with falling-edge events (struct pin_edge) */
+    PIN_EDGE_BOTH,      /**< Input with both-edge events (struct pin_edge) */
+};
+
+/** Bias flags for struct pin_desc (inputs only) */
+#define PIN_PULL_UP   (1 << 0)
+#define PIN_PULL_DOWN (1 << 1)
+
+/**
+ * @brief One entry of a program's pin table
+ */
+struct pin_desc {
+    const char *name;       /**< Lookup name, unique in the table */
+    unsigned int offset;    /**< Line offset on the chip */
+    enum pin_mode mode;     /**< Direction and edge detection */
+    int flags;              /**< PIN_PULL_UP / PIN_PULL_DOWN, or 0 */
+    int initial;            /**< Initial level of an output */
+    unsigned int debounce_us;   /**< Kernel debounce of an input (v2 only) */
+};
+
+/**
+ * @brief Edge event types
+ */
+enum pin_event_type {
+    PIN_EVENT_RISING = 1,
+    PIN_EVENT_FALLING = 2,
+};
+
+/**
+ * @brief One edge event, the same for both backends
+ */
+struct pin_event {
+    uint64_t ts_ns;             /**< Kernel timestamp, CLOCK_MONOTONIC */
+    enum pin_event_type type;   /**< Rising or falling */
+};
+
+/**
+ * @brief Pins requested together with one bulk call
+ */
+struct pin_group {
+#ifdef PINMAP_GPIOD_V2
+    struct gpiod_line_request *request;         /**< The group's lines */
+    struct gpiod_edge_event_buffer *events;     /**< Edge pins only */
+    unsigned int offsets[PINMAP_MAX_PINS];      /**< Offsets in group order */
+    unsigned int num_lines;
+#else
+    struct gpiod_line_bulk bulk;        /**< The group's lines */
+#endif
+    enum pin_mode mode;                 /**< Shared mode */
+    int flags;                          /**< Shared bias flags */
+    unsigned int debounce_us;           /**< Shared debounce period */
+    int values[PINMAP_MAX_PINS];        /**< Output shadow / last input read */
+    int dirty;                          /**< Shadow differs from the lines */
+    unsigned long writes;               /**< Bulk writes issued (pin_commit) */
+};
+
+/**
+ * @brief A program's requested pins
+ */
+struct pinmap {
+    struct gpiod_chip *chip;
+    const struct pin_desc *pins;
+    unsigned int num_pins;
+    unsigned int num_groups;
+    unsigned char group_of[PINMAP_MAX_PINS];    /**< Pin -> group */
+    unsigned char index_of[PINMAP_MAX_PINS];    /**< Pin -> index in group */
+    struct pin_group groups[PINMAP_MAX_GROUPS];
+};
+
+/** Handle to an output pin */
+struct pin_out {
+    struct pin_group *group;
+    unsigned int index;
+};
+
+/** Handle to a plain input pin */
+struct pin_in {
+    struct pin_group *group;
+    unsigned int index;
+};
+
+/** Handle to an input pin with edge events */
+struct pin_edge {
+    struct pin_group *group;
+};
+
+/**
+ * @brief Opens the chip and requests every pin of the table
+ *
+ * Pins with the same mode, flags and debounce form one group, requested
+ * with one call (gpiod_line_request_bulk() with v1,
+ * gpiod_chip_request_lines() with v2); every edge pin is a group of its
+ * own. Outputs start at their initial level.
+ *
+ * @param pm The pin map to fill
+ * @param chip_path GPIO chip device (e.g. /dev/gpiochip4)
+ * @param consumer Consumer label shown by gpioinfo
+ * @param pins The pin table; must outlive the pin map
+ * @param num_pins Number of entries (at most PINMAP_MAX_PINS)
+ * @return 0 on success, -1 on error (errno is set, nothing stays requested)
+ */
+int pinmap_open(struct pinmap *pm, const char *chip_path, const char *consumer,
+                const struct pin_desc *pins, unsigned int num_pins);
+
+/**
+ * @brief Returns the backend the helpers were built with
+ *
+ * @return "libgpiod v1" or "libgpiod v2"
+ */
+const char *pinmap_backend(void);
+
+/**
+ * @brief Releases every pin and closes the chip
+ *
+ * @param pm The pin map
+ */
+void pinmap_close(struct pinmap *pm);
+
+/**
+ * @brief Looks up an output pin by name
+ *
+ * @param pm The pin map
+ * @param name Name from the pin table
+ * @param out Receives the handle
+ * @return 0 on success, -1 if there is no such output (errno = ENOENT)
+ */
+int pinmap_out(struct pinmap *pm, const char *name, struct pin_out *out);
+
+/**
+ * @brief Looks up a plain input pin by name
+ *
+ * @param pm The pin map
+ * @param name Name from the pin table
+ * @param in Receives the handle
+ * @return 0 on success, -1 if there is no such input (errno = ENOENT)
+ */
+int pinmap_in(struct pinmap *pm, const char *name, struct pin_in *in);
+
+/**
+ * @brief Looks up an edge-event pin by name
+ *
+ * @param pm The pin map
+ * @param name Name from the pin table
+ * @param edge Receives the handle
+ * @return 0 on success, -1 if there is no such edge pin (errno = ENOENT)
+ */
+int pinmap_edge(struct pinmap *pm, const char *name, struct pin_edge *edge);
+
+/**
+ * @brief Sets an output's level in its group's shadow only
+ *
+ * Nothing reaches the pin until pin_commit() on any pin of the group.
+ *
+ * @param p The output
+ * @param value 0 or 1
+ */
+void pin_stage(struct pin_out p, int value);
+
+/**
+ * @brief Writes the shadow of the pin's whole group, if it changed
+ *
+ * @param p Any output of the group
+ * @return 0 on success, -1 on error
+ */
+int pin_commit(struct pin_out p);
+
+/**
+ * @brief Sets one output (pin_stage() followed by pin_commit())
+ *
+ * No ioctl is issued if the level is unchanged.
+ *
+ * @param p The output
+ * @param value 0 or 1
+ * @return 0 on success, -1 on error
+ */
+int pin_write(struct pin_out p, int value);
+
+/**
+ * @brief Reads an input
+ *
+ * Reads the whole group in one ioctl and keeps the other levels in the
+ * group's values[] for callers that scan several pins.
+ *
+ * @param p The input
+ * @return 0 or 1, or -1 on error
+ */
+int pin_read(struct pin_in p);
+
+/**
+ * @brief Reads the current level of an edge pin
+ *
+ * @param p The edge pin
+ * @return 0 or 1, or -1 on error
+ */
+int pin_edge_value(struct pin_edge p);
+
+/**
+ * @brief Returns the line offset of an edge pin
+ *
+ * @param p The edge pin
+ * @return The offset on the chip
+ */
+unsigned int pin_edge_offset(struct pin_edge p);
+
+/**
+ * @brief Returns the pin's event file descriptor, for poll()
+ *
+ * @param p The edge pin
+ * @return The file descriptor
+ */
+int pin_edge_fd(struct pin_edge p);
+
+/**
+ * @brief Waits for edge events on one pin
+ *
+ * @param p The edge pin
+ * @param timeout Maximum time to wait
+ * @return 1 if events are pending, 0 on timeout, -1 on error
+ */
+int pin_edge_wait(struct pin_edge p, const struct timespec *timeout);
+
+/**
+ * @brief Reads up to max pending edge events in one read
+ *
+ * Reads at most PINMAP_EVENT_BUFFER events per call.
+ *
+ * @param p The edge pin
+ * @param evs Buffer for the events
+ * @param max Size of the buffer
+ * @return Number of events read, or -1 on error
+ */
+int pin_edge_read(struct pin_edge p, struct pin_event *evs, unsigned int max);
+
+#endif // PINMAP_API_H
@@ -0,0 +1,87 @@
+#ifndef PWM_AUDIO_API_H
+#define PWM_AUDIO_API_H
+
+/**
+ * @file pwm_audio_api.h
+ * @brief Audio output through a hardware PWM channel (sysfs)
+ *
+ * Instead of bit-banging one GPIO, each sample sets the duty cycle of a
+ * hardware PWM carrier well above the audio band (PWM_AUDIO_CARRIER_HZ by
+ * default). The speaker and any RC filter average the carrier, so the
+ * output has as many levels as the carrier period has nanosecond steps the
+ * PWM block can resolve, rather than two.
+ *
+ * The duty_cycle file stays open for the whole playback and each sample is
+ * one pwrite() at offset 0 of a preformatted decimal string; no open(),
+ * lseek() or stdio per sample, and no write at all when the duty did not
+ * change.
+ *
+ * Hardware setup, as for lab5's pwm_signal:
+ *   dtoverlay=pwm,pin=18,func=2 in /boot/firmware/config.txt (PWM0, GPIO 18)
+ *
+ * The chip directory is a parameter, so the sink can be run without the
+ * hardware against a fake tree of regular files:
+ *   mkdir -p /tmp/pwm/pwmchip0/pwm0
+ *   touch /tmp/pwm/pwmchip0/export /tmp/pwm/pwmchip0/unexport
+ *   touch /tmp/pwm/pwmchip0/pwm0/{enable,period,duty_cycle}
+ * Regular files are truncated after each write so they read back as the
+ * last value written, the way the sysfs attributes do.
+ */
+
+#include <stdint.h>
+
+#define PWM_AUDIO_CHIP "/sys/class/pwm/pwmchip0"
+#define PWM_AUDIO_CARRIER_HZ 100000     // 10 us period = 10000 ns, i.e. 10000 1-ns duty steps
+#define PWM_AUDIO_EXPORT_WAIT_MS 1000   // Time allowed for udev after export
+
+/**
+ * @brief An open PWM audio channel
+ */
+struct pwm_audio {
+    char chan_dir[96];          /**< e.g. /sys/class/pwm/pwmchip0/pwm0 */
+    char chip_dir[80];
+    int channel;
+    int exported;               /**< We exported the channel, so unexport it */
+    int duty_fd;                /**< duty_cycle, open for the whole playback */
+    int regular;                /**< duty_cycle is a regular file (fake tree) */
+    long period_ns;             /**< Carrier period */
+    long duty_ns;               /**< Last duty written */
+    long writes;                /**< Duty updates written */
+    long skipped;               /**< Samples whose duty did not change */
+    long errors;                /**< Failed writes */
+};
+
+/**
+ * @brief Exports and configures a PWM channel for audio
+ *
+ * Exports the channel if needed, sets the carrier period, starts at 50%
+ * duty (silence) and enables the output.
+ *
+ * @param p Filled in on success
+ * @param chip_dir PWM chip directory (PWM_AUDIO_CHIP, or a fake tree)
+ * @param channel Channel number on the chip
+ * @param carrier_hz Carrier frequency
+ * @return 0 on success, -1 on error (errno set)
+ */
+int pwm_audio_open(struct pwm_audio *p, const char *chip_dir, int channel, long carrier_hz);
+
+/**
+ * @brief Outputs one sample as a duty cycle
+ *
+ * Q15 full scale maps to 0..period, so 0 is 50% duty. Safe to call from
+ * the sample task: no allocation, no stdio, one pwrite() at most.
+ *
+ * @param p The channel
+ * @param sample Signed 16-bit sample
+ * @return 0 on success, -1 if the write failed
+ */
+int pwm_audio_write(struct pwm_audio *p, int16_t sample);
+
+/**
+ * @brief Disables the output and unexports the channel if we exported it
+ *
+ * @param p The channel
+ */
+void pwm_audio_close(struct pwm_audio *p);
+
+#endif // PWM_AUDIO_API_H
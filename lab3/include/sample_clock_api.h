@@ -0,0 +1,125 @@
+#ifndef SAMPLE_CLOCK_API_H
+#define SAMPLE_CLOCK_API_H
+
+/**
+ * @file sample_clock_api.h
+ * @brief Drift-free sample clock for audio and tone output
+ *
+ * periodic_api.h takes a period in whole nanoseconds. For 44.1 kHz that
+ * is 22675 ns instead of 22675.74, so the output runs 33 ppm fast (about
+ * 0.1 s an hour); a late tick is simply skipped, and the sample it should
+ * have played is played one period later instead, so after every stall
+ * the audio is behind the clock for good.
+ *
+ * The sample clock runs at a rate in Hz. Each deadline is the previous one
+ * plus 1e9 / rate_hz ns, as whole nanoseconds plus a remainder kept in
+ * units of 1 / rate_hz ns. Tick k is due exactly at start + k / rate_hz
+ * (rounded down to the nanosecond) however long the clock runs, and
+ * sleeps use clock_nanosleep(TIMER_ABSTIME) on CLOCK_MONOTONIC.
+ *
+ * When the callback falls behind:
+ *   - up to max_catchup deadlines behind, the ticks run back to back
+ *     until the clock is on time again (catch-up, nothing is lost)
+ *   - further behind, the passed deadlines are skipped, and the next
+ *     callback is told how many ticks it missed so it can drop as many
+ *     samples (or advance its phase) and stay in step with the clock
+ * Either way tick k + skipped ticks is always the sample due now, so
+ * playback position never drifts from CLOCK_MONOTONIC.
+ *
+ * Like periodic_api.h, the runner thread inherits the caller's scheduling
+ * (call rt_apply() first) and blocks all signals.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "rt_api.h"
+#include "telemetry_api.h"
+
+#define SAMPLE_CLOCK_CATCHUP 16     // Default: ticks run back to back before skipping
+
+/**
+ * @brief Sample callback
+ *
+ * @param arg The pointer passed to sample_clock_start()
+ * @param skipped Ticks skipped since the previous call (usually 0)
+ * @return 0 to keep running, non-zero to stop the clock
+ */
+typedef int (*sample_clock_fn)(void *arg, unsigned skipped);
+
+/**
+ * @brief State of one sample clock
+ */
+struct sample_clock {
+    pthread_t thread;
+    uint32_t rate_hz;           /**< Ticks per second */
+    long long period_ns;        /**< Whole nanoseconds of the period */
+    uint32_t period_rem;        /**< Rest of the period, in 1 / rate_hz ns */
+    unsigned max_catchup;       /**< Deadlines behind before skipping */
+    sample_clock_fn fn;
+    void *arg;
+    struct rt_jitter *jitter;   /**< Optional lateness statistics, or NULL */
+    struct telemetry_task *telemetry; /**< Optional live telemetry, or NULL */
+    atomic_int stop;
+    atomic_int finished;
+    long long start_ns;         /**< Tick 0 of the schedule (one period before the first) */
+    atomic_llong ticks;         /**< Callbacks run */
+    atomic_llong caught_up;     /**< Ticks run back to back, already late */
+    atomic_llong skipped;       /**< Ticks skipped */
+    atomic_llong late_ns;       /**< Lateness of the latest tick */
+    atomic_llong late_max_ns;   /**< Worst lateness */
+    atomic_llong last_ns;       /**< Wake-up time of the latest tick */
+};
+
+/**
+ * @brief Starts a sample clock
+ *
+ * The first tick is one period after the call.
+ *
+ * @param c Clock state (owned by the caller, must outlive the clock)
+ * @param rate_hz Tick rate
+ * @param max_catchup Deadlines the clock may fall behind and still run
+ *        every tick (SAMPLE_CLOCK_CATCHUP; 0 skips as soon as a deadline
+ *        is missed)
+ * @param fn Callback run once per tick
+ * @param arg Passed to fn
+ * @param jitter If not NULL, reset and updated with each tick's lateness
+ * @param telemetry If not NULL, updated for telemetry_top
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int sample_clock_start(struct sample_clock *c, uint32_t rate_hz, unsigned max_catchup,
+                       sample_clock_fn fn, void *arg, struct rt_jitter *jitter,
+                       struct telemetry_task *telemetry);
+
+/**
+ * @brief Asks the clock to stop and waits for the runner to exit
+ *
+ * Call either this or sample_clock_join() once, not both.
+ */
+void sample_clock_stop(struct sample_clock *c);
+
+/**
+ * @brief Waits until the callback stops the clock by returning non-zero
+ */
+void sample_clock_join(struct sample_clock *c);
+
+/**
+ * @brief Returns non-zero once the runner has exited
+ */
+int sample_clock_finished(struct sample_clock *c);
+
+/**
+ * @brief Prints ticks run, caught up and skipped, and the clock's drift
+ *
+ * Drift is the latest tick's lateness against the exact schedule, and
+ * the playback position (ticks run plus skipped) against the time
+ * elapsed. For comparison it also prints how far a whole-nanosecond period
+ * would have drifted over the same run.
+ *
+ * @param c A stopped clock
+ * @param label Name of the activity
+ */
+void sample_clock_report(const struct sample_clock *c, const char *label);
+
+#endif // SAMPLE_CLOCK_API_H
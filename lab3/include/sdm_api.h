@@ -0,0 +1,92 @@
+#ifndef SDM_API_H
+#define SDM_API_H
+
+/**
+ * @file sdm_api.h
+ * @brief Sigma-delta (PDM) modulation of audio onto one GPIO pin
+ *
+ * A pin can only be high or low. Outputting `sample > 0` (SDM_CLIP) turns
+ * every waveform into a square wave. A sigma-delta modulator instead runs
+ * at a multiple of the sample rate (the oversampling ratio) and picks each
+ * output bit so that the running error between the input and the bits fed
+ * back stays small: the density of ones follows the signal, and the
+ * quantization noise is pushed up in frequency where the speaker and an RC
+ * filter on the pin remove it.
+ *
+ *   SDM_CLIP     the original 1-bit clipper
+ *   SDM_ORDER1   one integrator: noise rises 20 dB/decade
+ *   SDM_ORDER2   two integrators: 40 dB/decade, much less in-band noise
+ *                at the same oversampling ratio
+ *
+ * Everything is integer arithmetic on Q15 samples (int16_t full scale), so
+ * sdm_step() costs a few adds per output bit in the sample task.
+ * Integrators are clamped at SDM_LIMIT so an overloaded second-order loop
+ * recovers instead of oscillating.
+ */
+
+#include <stdint.h>
+
+#define SDM_FULL_SCALE 32768        // Feedback level of an output bit (Q15 +/-1.0)
+#define SDM_LIMIT (1L << 22)        // Integrator clamp
+
+enum sdm_order {
+    SDM_CLIP = 0,
+    SDM_ORDER1 = 1,
+    SDM_ORDER2 = 2,
+};
+
+/**
+ * @brief Modulator state
+ */
+struct sdm {
+    enum sdm_order order;
+    int32_t acc1;       /**< First integrator */
+    int32_t acc2;       /**< Second integrator */
+    int out;            /**< Last output bit */
+};
+
+/**
+ * @brief Resets a modulator
+ *
+ * @param m The modulator
+ * @param order SDM_CLIP, SDM_ORDER1 or SDM_ORDER2
+ */
+void sdm_init(struct sdm *m, enum sdm_order order);
+
+/**
+ * @brief Returns a short name for an order ("clip", "1st", "2nd")
+ */
+const char *sdm_name(enum sdm_order order);
+
+static inline int32_t sdm_clamp(int32_t v) {
+    return v > SDM_LIMIT ? SDM_LIMIT : v < -SDM_LIMIT ? -SDM_LIMIT : v;
+}
+
+/**
+ * @brief Produces the next output bit
+ *
+ * @param m The modulator
+ * @param x Input sample, Q15
+ * @return 0 or 1
+ */
+static inline int sdm_step(struct sdm *m, int32_t x) {
+    int32_t fb = m->out ? SDM_FULL_SCALE : -SDM_FULL_SCALE;
+
+    switch (m->order) {
+    case SDM_ORDER1:
+        m->acc1 = sdm_clamp(m->acc1 + x - fb);
+        m->out = m->acc1 >= 0;
+        break;
+    case SDM_ORDER2:
+        m->acc1 = sdm_clamp(m->acc1 + x - fb);
+        m->acc2 = sdm_clamp(m->acc2 + m->acc1 - fb);
+        m->out = m->acc2 >= 0;
+        break;
+    default:
+        m->out = x > 0;
+        break;
+    }
+    return m->out;
+}
+
+#endif // SDM_API_H
@@ -0,0 +1,136 @@
+#ifndef SOFTPWM_API_H
+#define SOFTPWM_API_H
+
+/**
+ * @file softpwm_api.h
+ * @brief Multi-channel software PWM on one timer thread
+ *
+ * Each channel is an output pin with its own frequency and duty cycle.
+ * Instead of one periodic task per channel, a single thread keeps every
+ * channel's next edge in a min-heap ordered by time and sleeps with
+ * clock_nanosleep(TIMER_ABSTIME) until the earliest one.
+ *
+ * On each wake-up, every edge due within SOFTPWM_COALESCE_NS is staged
+ * into its pin map group and each touched group is committed once, so
+ * edges that coincide (harmonics, equal frequencies, a shared period
+ * start) cost one bulk GPIO write instead of one write per pin. Put all
+ * PWM pins in one output group (same flags in the pin table) to get this.
+ *
+ * Edge times are absolute, so a late edge does not drift the ones after
+ * it. If an edge is late by a whole period or more, the missed periods are
+ * skipped and counted as overruns. A duty of 0 or 1 holds the pin low or
+ * high and costs no wake-ups beyond one per period.
+ *
+ * Each channel records when its edges were actually written, so
+ * softpwm_report() can print achieved against requested frequency and
+ * duty together with the edge lateness.
+ *
+ * Like periodic_api, the thread inherits the caller's scheduling policy,
+ * priority and CPU affinity (call rt_apply() first for real-time mode) and
+ * blocks all signals.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "pinmap_api.h"
+
+#define SOFTPWM_MAX_CHANNELS 16
+#define SOFTPWM_COALESCE_NS 2000    // Edges this close are written together
+
+/**
+ * @brief One PWM output
+ */
+struct softpwm_channel {
+    struct pin_out pin;         /**< Output driven by this channel */
+    long long period_ns;        /**< Requested period */
+    long long high_ns;          /**< Requested high time per period */
+    int changed;                /**< Request not applied yet */
+    long long cur_period_ns;    /**< Period in effect */
+    long long cur_high_ns;      /**< High time in effect */
+    long long start_ns;         /**< Ideal start of the current period */
+    long long next_ns;          /**< Ideal time of the next edge */
+    int rising;                 /**< Next edge starts a period */
+
+    long edges;                 /**< Edges written */
+    long overruns;              /**< Periods skipped because they had passed */
+    long long late_sum_ns;      /**< Sum of edge lateness */
+    long long late_max_ns;      /**< Largest edge lateness */
+    long rises;                 /**< Rising edges written */
+    long long first_rise_ns;    /**< Actual time of the first rising edge */
+    long long last_rise_ns;     /**< Actual time of the latest rising edge */
+    long pulses;                /**< Complete high pulses */
+    long long high_sum_ns;      /**< Sum of actual high times */
+    long long rise_ns;          /**< Actual time of the pulse in progress */
+};
+
+/**
+ * @brief A set of PWM channels and the thread that drives them
+ */
+struct softpwm {
+    struct softpwm_channel ch[SOFTPWM_MAX_CHANNELS];
+    unsigned int num_channels;
+    unsigned char heap[SOFTPWM_MAX_CHANNELS];   /**< Channels by next_ns */
+    pthread_mutex_t lock;       /**< Guards ch[] against softpwm_set() */
+    pthread_t thread;           /**< Runner thread */
+    atomic_int stop;            /**< Set to end the runner */
+    long wakeups;               /**< Times the runner woke up */
+    long writes;                /**< Group writes issued */
+};
+
+/**
+ * @brief Prepares an engine with no channels
+ *
+ * @param pwm The engine
+ */
+void softpwm_init(struct softpwm *pwm);
+
+/**
+ * @brief Adds a channel; call before softpwm_start()
+ *
+ * @param pwm The engine
+ * @param pin Output to drive
+ * @param freq_hz Frequency in Hz (> 0)
+ * @param duty High fraction of the period, clamped to [0, 1]
+ * @return The channel number, or -1 on error (errno set)
+ */
+int softpwm_add(struct softpwm *pwm, struct pin_out pin, double freq_hz, double duty);
+
+/**
+ * @brief Changes a channel's frequency and duty while running
+ *
+ * Takes effect from the channel's next period; the current one completes
+ * with the old settings, so the output never glitches. The channel's
+ * statistics restart when the new settings take effect.
+ *
+ * @param pwm The engine
+ * @param channel Channel number from softpwm_add()
+ * @param freq_hz Frequency in Hz (> 0)
+ * @param duty High fraction of the period, clamped to [0, 1]
+ * @return 0 on success, -1 on error (errno set)
+ */
+int softpwm_set(struct softpwm *pwm, int channel, double freq_hz, double duty);
+
+/**
+ * @brief Starts the runner thread; every channel starts its first period now
+ *
+ * @param pwm The engine
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int softpwm_start(struct softpwm *pwm);
+
+/**
+ * @brief Stops the runner and drives every channel low
+ *
+ * @param pwm The engine
+ */
+void softpwm_stop(struct softpwm *pwm);
+
+/**
+ * @brief Prints requested vs achieved frequency and duty per channel
+ *
+ * @param pwm The engine
+ */
+void softpwm_report(struct softpwm *pwm);
+
+#endif // SOFTPWM_API_H
@@ -0,0 +1,171 @@
+#ifndef TRACE_API_H
+#define TRACE_API_H
+
+/**
+ * @file trace_api.h
+ * @brief Low-overhead binary event tracer (flight recorder)
+ *
+ * Each thread writes fixed-size records into its own ring buffer; the
+ * oldest records are overwritten when the ring is full, so the buffer
+ * always holds the most recent TRACE_RING_SIZE events per thread. Emitting
+ * a record is one CLOCK_MONOTONIC read (vDSO, no syscall) plus a 16-byte
+ * store, and just a branch when tracing is off.
+ *
+ * Tracing is off unless the TRACE_FILE environment variable is set when
+ * the program starts:
+ *
+ *   TRACE_FILE=/tmp/scroll.trace sudo -E ./scroll_base_interrupt
+ *
+ * The rings are written to TRACE_FILE at exit, on SIGUSR1 (without
+ * stopping the program) and on SIGINT/SIGTERM if the program does not
+ * handle those itself. Convert the dump for chrome://tracing or
+ * ui.perfetto.dev with:
+ *
+ *   ./trace2json /tmp/scroll.trace > scroll.json
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+#define TRACE_MAGIC 0x4352544cu       // "LTRC"
+#define TRACE_VERSION 1
+#define TRACE_RING_SIZE 16384         // Records per thread, power of two
+#define TRACE_RING_MASK (TRACE_RING_SIZE - 1)
+#define TRACE_NAME_LEN 16
+
+/**
+ * @brief Traced activities (the id field of a record)
+ */
+enum trace_id {
+    TRACE_LCD_CMD = 1,      /**< lcd_cmd(), arg = command byte */
+    TRACE_LCD_CHAR,         /**< lcd_char(), arg = character */
+    TRACE_KEYP_SCAN,        /**< keyp_scan(), end arg = key or 0 */
+    TRACE_EVENT_READ,       /**< GPIO edge event read, end arg = events */
+    TRACE_ENCODER_READ,     /**< encoder_read(), end arg = events */
+    TRACE_TIMER_TICK,       /**< Periodic task callback */
+    TRACE_MARK,             /**< Free-form instant, arg chosen by caller */
+    TRACE_NUM_IDS
+};
+
+/**
+ * @brief Record phases (Chrome trace event "ph" values)
+ */
+enum trace_phase {
+    TRACE_PH_BEGIN = 'B',
+    TRACE_PH_END = 'E',
+    TRACE_PH_INSTANT = 'i',
+};
+
+/**
+ * @brief One trace record (16 bytes)
+ */
+struct trace_record {
+    uint64_t ts_ns;         /**< CLOCK_MONOTONIC timestamp */
+    uint16_t id;            /**< enum trace_id */
+    uint8_t phase;          /**< enum trace_phase */
+    uint8_t reserved;
+    uint32_t arg;           /**< Event-specific argument */
+};
+
+/**
+ * @brief One thread's ring buffer
+ */
+struct trace_ring {
+    uint64_t head;                      /**< Records ever written */
+    uint32_t tid;                       /**< Kernel thread id */
+    char name[TRACE_NAME_LEN];          /**< Thread name at attach time */
+    struct trace_ring *next;            /**< Registry link */
+    struct trace_record buf[TRACE_RING_SIZE];
+};
+
+/**
+ * @brief Dump file header
+ *
+ * Followed by num_rings blocks, each a struct trace_dump_ring and then
+ * its count records, oldest first.
+ */
+struct trace_dump_header {
+    uint32_t magic;         /**< TRACE_MAGIC */
+    uint32_t version;       /**< TRACE_VERSION */
+    uint32_t pid;           /**< Traced process */
+    uint32_t num_rings;     /**< Ring blocks that follow */
+};
+
+/**
+ * @brief Per-ring block header in a dump
+ */
+struct trace_dump_ring {
+    uint32_t tid;                   /**< Kernel thread id */
+    char name[TRACE_NAME_LEN];      /**< Thread name */
+    uint32_t count;                 /**< Records that follow */
+    uint64_t dropped;               /**< Older records overwritten */
+};
+
+/** Non-zero while tracing is enabled (set from TRACE_FILE at startup). */
+extern int trace_on;
+
+/** The calling thread's ring, attached on its first record. */
+extern __thread struct trace_ring *trace_self;
+
+/**
+ * @brief Registers the calling thread's ring
+ *
+ * Called automatically on a thread's first record.
+ *
+ * @return The ring, or NULL if it could not be allocated
+ */
+struct trace_ring *trace_attach(void);
+
+/**
+ * @brief Writes every thread's ring to TRACE_FILE
+ *
+ * Async-signal-safe (only open/write/close).
+ *
+ * @return 0 on success, -1 on failure
+ */
+int trace_dump(void);
+
+/**
+ * @brief Returns the display name of a trace id
+ *
+ * @param id An enum trace_id value
+ * @return Name, or "unknown"
+ */
+const char *trace_id_name(unsigned int id);
+
+/**
+ * @brief Appends one record to the calling thread's ring
+ *
+ * @param id enum trace_id
+ * @param phase enum trace_phase
+ * @param arg Event-specific argument
+ */
+static inline void trace_emit(unsigned int id, unsigned int phase, uint32_t arg) {
+    struct trace_ring *ring = trace_self;
+    if (!ring && !(ring = trace_attach())) {
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    uint64_t head = ring->head;
+    struct trace_record *r = &ring->buf[head & TRACE_RING_MASK];
+    r->ts_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    r->id = (uint16_t)id;
+    r->phase = (uint8_t)phase;
+    r->reserved = 0;
+    r->arg = arg;
+
+    // Publish after the record is complete, for a dump from another thread
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+#define TRACE_BEGIN(id, arg) \
+    do { if (trace_on) trace_emit((id), TRACE_PH_BEGIN, (uint32_t)(arg)); } while (0)
+#define TRACE_END(id, arg) \
+    do { if (trace_on) trace_emit((id), TRACE_PH_END, (uint32_t)(arg)); } while (0)
+#define TRACE_INSTANT(id, arg) \
+    do { if (trace_on) trace_emit((id), TRACE_PH_INSTANT, (uint32_t)(arg)); } while (0)
+
+#endif // TRACE_API_H
@@ -0,0 +1,169 @@
+#ifndef WAV_API_H
+#define WAV_API_H
+
+/**
+ * @file wav_api.h
+ * @brief WAV file access for the audio programs
+ *
+ * Two ways to get at a WAV file's samples:
+ *
+ *   wav_open()  mmap()s the file with MADV_SEQUENTIAL and returns as soon
+ *               as the header is parsed. Pages are read in by the kernel
+ *               as playback reaches them, so the first sample can go out
+ *               right away and memory use does not grow with the file.
+ *               wav_stream(), called from a non-real-time thread, keeps a
+ *               window ahead of the play position mapped (so the sample
+ *               task does not fault) and releases pages behind it.
+ *   wav_load()  Reads the whole file into memory before returning, as the
+ *               original loader did. Kept for comparison.
+ *
+ * The parser walks the RIFF chunks in any order, skips unknown ones
+ * (honouring the pad byte after odd-sized chunks) and accepts:
+ *
+ *   - WAVE_FORMAT_PCM: unsigned 8-bit, signed 16/24/32-bit
+ *   - WAVE_FORMAT_IEEE_FLOAT: 32/64-bit
+ *   - WAVE_FORMAT_EXTENSIBLE with a PCM or float sub-format, including
+ *     samples in a wider container (e.g. 24 valid bits in 32)
+ *   - WAVE_FORMAT_IMA_ADPCM (4-bit IMA/DVI, see adpcm_api.h)
+ *   - any number of channels
+ *
+ * A data chunk that runs past the end of the file is cut to what is there.
+ *
+ * wav_read() converts a run of frames to signed 16-bit mono, averaging the
+ * channels. Each format/channel-count pair has its own branch-free loop,
+ * so converting a block costs a few instructions per sample and the
+ * compiler can vectorize it; callers convert blocks, not single samples.
+ * ADPCM is decoded a whole block at a time into a small per-file buffer
+ * (one block, ~2 KiB at the default size), so reading it in runs costs
+ * the same per sample wherever the runs start. Only the encoded data is
+ * mapped or loaded, a quarter of the 16-bit size.
+ *
+ * In real-time mode mlockall() locks and reads in the whole mapping like
+ * any other memory, and wav_stream() cannot release it. Playback is then
+ * fault-free, at the cost of the streaming savings.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WAV_STREAM_AHEAD (256 * 1024)   // Bytes kept mapped ahead of the play position
+#define WAV_STREAM_BEHIND (64 * 1024)   // Bytes kept mapped behind it
+#define WAV_MAX_CHANNELS 32
+
+#define WAV_FORMAT_PCM 0x0001
+#define WAV_FORMAT_IEEE_FLOAT 0x0003
+#define WAV_FORMAT_IMA_ADPCM 0x0011
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+/**
+ * @brief Sample encodings wav_read() converts from
+ */
+enum wav_encoding {
+    WAV_U8,     /**< Unsigned 8-bit PCM */
+    WAV_S16,    /**< Signed 16-bit PCM */
+    WAV_S24,    /**< Signed 24-bit PCM, packed in 3 bytes */
+    WAV_S32,    /**< Signed 32-bit PCM (also 24 valid bits in 32) */
+    WAV_F32,    /**< 32-bit IEEE float, full scale +/-1.0 */
+    WAV_F64,    /**< 64-bit IEEE float, full scale +/-1.0 */
+    WAV_IMA_ADPCM, /**< 4-bit IMA ADPCM, in blocks of block_align bytes */
+};
+
+struct wav_block_cache;
+
+/**
+ * @brief An open WAV file
+ */
+struct wav {
+    uint16_t audio_format;      /**< WAV_FORMAT_PCM or _IEEE_FLOAT (sub-format resolved) */
+    uint16_t num_channels;
+    uint32_t sample_rate;       /**< Frames per second */
+    uint16_t bits_per_sample;   /**< Container size of one sample */
+    uint16_t valid_bits;        /**< Significant bits (extensible), else bits_per_sample */
+    uint16_t block_align;       /**< Bytes per frame (ADPCM: per block) */
+    uint32_t frames_per_block;  /**< Frames in block_align bytes: 1, except ADPCM */
+    enum wav_encoding encoding;
+    const uint8_t *data;        /**< First sample frame */
+    size_t data_size;           /**< Bytes of sample data */
+    size_t num_frames;          /**< Frames in data */
+
+    void *map;                  /**< The mapped file (wav_open), or NULL */
+    size_t map_size;
+    void *buffer;               /**< The loaded file (wav_load), or NULL */
+    size_t mapped_to;           /**< File offset prefaulted so far */
+    size_t released_to;         /**< File offset released so far */
+    struct wav_block_cache *cache; /**< ADPCM: the block decoded last */
+};
+
+/**
+ * @brief Parses a RIFF/WAVE file held in memory
+ *
+ * Fills in the format fields and points w->data into buf. Does not take
+ * ownership of buf (w->map and w->buffer stay NULL), but an ADPCM file
+ * gets a decode buffer, so pass w to wav_close() when done.
+ *
+ * @param w Filled in on success
+ * @param buf The file contents
+ * @param len Their length
+ * @return 0 on success, -1 if malformed or unsupported (errno = EINVAL)
+ */
+int wav_parse(struct wav *w, const void *buf, size_t len);
+
+/**
+ * @brief Maps a WAV file for streaming playback
+ *
+ * @param w Filled in on success
+ * @param path The file
+ * @return 0 on success, -1 on error (errno set; EINVAL for a malformed or
+ *         unsupported file)
+ */
+int wav_open(struct wav *w, const char *path);
+
+/**
+ * @brief Reads a whole WAV file into memory
+ *
+ * @param w Filled in on success
+ * @param path The file
+ * @return 0 on success, -1 on error (errno set)
+ */
+int wav_load(struct wav *w, const char *path);
+
+/**
+ * @brief Converts frames to signed 16-bit mono
+ *
+ * Not safe to call on the same file from two threads at once (the ADPCM
+ * block buffer is shared).
+ *
+ * @param w The file
+ * @param frame First frame to convert
+ * @param out Receives one sample per frame
+ * @param count Frames wanted
+ * @return Frames converted (fewer than count at the end of the data)
+ */
+size_t wav_read(const struct wav *w, size_t frame, int16_t *out, size_t count);
+
+/**
+ * @brief Returns a short description of the sample encoding ("s16", ...)
+ */
+const char *wav_encoding_name(enum wav_encoding encoding);
+
+/**
+ * @brief Moves the streaming window to the given play position
+ *
+ * Prefaults up to WAV_STREAM_AHEAD bytes past the position and drops the
+ * pages more than WAV_STREAM_BEHIND bytes before it. Does nothing for a
+ * file from wav_load(). Call it periodically from the main thread, never
+ * from the sample task.
+ *
+ * @param w The file
+ * @param frame Frame about to be played
+ */
+void wav_stream(struct wav *w, size_t frame);
+
+/**
+ * @brief Unmaps or frees the file
+ *
+ * @param w The file
+ */
+void wav_close(struct wav *w);
+
+#endif // WAV_API_H
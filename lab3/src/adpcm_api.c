@@ -0,0 +1,187 @@
+#include "adpcm_api.h"
+#include "wav_api.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+const int16_t adpcm_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+const int8_t adpcm_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+unsigned adpcm_encode_nibble(struct adpcm_state *s, int16_t sample) {
+    int32_t step = adpcm_step_table[s->index];
+    int32_t diff = sample - s->predictor;
+    unsigned nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    // Successive approximation of diff / step in 3 bits, as the reference
+    // encoder does; the decoder's reconstruction then keeps the two in step
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+    }
+    if (diff >= step >> 1) {
+        nibble |= 2;
+        diff -= step >> 1;
+    }
+    if (diff >= step >> 2) {
+        nibble |= 1;
+    }
+    adpcm_decode_nibble(s, nibble);
+    return nibble;
+}
+
+unsigned adpcm_samples_per_block(unsigned block_align, unsigned channels) {
+    if (channels == 0 || block_align <= 4 * channels || (block_align - 4 * channels) % (4 * channels)) {
+        return 0;
+    }
+    return (block_align - 4 * channels) * 2 / channels + 1;
+}
+
+size_t adpcm_block_frames(size_t bytes, unsigned channels) {
+    if (channels == 0 || bytes < 4 * (size_t)channels) {
+        return 0;
+    }
+    return (bytes - 4 * (size_t)channels) / (4 * (size_t)channels) * 8 + 1;
+}
+
+size_t adpcm_encode_block(struct adpcm_state *s, const int16_t *in, size_t count, uint8_t *out) {
+    if (count == 0) {
+        return 0;
+    }
+    s->predictor = in[0];
+    out[0] = (uint8_t)(in[0] & 0xFF);
+    out[1] = (uint8_t)((uint16_t)in[0] >> 8);
+    out[2] = (uint8_t)s->index;
+    out[3] = 0;
+
+    size_t groups = (count - 1 + 7) / 8;
+    uint8_t *p = out + 4;
+    for (size_t i = 1; i < 1 + groups * 8; i += 2) {
+        // Past the end, hold the last sample: the padding codes as silence
+        int16_t a = in[i < count ? i : count - 1];
+        int16_t b = in[i + 1 < count ? i + 1 : count - 1];
+        unsigned lo = adpcm_encode_nibble(s, a);
+        unsigned hi = adpcm_encode_nibble(s, b);
+        *p++ = (uint8_t)(lo | hi << 4);
+    }
+    return 4 + groups * 4;
+}
+
+size_t adpcm_decode_block(const uint8_t *block, size_t bytes, unsigned channels, int16_t *out) {
+    size_t frames = adpcm_block_frames(bytes, channels);
+    if (frames == 0 || channels > ADPCM_MAX_CHANNELS) {
+        return 0;
+    }
+
+    if (channels == 1) {
+        struct adpcm_state s = {(int16_t)(block[0] | block[1] << 8), block[2] > 88 ? 88 : block[2]};
+        out[0] = (int16_t)s.predictor;
+        const uint8_t *p = block + 4;
+        for (size_t i = 1; i < frames; i += 2, p++) {
+            out[i] = adpcm_decode_nibble(&s, *p & 0x0F);
+            out[i + 1] = adpcm_decode_nibble(&s, *p >> 4);
+        }
+        return frames;
+    }
+
+    // Several channels: sum into a wider buffer a group at a time, each
+    // channel's 8 samples from its own 4 bytes
+    struct adpcm_state s[ADPCM_MAX_CHANNELS];
+    int32_t sum[8];
+    int32_t first = 0;
+    for (unsigned c = 0; c < channels; c++) {
+        const uint8_t *h = block + 4 * c;
+        s[c].predictor = (int16_t)(h[0] | h[1] << 8);
+        s[c].index = h[2] > 88 ? 88 : h[2];
+        first += s[c].predictor;
+    }
+    out[0] = (int16_t)(first / (int32_t)channels);
+
+    const uint8_t *p = block + 4 * channels;
+    for (size_t i = 1; i < frames; i += 8) {
+        memset(sum, 0, sizeof(sum));
+        for (unsigned c = 0; c < channels; c++, p += 4) {
+            for (int j = 0; j < 4; j++) {
+                sum[2 * j] += adpcm_decode_nibble(&s[c], p[j] & 0x0F);
+                sum[2 * j + 1] += adpcm_decode_nibble(&s[c], p[j] >> 4);
+            }
+        }
+        for (int j = 0; j < 8; j++) out[i + j] = (int16_t)(sum[j] / (int32_t)channels);
+    }
+    return frames;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+uint8_t *adpcm_wav_encode(const int16_t *in, size_t frames, uint32_t sample_rate,
+                          unsigned block_align, size_t *len) {
+    unsigned spb = adpcm_samples_per_block(block_align, 1);
+    if (spb == 0 || block_align > ADPCM_MAX_BLOCK_ALIGN || sample_rate == 0 ||
+        frames > UINT32_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    // RIFF, fmt (20-byte body), fact (4), data
+    enum { HEADER = 12 + 8 + 20 + 8 + 4 + 8 };
+    size_t blocks = (frames + spb - 1) / spb;
+    size_t max_len = HEADER + blocks * block_align;
+    uint8_t *buf = calloc(1, max_len + 1);
+    if (!buf) {
+        return NULL;
+    }
+
+    struct adpcm_state s = {0, 0};
+    size_t data = 0;
+    for (size_t start = 0; start < frames; start += spb) {
+        size_t n = frames - start < spb ? frames - start : spb;
+        data += adpcm_encode_block(&s, in + start, n, buf + HEADER + data);
+    }
+
+    uint8_t *p = buf;
+    memcpy(p, "RIFF", 4);
+    put32(p + 4, (uint32_t)(HEADER - 8 + data + (data & 1)));
+    memcpy(p + 8, "WAVE", 4);
+    p += 12;
+    memcpy(p, "fmt ", 4);
+    put32(p + 4, 20);
+    put16(p + 8, WAV_FORMAT_IMA_ADPCM);
+    put16(p + 10, 1);                                       // Channels
+    put32(p + 12, sample_rate);
+    put32(p + 16, (uint32_t)((uint64_t)sample_rate * block_align / spb));
+    put16(p + 20, (uint16_t)block_align);
+    put16(p + 22, 4);                                       // Bits per sample
+    put16(p + 24, 2);                                       // cbSize
+    put16(p + 26, (uint16_t)spb);
+    p += 28;
+    memcpy(p, "fact", 4);
+    put32(p + 4, 4);
+    put32(p + 8, (uint32_t)frames);
+    p += 12;
+    memcpy(p, "data", 4);
+    put32(p + 4, (uint32_t)data);
+
+    *len = HEADER + data + (data & 1);                      // Pad byte is already zero
+    return buf;
+}
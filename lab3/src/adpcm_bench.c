@@ -0,0 +1,169 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "wav_api.h"
+#include "adpcm_api.h"
+#include "audio_pipe_api.h"
+
+/*
+ * IMA ADPCM benchmark.
+ *
+ * For each file, downmixed to 16-bit mono, and each block size: encode
+ * time, size against 16-bit mono, round-trip SNR, and the ns per sample
+ * wav_read() spends decoding when called the way the decoder thread calls
+ * it (AUDIO_PIPE_BLOCK_FRAMES at a time, runs starting anywhere in an
+ * ADPCM block). The first row is the 16-bit mono file read the same way,
+ * for comparison.
+ *
+ * Run: ./adpcm_bench [-r repeats] [file.wav ...]
+ * (defaults to Chipi.wav and "Vine Boom.wav" in the current directory)
+ */
+
+#define DEFAULT_REPEATS 20
+
+static const unsigned block_sizes[] = {256, 512, 1024, 2048};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Best time over repeats to read the whole file in pipe-sized runs
+static double read_ns(const struct wav *w, int16_t *out, int repeats) {
+    long long best = -1;
+    for (int r = 0; r < repeats; r++) {
+        long long t0 = now_ns();
+        for (size_t frame = 0; frame < w->num_frames; ) {
+            size_t n = wav_read(w, frame, out + frame, AUDIO_PIPE_BLOCK_FRAMES);
+            if (n == 0) {
+                break;
+            }
+            frame += n;
+        }
+        long long elapsed = now_ns() - t0;
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    return w->num_frames ? (double)best / w->num_frames : 0;
+}
+
+static double snr_db(const int16_t *ref, const int16_t *x, size_t n) {
+    double signal = 0, noise = 0;
+    for (size_t i = 0; i < n; i++) {
+        double e = (double)ref[i] - x[i];
+        signal += (double)ref[i] * ref[i];
+        noise += e * e;
+    }
+    return noise > 0 ? 10 * log10(signal / noise) : INFINITY;
+}
+
+// A 16-bit mono PCM file in memory, to time the plain path the same way
+static uint8_t *pcm_wav(const int16_t *in, size_t frames, uint32_t rate, size_t *len) {
+    size_t data = frames * 2;
+    uint8_t *buf = malloc(44 + data);
+    if (!buf) {
+        return NULL;
+    }
+    uint32_t v32;
+    uint16_t v16;
+    memcpy(buf, "RIFF", 4);
+    v32 = (uint32_t)(36 + data); memcpy(buf + 4, &v32, 4);
+    memcpy(buf + 8, "WAVEfmt ", 8);
+    v32 = 16; memcpy(buf + 16, &v32, 4);
+    v16 = WAV_FORMAT_PCM; memcpy(buf + 20, &v16, 2);
+    v16 = 1; memcpy(buf + 22, &v16, 2);
+    memcpy(buf + 24, &rate, 4);
+    v32 = rate * 2; memcpy(buf + 28, &v32, 4);
+    v16 = 2; memcpy(buf + 32, &v16, 2);
+    v16 = 16; memcpy(buf + 34, &v16, 2);
+    memcpy(buf + 36, "data", 4);
+    v32 = (uint32_t)data; memcpy(buf + 40, &v32, 4);
+    memcpy(buf + 44, in, data);
+    *len = 44 + data;
+    return buf;
+}
+
+static int bench_file(const char *path, int repeats) {
+    struct wav w;
+    if (wav_open(&w, path) < 0) {
+        perror(path);
+        return -1;
+    }
+    size_t frames = w.num_frames;
+    uint32_t rate = w.sample_rate;
+    int16_t *in = malloc(sizeof(int16_t) * (frames ? frames : 1));
+    int16_t *out = malloc(sizeof(int16_t) * (frames ? frames : 1));
+    if (!in || !out) {
+        perror("malloc");
+        return -1;
+    }
+    wav_read(&w, 0, in, frames);
+    wav_close(&w);
+    printf("%s: %zu frames at %u Hz\n", path, frames, rate);
+    printf("  %-10s %10s %8s %10s %10s %12s %10s\n",
+           "format", "bytes", "ratio", "enc ns", "SNR dB", "read ns", "Msamples/s");
+
+    size_t len;
+    uint8_t *file = pcm_wav(in, frames, rate, &len);
+    if (!file || wav_parse(&w, file, len) < 0) {
+        fprintf(stderr, "pcm_wav failed\n");
+        return -1;
+    }
+    double ns = read_ns(&w, out, repeats);
+    printf("  %-10s %10zu %8.2f %10s %10s %12.2f %10.1f\n", "s16", len, 1.0, "-", "-",
+           ns, ns > 0 ? 1e3 / ns : 0);
+    wav_close(&w);
+    free(file);
+
+    for (size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++) {
+        long long t0 = now_ns();
+        file = adpcm_wav_encode(in, frames, rate, block_sizes[b], &len);
+        double enc_ns = frames ? (double)(now_ns() - t0) / frames : 0;
+        if (!file || wav_parse(&w, file, len) < 0) {
+            fprintf(stderr, "adpcm_wav_encode failed\n");
+            return -1;
+        }
+        ns = read_ns(&w, out, repeats);
+        char name[16];
+        snprintf(name, sizeof(name), "ima/%u", block_sizes[b]);
+        printf("  %-10s %10zu %8.2f %10.2f %10.1f %12.2f %10.1f\n", name, len,
+               (double)frames * 2 / (double)len, enc_ns, snr_db(in, out, frames),
+               ns, ns > 0 ? 1e3 / ns : 0);
+        wav_close(&w);
+        free(file);
+    }
+
+    free(out);
+    free(in);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int repeats = DEFAULT_REPEATS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:")) != -1) {
+        switch (opt) {
+        case 'r': repeats = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-r repeats] [file.wav ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repeats < 1) repeats = 1;
+
+    static const char *default_files[] = {"Chipi.wav", "Vine Boom.wav"};
+    int failed = 0;
+    if (optind == argc) {
+        for (int i = 0; i < 2; i++) failed |= bench_file(default_files[i], repeats) < 0;
+    } else {
+        for (int i = optind; i < argc; i++) failed |= bench_file(argv[i], repeats) < 0;
+    }
+    return failed;
+}
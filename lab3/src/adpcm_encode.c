@@ -0,0 +1,110 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "wav_api.h"
+#include "adpcm_api.h"
+
+/*
+ * Offline IMA ADPCM encoder: converts any WAV file wav_api reads to a
+ * mono 4-bit IMA ADPCM WAV that chipi_chapa, soundboard and the other
+ * players decode as they go.
+ *
+ * The input is downmixed to 16-bit mono first, as the players would play
+ * it, so the output is a quarter of the mono 16-bit size (an eighth of
+ * 16-bit stereo). The file is then decoded back and the SNR of the round
+ * trip printed.
+ *
+ * -b sets the block size in bytes (8 + 4n; default ADPCM_BLOCK_ALIGN).
+ * Larger blocks carry relatively fewer headers but decode in bigger steps.
+ *
+ * Run: ./adpcm_encode [-b block_align] in.wav out.wav
+ */
+
+// SNR of the decoded file against the input, in dB
+static double round_trip_snr(const int16_t *in, const struct wav *w) {
+    int16_t buf[4096];
+    double signal = 0, noise = 0;
+    for (size_t frame = 0; frame < w->num_frames; ) {
+        size_t n = wav_read(w, frame, buf, sizeof(buf) / sizeof(buf[0]));
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            double x = in[frame + i], e = x - buf[i];
+            signal += x * x;
+            noise += e * e;
+        }
+        frame += n;
+    }
+    return noise > 0 ? 10 * log10(signal / noise) : INFINITY;
+}
+
+int main(int argc, char **argv) {
+    unsigned block_align = ADPCM_BLOCK_ALIGN;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:")) != -1) {
+        switch (opt) {
+        case 'b': block_align = (unsigned)atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-b block_align] in.wav out.wav\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind + 2 != argc) {
+        fprintf(stderr, "Usage: %s [-b block_align] in.wav out.wav\n", argv[0]);
+        return 1;
+    }
+    const char *in_path = argv[optind], *out_path = argv[optind + 1];
+
+    struct wav w;
+    if (wav_open(&w, in_path) < 0) {
+        perror(in_path);
+        return 1;
+    }
+    size_t frames = w.num_frames;
+    int16_t *in = malloc(sizeof(int16_t) * (frames ? frames : 1));
+    if (!in) {
+        perror("malloc");
+        return 1;
+    }
+    wav_read(&w, 0, in, frames);
+    uint32_t sample_rate = w.sample_rate;
+    printf("%s: %s x%u, %u Hz, %zu frames, %zu bytes of samples\n", in_path,
+           wav_encoding_name(w.encoding), w.num_channels, sample_rate, frames, w.data_size);
+    wav_close(&w);
+
+    size_t len;
+    uint8_t *file = adpcm_wav_encode(in, frames, sample_rate, block_align, &len);
+    if (!file) {
+        fprintf(stderr, "Block size must be 8 + 4n bytes, at most %d\n", ADPCM_MAX_BLOCK_ALIGN);
+        return 1;
+    }
+
+    FILE *f = fopen(out_path, "wb");
+    if (!f || fwrite(file, 1, len, f) != len || fclose(f) != 0) {
+        perror(out_path);
+        return 1;
+    }
+
+    // Read the result back through the same path the players use
+    struct wav out;
+    if (wav_parse(&out, file, len) < 0 || out.num_frames != frames) {
+        fprintf(stderr, "%s: encoded file does not read back\n", out_path);
+        return 1;
+    }
+    printf("%s: ima-adpcm x1, %u-byte blocks of %u frames, %zu bytes "
+           "(%.2fx smaller than 16-bit mono), SNR %.1f dB\n",
+           out_path, block_align, out.frames_per_block, len,
+           (double)frames * 2 / (double)len, round_trip_snr(in, &out));
+
+    wav_close(&out);
+    free(file);
+    free(in);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#define _GNU_SOURCE
+#include "audio_pipe_api.h"
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Decodes into the block at head; returns 0 at the end of the stream
+static int fill_block(struct audio_pipe *p, size_t head) {
+    struct audio_pipe_block *b = &p->blocks[head % AUDIO_PIPE_BLOCKS];
+    long long start = now_ns();
+    size_t len = p->decode(p->arg, p->next_frame, b->samples, AUDIO_PIPE_BLOCK_FRAMES);
+    long long elapsed = now_ns() - start;
+    if (len == 0) {
+        return 0;
+    }
+    if (len > AUDIO_PIPE_BLOCK_FRAMES) {
+        len = AUDIO_PIPE_BLOCK_FRAMES;
+    }
+
+    p->decode_ns_total += elapsed;
+    if (elapsed > p->decode_ns_max) p->decode_ns_max = elapsed;
+    p->blocks_decoded++;
+    b->len = len;
+    p->next_frame += len;
+    atomic_store_explicit(&p->head, head + 1, memory_order_release);
+    return 1;
+}
+
+static void *decoder(void *arg) {
+    struct audio_pipe *p = arg;
+
+    while (!atomic_load_explicit(&p->stop, memory_order_relaxed)) {
+        size_t head = atomic_load_explicit(&p->head, memory_order_relaxed);
+        if (head - atomic_load_explicit(&p->tail, memory_order_acquire) >=
+            atomic_load_explicit(&p->depth, memory_order_relaxed)) {
+            usleep(AUDIO_PIPE_POLL_US);
+            continue;
+        }
+        if (!fill_block(p, head)) {
+            break;
+        }
+    }
+
+    atomic_store_explicit(&p->done, 1, memory_order_release);
+    return NULL;
+}
+
+int audio_pipe_start(struct audio_pipe *p, audio_decode_fn decode, void *arg) {
+    memset(p, 0, sizeof(*p));
+    p->decode = decode;
+    p->arg = arg;
+    atomic_init(&p->depth, AUDIO_PIPE_BLOCKS);
+
+    // A few blocks up front, so the first ticks do not race the thread
+    int more = 1;
+    for (size_t i = 0; i < AUDIO_PIPE_PREFILL && more; i++) {
+        more = fill_block(p, i);
+    }
+    if (!more) {
+        atomic_store(&p->done, 1);
+        return 0;
+    }
+
+    // Ordinary scheduling, whatever the caller runs under, and no signals
+    pthread_attr_t attr;
+    struct sched_param sp = { .sched_priority = 0 };
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &sp);
+
+    sigset_t all, old_mask;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old_mask);
+    int ret = pthread_create(&p->thread, &attr, decoder, p);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        errno = ret;
+        return -1;
+    }
+    p->running = 1;
+    return 0;
+}
+
+void audio_pipe_set_depth(struct audio_pipe *p, size_t blocks) {
+    if (blocks < 1) blocks = 1;
+    if (blocks > AUDIO_PIPE_BLOCKS) blocks = AUDIO_PIPE_BLOCKS;
+    atomic_store(&p->depth, blocks);
+}
+
+void audio_pipe_stop(struct audio_pipe *p) {
+    atomic_store(&p->stop, 1);
+    if (p->running) {
+        pthread_join(p->thread, NULL);
+        p->running = 0;
+    }
+}
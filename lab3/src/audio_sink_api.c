@@ -0,0 +1,144 @@
+#include "audio_sink_api.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void sink_init(struct audio_sink *s, enum audio_sink_kind kind) {
+    memset(s, 0, sizeof(*s));
+    s->kind = kind;
+    s->level = -1;
+}
+
+void audio_sink_line(struct audio_sink *s, audio_line_fn set_line, void *ctx) {
+    sink_init(s, AUDIO_SINK_LINE);
+    s->set_line = set_line;
+    s->line_ctx = ctx;
+}
+
+void audio_sink_pwm(struct audio_sink *s, struct pwm_audio *pwm) {
+    sink_init(s, AUDIO_SINK_PWM);
+    s->pwm = pwm;
+}
+
+int audio_sink_file(struct audio_sink *s, const char *path) {
+    sink_init(s, AUDIO_SINK_FILE);
+    s->file = fopen(path, "wb");
+    return s->file ? 0 : -1;
+}
+
+void audio_sink_null(struct audio_sink *s) {
+    sink_init(s, AUDIO_SINK_NULL);
+}
+
+int audio_sink_mock(struct audio_sink *s, uint64_t max_ticks) {
+    sink_init(s, AUDIO_SINK_MOCK);
+    s->stamps = malloc(sizeof(int64_t) * (max_ticks ? max_ticks : 1));
+    if (!s->stamps) {
+        return -1;
+    }
+    s->max_stamps = max_ticks;
+    return 0;
+}
+
+static void flush(struct audio_sink *s) {
+    if (s->buf_len && fwrite(s->buf, 1, s->buf_len, s->file) != s->buf_len) {
+        s->file_error = errno ? errno : EIO;
+    }
+    s->buf_len = 0;
+}
+
+void audio_sink_put_byte(struct audio_sink *s, uint8_t byte) {
+    s->buf[s->buf_len++] = byte;
+    if (s->buf_len == sizeof(s->buf)) {
+        flush(s);
+    }
+}
+
+void audio_sink_put_line(struct audio_sink *s, int level) {
+    s->set_line(s->line_ctx, level);
+    s->level = level;
+    s->writes++;
+}
+
+int audio_sink_close(struct audio_sink *s) {
+    int ret = 0;
+    if (s->file) {
+        // A partial last byte is padded with zeros
+        if (s->bit_count) {
+            audio_sink_put_byte(s, (uint8_t)(s->bit_byte << (8 - s->bit_count)));
+            s->bit_count = 0;
+        }
+        flush(s);
+        if (fclose(s->file) != 0 && !s->file_error) {
+            s->file_error = errno;
+        }
+        s->file = NULL;
+        if (s->file_error) {
+            errno = s->file_error;
+            ret = -1;
+        }
+    }
+    free(s->stamps);
+    s->stamps = NULL;
+    return ret;
+}
+
+int audio_sink_timing(const struct audio_sink *s, double ideal_hz, struct audio_sink_timing *t) {
+    uint64_t n = s->ticks < s->max_stamps ? s->ticks : s->max_stamps;
+    memset(t, 0, sizeof(*t));
+    if (!s->stamps || n < 2 || s->stamps[0] < 0 || ideal_hz <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    double ideal = 1e9 / ideal_hz;
+    double sum = 0, sum_sq = 0;
+    uint64_t intervals = 0, recorded = 1, last = 0;
+    t->interval_min_ns = INFINITY;
+    for (uint64_t i = 1; i < n; i++) {
+        if (s->stamps[i] < 0) {
+            continue;
+        }
+        if (s->stamps[i - 1] >= 0) {
+            double d = (double)(s->stamps[i] - s->stamps[i - 1]);
+            sum += d;
+            sum_sq += d * d;
+            if (d < t->interval_min_ns) t->interval_min_ns = d;
+            if (d > t->interval_max_ns) t->interval_max_ns = d;
+            intervals++;
+        }
+
+        double late = (double)(s->stamps[i] - s->stamps[0]) - ideal * (double)i;
+        if (late > t->late_max_ns) t->late_max_ns = late;
+        recorded++;
+        last = i;
+    }
+    if (intervals == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    double count = (double)intervals;
+    t->ticks = recorded;
+    t->period_ns = sum / count;
+    t->interval_sd_ns = sqrt(fmax(0, sum_sq / count - t->period_ns * t->period_ns));
+    t->drift_ns = (double)(s->stamps[last] - s->stamps[0]) - ideal * (double)last;
+    t->drift_ppm = t->drift_ns / (ideal * (double)last) * 1e6;
+    return 0;
+}
+
+int audio_sink_write_log(const struct audio_sink *s, const char *path) {
+    uint64_t n = s->ticks < s->max_stamps ? s->ticks : s->max_stamps;
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return -1;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        if (s->stamps[i] < 0) {
+            continue;
+        }
+        fprintf(f, "%llu %lld\n", (unsigned long long)i,
+                (long long)(s->stamps[i] - s->stamps[0]));
+    }
+    return fclose(f);
+}
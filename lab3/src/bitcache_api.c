@@ -0,0 +1,251 @@
+#define _GNU_SOURCE
+#include "bitcache_api.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define RENDER_FRAMES 4096      // Frames converted per pass while rendering
+
+// On-disk header; the packed bits follow it
+struct bitcache_header {
+    char magic[4];              // "PDM1"
+    uint32_t version;
+    uint64_t key;
+    uint64_t num_bits;
+    uint32_t sample_rate;
+    uint16_t order;
+    uint16_t osr;
+};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+const char *bitcache_default_dir(char *buf, size_t len) {
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    if (xdg && *xdg) {
+        snprintf(buf, len, "%s/%s", xdg, BITCACHE_SUBDIR);
+    } else if (home && *home) {
+        snprintf(buf, len, "%s/.cache/%s", home, BITCACHE_SUBDIR);
+    } else {
+        snprintf(buf, len, "/tmp/%s", BITCACHE_SUBDIR);
+    }
+    return buf;
+}
+
+// FNV-1a over 64-bit words (then the tail bytes): a byte at a time would
+// cost more than rendering the clipper
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len) {
+    const uint8_t *p = data;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t v;
+        memcpy(&v, p + i, sizeof(v));
+        h = (h ^ v) * 0x100000001B3ull;
+    }
+    for (; i < len; i++) {
+        h = (h ^ p[i]) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+uint64_t bitcache_key(const struct wav *w, enum sdm_order order, int osr) {
+    uint32_t params[] = {
+        BITCACHE_VERSION, w->encoding, w->num_channels, w->block_align,
+        w->sample_rate, (uint32_t)order, (uint32_t)osr, (uint32_t)w->num_frames
+    };
+    uint64_t h = fnv1a(0xCBF29CE484222325ull, params, sizeof(params));
+    return fnv1a(h, w->data, w->data_size);
+}
+
+// Packs 8 ticks (bytes of 0 or 1) into one byte, first tick in the MSB.
+// The multiply moves byte i's bit to bit 63 - i without carries
+static inline uint8_t pack8(const uint8_t *ticks) {
+    uint64_t v;
+    memcpy(&v, ticks, sizeof(v));
+    return (uint8_t)((v * 0x8040201008040201ull) >> 56);
+}
+
+int bitcache_render(const struct wav *w, enum sdm_order order, int osr, uint8_t *out) {
+    int16_t *in = malloc(sizeof(int16_t) * RENDER_FRAMES);
+    uint8_t *ticks = malloc((size_t)RENDER_FRAMES * (size_t)osr + 8);
+    if (!in || !ticks) {
+        free(in);
+        free(ticks);
+        return -1;
+    }
+    struct sdm m;
+    sdm_init(&m, order);
+    size_t packed = 0;      // Bytes written to out
+    size_t filled = 0;      // Ticks waiting in ticks[] to be packed
+    int32_t prev = 0;       // Sample before the block; silence before the first
+
+    for (size_t start = 0; start < w->num_frames; start += RENDER_FRAMES) {
+        size_t frames = wav_read(w, start, in, RENDER_FRAMES);
+
+        // Sample n is interpolated from sample n - 1 towards it, as the
+        // task does, so the cached stream is the one played live
+        uint8_t *t = ticks + filled;
+        if (order == SDM_CLIP && osr == 1) {
+            t[0] = prev > 0;
+            for (size_t n = 1; n < frames; n++) t[n] = in[n - 1] > 0;
+        } else {
+            for (size_t n = 0; n < frames; n++) {
+                int32_t x0 = n ? in[n - 1] : prev, dx = in[n] - x0;
+                for (int j = 0; j < osr; j++) {
+                    *t++ = (uint8_t)sdm_step(&m, x0 + dx * j / osr);
+                }
+            }
+        }
+        if (frames) {
+            prev = in[frames - 1];
+        }
+        filled += frames * (size_t)osr;
+
+        // Pack whole bytes; a partial byte waits for the next pass
+        size_t whole = filled / 8;
+        for (size_t i = 0; i < whole; i++) out[packed + i] = pack8(ticks + 8 * i);
+        packed += whole;
+        memmove(ticks, ticks + whole * 8, filled - whole * 8);
+        filled -= whole * 8;
+    }
+    if (filled) {
+        memset(ticks + filled, 0, 8 - filled);
+        out[packed] = pack8(ticks);
+    }
+    free(ticks);
+    free(in);
+    return 0;
+}
+
+// Maps a cache file if it holds the bitstream for this key
+static int load(struct bitcache *c, uint64_t num_bits) {
+    int fd = open(c->path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    size_t want = sizeof(struct bitcache_header) + (size_t)((num_bits + 7) / 8);
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size != want) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, want, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    struct bitcache_header h;
+    memcpy(&h, map, sizeof(h));
+    if (memcmp(h.magic, "PDM1", 4) != 0 || h.version != BITCACHE_VERSION ||
+        h.key != c->key || h.num_bits != num_bits) {
+        munmap(map, want);
+        return -1;
+    }
+    c->map = map;
+    c->map_size = want;
+    c->bits = (const uint8_t *)map + sizeof(h);
+    return 0;
+}
+
+// Writes the bitstream next to its final name, then renames it into place
+// so a concurrent or interrupted run never sees a partial file
+static int store(const struct bitcache *c, const struct bitcache_header *h) {
+    char tmp[sizeof(c->path) + 16];
+    snprintf(tmp, sizeof(tmp), "%s.%d", c->path, (int)getpid());
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        return -1;
+    }
+    size_t bytes = (size_t)((c->num_bits + 7) / 8);
+    int ok = fwrite(h, sizeof(*h), 1, f) == 1 && fwrite(c->buffer, 1, bytes, f) == bytes;
+    if (fclose(f) != 0 || !ok || rename(tmp, c->path) < 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+static void make_dirs(const char *dir) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s", dir);
+    for (char *p = path + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(path, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(path, 0755);
+}
+
+int bitcache_open(struct bitcache *c, const struct wav *w, enum sdm_order order,
+                  int osr, const char *dir) {
+    memset(c, 0, sizeof(*c));
+    if (osr < 1 || osr > UINT16_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    long long start = now_ns();
+    c->num_bits = (uint64_t)w->num_frames * (uint64_t)osr;
+    c->key = bitcache_key(w, order, osr);
+
+    if (dir) {
+        snprintf(c->path, sizeof(c->path), "%s/%016llx.pdm", dir, (unsigned long long)c->key);
+        if (load(c, c->num_bits) == 0) {
+            c->source = BITCACHE_HIT;
+            c->render_ns = now_ns() - start;
+            return 0;
+        }
+    }
+
+    c->buffer = malloc((size_t)((c->num_bits + 7) / 8) + 1);
+    if (!c->buffer) {
+        return -1;
+    }
+    if (bitcache_render(w, order, osr, c->buffer) < 0) {
+        bitcache_close(c);
+        errno = ENOMEM;
+        return -1;
+    }
+    c->bits = c->buffer;
+
+    struct bitcache_header h = {
+        .magic = {'P', 'D', 'M', '1'},
+        .version = BITCACHE_VERSION,
+        .key = c->key,
+        .num_bits = c->num_bits,
+        .sample_rate = w->sample_rate,
+        .order = (uint16_t)order,
+        .osr = (uint16_t)osr,
+    };
+    c->source = BITCACHE_MEMORY;
+    if (dir) {
+        make_dirs(dir);
+        if (store(c, &h) == 0) {
+            c->source = BITCACHE_RENDERED;
+        }
+    }
+    if (c->source == BITCACHE_MEMORY) {
+        c->path[0] = '\0';
+    }
+    c->render_ns = now_ns() - start;
+    return 0;
+}
+
+void bitcache_close(struct bitcache *c) {
+    if (c->map) {
+        munmap(c->map, c->map_size);
+    }
+    free(c->buffer);
+    memset(c, 0, sizeof(*c));
+}
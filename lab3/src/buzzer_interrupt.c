@@ -8,142 +8,138 @@
 #include <stdint.h>
 #include <pthread.h>
 
+#include "rt_api.h"
+#include "sample_clock_api.h"
+#include "pinmap_api.h"
+#include "dds_api.h"
+
 #define CHIP "/dev/gpiochip4"
 #define LED_TEST 21
 #define BUTTON_PIN 14
+#define MAX_EVENTS 16  // Edge events pulled per wake-up
+
+static const struct pin_desc PINS[] = {
+    { "led", LED_TEST, PIN_OUTPUT, 0, 0, 0 },
+    { "button", BUTTON_PIN, PIN_EDGE_FALLING, 0, 0, 10000 },  // 10 ms kernel debounce (v2)
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
 
-// Available frequencies to cycle through
-static const int FREQUENCIES[] = {500, 1000, 1500, 2000, 3000};
+// Available frequencies to cycle through, in millihertz. Any value below
+// DDS_TICK_HZ / 2 works; the tick rate never changes
+static const uint32_t FREQUENCIES[] = {500000, 1000000, 1500000, 2000000, 3000000};
 static const int NUM_FREQUENCIES = 5;
 
-// Global variables for signal handler
-static struct gpiod_line *led = NULL;
+// Tone state (the tick task owns `state` and the phase)
+static struct pin_out led;
+static struct dds tone;
 static int state = 0;
-static timer_t timerid;
 static volatile int current_freq_index = 0;
+static volatile sig_atomic_t stop = 0;
+static struct rt_jitter jitter;
 
-// Timer interrupt handler
-void timer_handler(int sig, siginfo_t *si, void *uc) {
+static void handle_sigint(int sig) {
     (void)sig;
-    (void)si;
-    (void)uc;
+    stop = 1;
+}
+
+// Sample clock task at DDS_TICK_HZ: advance the phase and write the pin
+// only when the square wave's level changes. Skipped ticks still advance
+// the phase, so the tone stays on the clock's grid
+static int tone_tick(void *arg, unsigned skipped) {
+    (void)arg;
     
-    if (led) {
-        // Toggle pin to generate square wave at FREQUENCY_HZ
-        gpiod_line_set_value(led, state);
-        state = !state;
+    dds_skip(&tone, skipped);
+    int level = dds_step(&tone);
+    if (level != state) {
+        pin_write(led, level);
+        state = level;
     }
+    return 0;
 }
 
-int main(void) {
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip) {
-        perror("gpiod_chip_open");
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        fprintf(stderr, "Usage: %s [--rt] [--rt-prio=N] [--rt-cpu=N]\n", argv[0]);
         return 1;
     }
 
-    // Set up the LED line as output test
-    led = gpiod_chip_get_line(chip, LED_TEST);
-    if (!led) {
-        perror("gpiod_chip_get_line");
-        gpiod_chip_close(chip);
+    // LED line as output test, button as input with edge detection
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "buzzer_interrupt", PINS, NUM_PINS) < 0) {
+        perror("pinmap_open");
         return 1;
     }
 
-    if (gpiod_line_request_output(led, "led", 0) < 0) { 
-        perror("led"); 
-        return 1; 
-    }
-    
-    // Set up button as input with edge detection
-    struct gpiod_line *button = gpiod_chip_get_line(chip, BUTTON_PIN);
-    if (!button) {
-        perror("gpiod_chip_get_line button");
-        gpiod_chip_close(chip);
+    struct pin_edge button;
+    if (pinmap_out(&pm, "led", &led) < 0 || pinmap_edge(&pm, "button", &button) < 0) {
+        perror("pins");
+        pinmap_close(&pm);
         return 1;
     }
     
-    if (gpiod_line_request_falling_edge_events(button, "button") < 0) {
-        perror("gpiod_line_request_falling_edge_events");
-        return 1;
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete, tone may jitter\n");
     }
     
-    // Set up signal handler for timer
-    struct sigaction sa;
-    sa.sa_flags = SA_SIGINFO;
-    sa.sa_sigaction = timer_handler;
-    sigemptyset(&sa.sa_mask);
-    
-    if (sigaction(SIGRTMIN, &sa, NULL) == -1) {
-        perror("sigaction");
-        return 1;
-    }
-    
-    // Create a POSIX timer
-    struct sigevent sev;
-    
-    sev.sigev_notify = SIGEV_SIGNAL;
-    sev.sigev_signo = SIGRTMIN;
-    sev.sigev_value.sival_ptr = &timerid;
-    
-    if (timer_create(CLOCK_MONOTONIC, &sev, &timerid) == -1) {
-        perror("timer_create");
-        return 1;
+    if (telemetry_open(argv[0]) < 0) {
+        fprintf(stderr, "Warning: telemetry disabled\n");
     }
     
-    // Configure timer for the initial frequency
-    int current_freq = FREQUENCIES[current_freq_index];
-    long interval_ns = 1000000000L / (2 * current_freq);
+    // Start the tone at the initial frequency; the tick period is fixed
+    // and only the phase increment changes with the tone
+    uint32_t current_freq = FREQUENCIES[current_freq_index];
+    dds_init(&tone, DDS_TICK_HZ);
+    dds_set_freq(&tone, current_freq);
     
-    struct itimerspec timer_spec;
-    timer_spec.it_value.tv_sec = 0;
-    timer_spec.it_value.tv_nsec = interval_ns;
-    timer_spec.it_interval.tv_sec = 0;
-    timer_spec.it_interval.tv_nsec = interval_ns;
-    
-    if (timer_settime(timerid, 0, &timer_spec, NULL) == -1) {
-        perror("timer_settime");
+    struct sample_clock clock;
+    if (sample_clock_start(&clock, DDS_TICK_HZ, SAMPLE_CLOCK_CATCHUP, tone_tick, NULL, &jitter,
+                           telemetry_task("tone", 1000000000L / DDS_TICK_HZ)) < 0) {
+        perror("sample_clock_start");
         return 1;
     }
     
-    printf("Timer interrupt mode: Pin %d buzzer, Pin %d button\n", LED_TEST, BUTTON_PIN);
-    printf("Current frequency: %dHz\n", current_freq);
+    printf("Timer thread mode: Pin %d buzzer, Pin %d button\n", LED_TEST, BUTTON_PIN);
+    printf("DDS tick: %d Hz, resolution %.6f Hz\n", DDS_TICK_HZ, DDS_TICK_HZ / 4294967296.0);
+    printf("Current frequency: %.3fHz\n", dds_actual_hz(DDS_TICK_HZ, atomic_load(&tone.increment)));
     printf("Press button to cycle frequencies. Press Ctrl+C to stop...\n");
 
-    // Monitor button presses
-    while (1) {
+    // Monitor button presses until Ctrl+C
+    signal(SIGINT, handle_sigint);
+    while (!stop) {
         struct timespec timeout = {.tv_sec = 1, .tv_nsec = 0};
-        int ret = gpiod_line_event_wait(button, &timeout);
+        int ret = pin_edge_wait(button, &timeout);
         
         if (ret > 0) {
-            struct gpiod_line_event event;
-            if (gpiod_line_event_read(button, &event) == 0) {
-                if (event.event_type == GPIOD_LINE_EVENT_FALLING_EDGE) {
-                    // Cycle to next frequency
-                    current_freq_index = (current_freq_index + 1) % NUM_FREQUENCIES;
-                    current_freq = FREQUENCIES[current_freq_index];
-                    
-                    // Update timer with new frequency
-                    interval_ns = 1000000000L / (2 * current_freq);
-                    timer_spec.it_value.tv_sec = 0;
-                    timer_spec.it_value.tv_nsec = interval_ns;
-                    timer_spec.it_interval.tv_sec = 0;
-                    timer_spec.it_interval.tv_nsec = interval_ns;
-                    
-                    if (timer_settime(timerid, 0, &timer_spec, NULL) == -1) {
-                        perror("timer_settime");
-                        break;
-                    }
-                    
-                    printf("Frequency changed to: %dHz\n", current_freq);
-                    usleep(50000); // Debounce delay
+            // A bouncing press arrives as a burst; drain it in one read
+            // and treat the whole burst as a single press
+            struct pin_event events[MAX_EVENTS];
+            int n = pin_edge_read(button, events, MAX_EVENTS);
+            int pressed = 0;
+            for (int i = 0; i < n; i++) {
+                if (events[i].type == PIN_EVENT_FALLING) {
+                    pressed = 1;
                 }
             }
+            if (pressed) {
+                // Cycle to next frequency
+                current_freq_index = (current_freq_index + 1) % NUM_FREQUENCIES;
+                current_freq = FREQUENCIES[current_freq_index];
+                
+                // One store; the tick picks it up without a restart
+                dds_set_freq(&tone, current_freq);
+                
+                printf("Frequency changed to: %.3fHz\n",
+                       dds_actual_hz(DDS_TICK_HZ, atomic_load(&tone.increment)));
+                usleep(50000); // Debounce delay
+            }
         }
     }
 
-    timer_delete(timerid);
-    gpiod_line_release(led);
-    gpiod_chip_close(chip);
+    sample_clock_stop(&clock);
+    rt_jitter_report(&jitter, "Tone tick", &rt);
+    sample_clock_report(&clock, "Tone tick");
+    telemetry_close();
+    pinmap_close(&pm);
     return 0;
 }
@@ -3,86 +3,104 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <stdint.h>
+#include <time.h>
 #include <sys/epoll.h>
 
+#include "pinmap_api.h"
+#include "dds_api.h"
+
 #define CHIP "/dev/gpiochip4"
 #define LED_TEST 21
 #define BUTTON_PIN 14
+#define MAX_EVENTS 16  // Edge events pulled per wake-up
+#define BUTTON_CHECK_TICKS (DDS_TICK_HZ / 100)  // Poll the button every 10 ms
+
+static const struct pin_desc PINS[] = {
+    { "led", LED_TEST, PIN_OUTPUT, 0, 0, 0 },
+    { "button", BUTTON_PIN, PIN_EDGE_FALLING, 0, 0, 0 },
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
 
-// Available frequencies to cycle through
-static const int FREQUENCIES[] = {500, 1000, 1500, 2000, 3000};
+// Available frequencies to cycle through, in millihertz
+static const uint32_t FREQUENCIES[] = {500000, 1000000, 1500000, 2000000, 3000000};
 static const int NUM_FREQUENCIES = 5;
 
 int main(void) {
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip) {
-        perror("gpiod_chip_open");
+    // LED line as output test, button as input with edge detection
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "buzzer_polling", PINS, NUM_PINS) < 0) {
+        perror("pinmap_open");
         return 1;
     }
 
-    // Set up the LED line as output test
-    struct gpiod_line *led = gpiod_chip_get_line(chip, LED_TEST);
-    if (!led) {
-        perror("gpiod_chip_get_line");
-        gpiod_chip_close(chip);
+    struct pin_out led;
+    struct pin_edge button;
+    if (pinmap_out(&pm, "led", &led) < 0 || pinmap_edge(&pm, "button", &button) < 0) {
+        perror("pins");
+        pinmap_close(&pm);
         return 1;
     }
 
-    if (gpiod_line_request_output(led, "led", 0) < 0) { 
-        perror("led"); 
-        return 1; 
-    }
-    
-    // Set up button as input with edge detection
-    struct gpiod_line *button = gpiod_chip_get_line(chip, BUTTON_PIN);
-    if (!button) {
-        perror("gpiod_chip_get_line button");
-        gpiod_chip_close(chip);
-        return 1;
-    }
-    
-    if (gpiod_line_request_falling_edge_events(button, "button") < 0) {
-        perror("gpiod_line_request_falling_edge_events");
-        return 1;
-    }
-    
+    // Fixed-rate tick driving a phase accumulator: the loop period never
+    // changes, only the increment does
+    struct dds tone;
+    dds_init(&tone, DDS_TICK_HZ);
     int freq_index = 0;
-    int current_freq = FREQUENCIES[freq_index];
-    long interval_us = 1000000L / (2 * current_freq);
+    dds_set_freq(&tone, FREQUENCIES[freq_index]);
+    const long interval_ns = 1000000000L / DDS_TICK_HZ;
     
     printf("Polling mode: Pin %d buzzer, Pin %d button\n", LED_TEST, BUTTON_PIN);
-    printf("Current frequency: %dHz\n", current_freq);
+    printf("Current frequency: %.3fHz\n", dds_actual_hz(DDS_TICK_HZ, tone.increment));
     printf("Press button to cycle frequencies. Press Ctrl+C to stop...\n");
     
     int state = 0;
     struct timespec timeout = {.tv_sec = 0, .tv_nsec = 0};
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
 
-    while (1) {
-        // Check for button press (non-blocking)
-        int ret = gpiod_line_event_wait(button, &timeout);
+    for (long tick = 0; ; tick++) {
+        // Check for button press (non-blocking), every few milliseconds
+        int ret = tick % BUTTON_CHECK_TICKS == 0 ? pin_edge_wait(button, &timeout) : 0;
         if (ret > 0) {
-            struct gpiod_line_event event;
-            if (gpiod_line_event_read(button, &event) == 0) {
-                if (event.event_type == GPIOD_LINE_EVENT_FALLING_EDGE) {
-                    // Cycle to next frequency
-                    freq_index = (freq_index + 1) % NUM_FREQUENCIES;
-                    current_freq = FREQUENCIES[freq_index];
-                    interval_us = 1000000L / (2 * current_freq);
-                    printf("Frequency changed to: %dHz\n", current_freq);
-                    usleep(50000); // Debounce delay
+            // A bouncing press arrives as a burst; drain it in one read
+            // and treat the whole burst as a single press
+            struct pin_event events[MAX_EVENTS];
+            int n = pin_edge_read(button, events, MAX_EVENTS);
+            int pressed = 0;
+            for (int i = 0; i < n; i++) {
+                if (events[i].type == PIN_EVENT_FALLING) {
+                    pressed = 1;
                 }
             }
+            if (pressed) {
+                // Cycle to next frequency
+                freq_index = (freq_index + 1) % NUM_FREQUENCIES;
+                dds_set_freq(&tone, FREQUENCIES[freq_index]);
+                printf("Frequency changed to: %.3fHz\n",
+                       dds_actual_hz(DDS_TICK_HZ, tone.increment));
+                usleep(50000); // Debounce delay
+                clock_gettime(CLOCK_MONOTONIC, &next);
+            }
         }
         
-        // Toggle pin to generate square wave
-        gpiod_line_set_value(led, state);
-        state = !state;
+        // Write the square wave only when its level changes
+        int level = dds_step(&tone);
+        if (level != state) {
+            pin_write(led, level);
+            state = level;
+        }
         
-        // Poll: sleep for the calculated interval
-        usleep(interval_us);
+        // Poll: sleep until the next tick's absolute deadline, so time
+        // spent above does not stretch the period
+        next.tv_nsec += interval_ns;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
     }
 
-    gpiod_line_release(led);
-    gpiod_chip_close(chip);
+    pinmap_close(&pm);
     return 0;
 }
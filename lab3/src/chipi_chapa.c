@@ -3,206 +3,523 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <signal.h>
 #include <time.h>
 #include <errno.h>
 #include <string.h>
 #include <math.h>
 #include <stdint.h>
 
+#include "rt_api.h"
+#include "sample_clock_api.h"
+#include "wav_api.h"
+#include "sdm_api.h"
+#include "pwm_audio_api.h"
+#include "bitcache_api.h"
+#include "audio_pipe_api.h"
+#include "audio_sink_api.h"
+#include "pinmap_api.h"
+
 #define CHIP "/dev/gpiochip4"
 #define LED_TEST 21
 
 #define WAV_FILE "/home/alfredo/Desktop/repositories/Embedded-lab/Chipi.wav"
+#define STREAM_POLL_US 20000     // How often the main thread moves the stream window
+#define RENDER_BLOCK_FRAMES 4096 // Frames converted at a time when rendering
 
-// WAV file header structure
-typedef struct {
-    char riff[4];              // "RIFF"
-    uint32_t file_size;
-    char wave[4];              // "WAVE"
-    char fmt[4];               // "fmt "
-    uint32_t fmt_size;
-    uint16_t audio_format;
-    uint16_t num_channels;
-    uint32_t sample_rate;
-    uint32_t byte_rate;
-    uint16_t block_align;
-    uint16_t bits_per_sample;
-} __attribute__((packed)) WavHeader;
-
-typedef struct {
-    char id[4];                // "data"
-    uint32_t size;
-} __attribute__((packed)) DataChunkHeader;
-
-// Global variables for signal handler
-static struct gpiod_line *led = NULL;
-static uint8_t *audio_buffer = NULL;
-static size_t current_sample = 0;
-static size_t total_samples = 0;
-static int bytes_per_sample = 0;
-static int num_channels = 0;
-static int bits_per_sample = 0;
-static volatile int playback_complete = 0;
-
-// Timer interrupt handler for audio playback
-void timer_handler(int sig, siginfo_t *si, void *uc) {
-    (void)sig;
-    (void)si;
-    (void)uc;
-    
-    if (led && audio_buffer && current_sample < total_samples) {
-        size_t byte_offset = current_sample * bytes_per_sample * num_channels;
-        int16_t sample = 0;
-        
-        // Read sample (convert to 16-bit signed)
-        if (bits_per_sample == 8) {
-            // 8-bit samples are unsigned (0-255)
-            sample = (audio_buffer[byte_offset] - 128) << 8;
-        } else if (bits_per_sample == 16) {
-            // 16-bit samples are signed
-            sample = *(int16_t*)(&audio_buffer[byte_offset]);
-        }
-        
-        // Simple 1-bit output: high if sample > 0, low otherwise
-        int output = (sample > 0) ? 1 : 0;
-        gpiod_line_set_value(led, output);
-        
-        current_sample++;
-    } else {
-        playback_complete = 1;
+static const struct pin_desc PINS[] = {
+    { "led", LED_TEST, PIN_OUTPUT, 0, 0, 0 },
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
+
+// What drives the tick: the sample clock on CLOCK_MONOTONIC, or a plain
+// loop calling it as fast as it returns (--render)
+enum tick_source { TICK_CLOCK, TICK_RENDER };
+
+// Playback state shared with the sample task
+static enum tick_source tick_source = TICK_CLOCK;
+static struct audio_sink sink;    // GPIO, PWM, file, null or mock output
+static struct audio_pipe decoded; // Samples from the decoder thread
+static atomic_size_t current_sample = 0;
+static unsigned sample_rate = 0;
+static struct rt_jitter jitter;
+static atomic_llong first_sample_ns = 0;
+
+// 1-bit modulation (the task owns these)
+static struct sdm modulator;
+static int osr = 1;             // Output bits per sample
+static int sub_tick = 0;        // Bit within the current sample
+static int32_t x0, x1;          // Previous and current sample
+
+// Pre-rendered bitstream, used instead of modulating per tick when --cache
+// is given (the task owns tick and cache_byte)
+static const uint8_t *cache_bits = NULL;
+static uint64_t cache_ticks = 0;
+static uint64_t tick = 0;
+static unsigned cache_byte = 0;
+
+// GPIO output through the pin map (line sink)
+static struct pinmap pm;
+static struct pin_out led;
+
+// Hardware PWM output, used instead of the GPIO when --pwm is given
+static struct pwm_audio pwm;
+static int use_pwm = 0;
+
+// Inline conversion used instead of the decoder thread when rendering:
+// nothing waits on a clock, so a second thread would only add hand-offs
+static struct wav *render_wav = NULL;
+static int16_t render_block[RENDER_BLOCK_FRAMES];
+static size_t render_frame = 0;
+static size_t render_pos = 0, render_len = 0;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Peak resident memory (VmHWM) in KiB, or -1. getrusage()'s ru_maxrss
+// would report the shell's footprint, since it survives execve()
+static long peak_rss_kib(void) {
+    char line[128];
+    long kib = -1;
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f) {
+        return -1;
     }
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "VmHWM: %ld", &kib) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+    return kib;
 }
 
-int main(void) {
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip) {
-        perror("gpiod_chip_open");
-        return 1;
+// Decoder thread callback: format conversion happens here, off the clock
+static size_t decode_wav(void *arg, size_t frame, int16_t *out, size_t count) {
+    return wav_read(arg, frame, out, count);
+}
+
+// GPIO setter for the line sink
+static void set_led(void *arg, int level) {
+    (void)arg;
+    pin_write(led, level);
+}
+
+// Next sample for the task: 1 = sample, 0 = end, -1 = none ready yet
+static int next_sample(int16_t *out) {
+    if (tick_source == TICK_CLOCK) {
+        return audio_pipe_pop(&decoded, out);
+    }
+    if (render_pos == render_len) {
+        render_len = wav_read(render_wav, render_frame, render_block, RENDER_BLOCK_FRAMES);
+        render_frame += render_len;
+        render_pos = 0;
+        if (render_len == 0) {
+            return 0;
+        }
     }
+    *out = render_block[render_pos++];
+    return 1;
+}
 
-    // Set up the LED line as output test
-    led = gpiod_chip_get_line(chip, LED_TEST);
-    if (!led) {
-        perror("gpiod_chip_get_line");
-        gpiod_chip_close(chip);
-        return 1;
+// Catches up after the clock skipped ticks: moves the bitstream position
+// on, or drops the samples those ticks would have started, so playback
+// stays where the clock says it should be. Returns 1 at the end
+static int skip_ticks(unsigned skipped) {
+    audio_sink_skip(&sink, skipped);
+    if (cache_bits) {
+        tick = tick + skipped < cache_ticks ? tick + skipped : cache_ticks;
+        if (tick & 7) {
+            cache_byte = (unsigned)cache_bits[tick >> 3] << (tick & 7);
+        }
+        sub_tick = (int)(tick % (uint64_t)osr);
+        atomic_store_explicit(&current_sample, (size_t)(tick / (uint64_t)osr),
+                              memory_order_relaxed);
+        return tick == cache_ticks;
     }
 
-    if (gpiod_line_request_output(led, "led", 0) < 0) { 
-        perror("led"); 
-        return 1; 
+    // A sample starts at each skipped tick with sub_tick 0
+    unsigned drop = (sub_tick + skipped - 1) / (unsigned)osr + (sub_tick == 0);
+    sub_tick = (int)((sub_tick + skipped) % (unsigned)osr);
+    size_t n = atomic_load_explicit(&current_sample, memory_order_relaxed);
+    for (unsigned i = 0; i < drop; i++) {
+        int16_t next;
+        int ret = next_sample(&next);
+        if (ret == 0) {
+            return 1;
+        }
+        x0 = x1;
+        if (ret > 0) {
+            x1 = next;
+            n++;
+        }
     }
-    
-    // Open WAV file
-    FILE *wav_file = fopen(WAV_FILE, "rb");
-    if (!wav_file) {
-        perror("fopen wav file");
+    atomic_store_explicit(&current_sample, n, memory_order_relaxed);
+    return 0;
+}
+
+// Sample clock task: output one bit per tick, osr ticks per sample, stop
+// at the end of the data
+static int play_sample(void *arg, unsigned skipped) {
+    (void)arg;
+    if (skipped && skip_ticks(skipped)) {
         return 1;
     }
+    size_t n = atomic_load_explicit(&current_sample, memory_order_relaxed);
     
-    // Read WAV header
-    WavHeader header;
-    if (fread(&header, sizeof(WavHeader), 1, wav_file) != 1) {
-        perror("fread header");
-        fclose(wav_file);
+    if (cache_bits) {
+        // Everything was modulated up front: shift out the next bit
+        if (tick == cache_ticks) {
+            return 1;
+        }
+        if ((tick & 7) == 0) {
+            cache_byte = cache_bits[tick >> 3];
+        }
+        audio_sink_bit(&sink, cache_byte >> 7 & 1);
+        cache_byte <<= 1;
+
+        if (tick++ == 0) {
+            atomic_store_explicit(&first_sample_ns, now_ns(), memory_order_relaxed);
+        }
+        if (++sub_tick == osr) {
+            sub_tick = 0;
+            atomic_store_explicit(&current_sample, n + 1, memory_order_relaxed);
+        }
+        return 0;
+    }
+
+    // Next sample from the decoder; on an underrun hold the last one
+    if (sub_tick == 0) {
+        int16_t next;
+        int ret = next_sample(&next);
+        if (ret == 0) {
+            return 1;
+        }
+        x0 = x1;
+        if (ret > 0) {
+            x1 = next;
+            if (n == 0) {
+                atomic_store_explicit(&first_sample_ns, now_ns(), memory_order_relaxed);
+            }
+            atomic_store_explicit(&current_sample, n + 1, memory_order_relaxed);
+        }
+    }
+
+    if (use_pwm) {
+        // Multi-level output: the sample becomes the carrier's duty cycle
+        audio_sink_sample(&sink, (int16_t)x1);
+    } else {
+        // Linear interpolation from the previous sample to this one, so
+        // the modulator sees a smooth input at the oversampled rate
+        audio_sink_bit(&sink, sdm_step(&modulator, x0 + (x1 - x0) * sub_tick / osr));
+    }
+    if (++sub_tick == osr) {
+        sub_tick = 0;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long long start_ns = now_ns();
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        fprintf(stderr, "Usage: %s [--rt] [--rt-prio=N] [--rt-cpu=N] [--load] "
+                        "[--sdm=0|1|2] [--osr=N] [--cache[=dir]] [--pwm[=chip_dir]] "
+                        "[--carrier=HZ] [--render[=out]] [--mock[=ticks.log]] "
+                        "[file.wav]\n", argv[0]);
         return 1;
     }
-    
-    printf("WAV Info:\n");
-    printf("  Channels: %d\n", header.num_channels);
-    printf("  Sample Rate: %d Hz\n", header.sample_rate);
-    printf("  Bits per Sample: %d\n", header.bits_per_sample);
-    
-    // Find data chunk
-    DataChunkHeader data_chunk;
-    while (fread(&data_chunk, sizeof(DataChunkHeader), 1, wav_file) == 1) {
-        if (strncmp(data_chunk.id, "data", 4) == 0) {
-            break;
+
+    // --load: read the whole data chunk up front (the original loader)
+    // --sdm:  0 = clip at zero (default), 1/2 = sigma-delta order
+    // --osr:  output bits per sample (default 1; try --sdm=2 --osr=8)
+    // --cache: modulate the whole file before playing and keep the packed
+    //         bitstream on disk (optionally in another directory)
+    // --pwm:  hardware PWM duty cycle instead of the GPIO (optionally on
+    //         another chip directory, e.g. a fake tree for testing)
+    // --render: no clock and no GPIO; run the tick as fast as possible
+    //         into a file (bits packed MSB first, or s16 samples with
+    //         --pwm) or, without a file, into a null sink, and report the
+    //         throughput
+    // --mock: the real clock, but a mock line instead of the GPIO that
+    //         timestamps every tick; reports jitter and drift against
+    //         the exact rate, and writes the timestamps to a file if given
+    const char *path = WAV_FILE;
+    const char *pwm_chip = PWM_AUDIO_CHIP;
+    long carrier_hz = PWM_AUDIO_CARRIER_HZ;
+    char cache_dir[256];
+    const char *use_cache = NULL;
+    const char *render_path = NULL;
+    const char *mock_log = NULL;
+    int render = 0, mock = 0;
+    int load = 0;
+    int order = SDM_CLIP;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--load") == 0) {
+            load = 1;
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            use_cache = bitcache_default_dir(cache_dir, sizeof(cache_dir));
+        } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+            use_cache = argv[i] + 8;
+        } else if (strcmp(argv[i], "--pwm") == 0) {
+            use_pwm = 1;
+        } else if (strncmp(argv[i], "--pwm=", 6) == 0) {
+            use_pwm = 1;
+            pwm_chip = argv[i] + 6;
+        } else if (strncmp(argv[i], "--carrier=", 10) == 0) {
+            carrier_hz = atol(argv[i] + 10);
+        } else if (strncmp(argv[i], "--sdm=", 6) == 0) {
+            order = atoi(argv[i] + 6);
+        } else if (strncmp(argv[i], "--osr=", 6) == 0) {
+            osr = atoi(argv[i] + 6);
+        } else if (strcmp(argv[i], "--render") == 0) {
+            render = 1;
+        } else if (strncmp(argv[i], "--render=", 9) == 0) {
+            render = 1;
+            render_path = argv[i] + 9;
+        } else if (strcmp(argv[i], "--mock") == 0) {
+            mock = 1;
+        } else if (strncmp(argv[i], "--mock=", 7) == 0) {
+            mock = 1;
+            mock_log = argv[i] + 7;
+        } else {
+            path = argv[i];
         }
-        // Skip unknown chunk
-        fseek(wav_file, data_chunk.size, SEEK_CUR);
     }
-    
-    printf("  Data Size: %d bytes\n", data_chunk.size);
-    
-    // Store audio parameters in global variables
-    bytes_per_sample = header.bits_per_sample / 8;
-    num_channels = header.num_channels;
-    bits_per_sample = header.bits_per_sample;
-    total_samples = data_chunk.size / (bytes_per_sample * num_channels);
-    
-    // Read audio data into buffer
-    audio_buffer = malloc(data_chunk.size);
-    if (!audio_buffer) {
-        perror("malloc");
-        fclose(wav_file);
+    if (order < SDM_CLIP || order > SDM_ORDER2 || osr < 1) {
+        fprintf(stderr, "--sdm must be 0, 1 or 2 and --osr at least 1\n");
         return 1;
     }
-    
-    size_t bytes_read = fread(audio_buffer, 1, data_chunk.size, wav_file);
-    fclose(wav_file);
-    
-    if (bytes_read != data_chunk.size) {
-        fprintf(stderr, "Failed to read complete audio data\n");
-        free(audio_buffer);
+    sdm_init(&modulator, order);
+    if (use_pwm && (order != SDM_CLIP || osr != 1 || use_cache)) {
+        fprintf(stderr, "--sdm, --osr and --cache apply to the GPIO output only\n");
         return 1;
     }
+    if (render && mock) {
+        fprintf(stderr, "--render and --mock are exclusive\n");
+        return 1;
+    }
+    if (render) {
+        tick_source = TICK_RENDER;
+    }
+
+    // Once the output is open, every error exit goes through `fail`
+    struct wav wav = {0};
+    struct bitcache cache = {0};
+
+    // The output: a file or null sink when rendering, the mock line (set up
+    // once the length is known), or the real device
+    if (render) {
+        if (!render_path) {
+            audio_sink_null(&sink);
+        } else if (audio_sink_file(&sink, render_path) < 0) {
+            perror(render_path);
+            return 1;
+        }
+    } else if (mock) {
+        // Opened below
+    } else if (use_pwm) {
+        if (pwm_audio_open(&pwm, pwm_chip, 0, carrier_hz) < 0) {
+            perror(pwm_chip);
+            return 1;
+        }
+        printf("PWM output: %s/pwm0, %ld ns carrier\n", pwm_chip, pwm.period_ns);
+        audio_sink_pwm(&sink, &pwm);
+    } else {
+        // Set up the LED line as output test
+        if (pinmap_open(&pm, CHIP, "chipi_chapa", PINS, NUM_PINS) < 0) {
+            perror("pinmap_open");
+            return 1;
+        }
+        if (pinmap_out(&pm, "led", &led) < 0) {
+            perror("led");
+            pinmap_close(&pm);
+            return 1;
+        }
+        audio_sink_line(&sink, set_led, NULL);
+    }
     
-    printf("Playing audio using timer interrupts...\n");
+    // Map the file and parse the header; samples are read in as they play
+    if ((load ? wav_load(&wav, path) : wav_open(&wav, path)) < 0) {
+        perror(path);
+        goto fail;
+    }
     
-    // Set up signal handler for timer
-    struct sigaction sa;
-    sa.sa_flags = SA_SIGINFO;
-    sa.sa_sigaction = timer_handler;
-    sigemptyset(&sa.sa_mask);
+    printf("WAV Info:\n");
+    printf("  Channels: %d\n", wav.num_channels);
+    printf("  Sample Rate: %u Hz\n", wav.sample_rate);
+    printf("  Bits per Sample: %d (%s)\n", wav.bits_per_sample, wav_encoding_name(wav.encoding));
+    printf("  Data Size: %zu bytes\n", wav.data_size);
     
-    if (sigaction(SIGRTMIN, &sa, NULL) == -1) {
-        perror("sigaction");
-        free(audio_buffer);
-        return 1;
+    // Store audio parameters in global variables
+    sample_rate = wav.sample_rate;
+    uint64_t total_ticks = (uint64_t)wav.num_frames * (uint64_t)osr;
+
+    // With the cache the task never reads the file, so it is closed once
+    // the bitstream is there
+    if (use_cache) {
+        if (bitcache_open(&cache, &wav, order, osr, use_cache) < 0) {
+            perror("bitcache_open");
+            goto fail;
+        }
+        static const char *sources[] = {"cache hit", "rendered and cached", "rendered, not cached"};
+        printf("Bitstream: %llu bits, %llu bytes vs %zu bytes of samples, %s in %.1f ms\n",
+               (unsigned long long)cache.num_bits, (unsigned long long)(cache.num_bits + 7) / 8,
+               wav.data_size, sources[cache.source], cache.render_ns / 1e6);
+        if (cache.path[0]) {
+            printf("  %s\n", cache.path);
+        }
+        cache_bits = cache.bits;
+        cache_ticks = cache.num_bits;
+        total_ticks = cache.num_bits;
+        wav_close(&wav);
+    }
+
+    // One timestamp per tick, allocated before mlockall()
+    if (mock && audio_sink_mock(&sink, total_ticks) < 0) {
+        perror("audio_sink_mock");
+        goto fail;
     }
     
-    // Create a POSIX timer
-    timer_t timerid;
-    struct sigevent sev;
-    
-    sev.sigev_notify = SIGEV_SIGNAL;
-    sev.sigev_signo = SIGRTMIN;
-    sev.sigev_value.sival_ptr = &timerid;
+    // Lock and prefault everything the sample task touches; mlockall()
+    // already reads in the whole mapping when streaming
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete, timing may jitter\n");
+    }
+    if (rt.enabled && wav.buffer) {
+        rt_prefault(wav.buffer, wav.data_size);
+    }
+    if (rt.enabled && cache.buffer) {
+        rt_prefault(cache.buffer, (size_t)(cache.num_bits + 7) / 8);
+    }
+    wav_stream(&wav, 0);
+
+    static const char *sinks[] = {"GPIO", "PWM duty", "file", "null", "mock line"};
+    const char *source = use_cache ? "pre-rendered" : load ? "loaded" : "streamed";
+    if (render) {
+        // No clock: the tick runs back to back on this thread and converts
+        // inline, so the figure is the cost of the whole audio path
+        printf("Rendering to %s (%s, %s)...\n", render_path ? render_path : "null sink", source,
+               use_pwm ? "PWM samples" : sdm_name(order));
+        render_wav = &wav;
+        long long t0 = now_ns();
+        for (uint64_t ticks = 0; play_sample(NULL, 0) == 0; ticks++) {
+            if ((ticks & 0xFFFF) == 0) {
+                wav_stream(&wav, atomic_load_explicit(&current_sample, memory_order_relaxed));
+            }
+        }
+        double seconds = (now_ns() - t0) / 1e9;
+        size_t samples = atomic_load(&current_sample);
+        printf("Rendered %zu samples (%llu ticks) in %.3f s: %.2f Msamples/s, "
+               "%.1f ns per tick, %.0fx real time\n",
+               samples, (unsigned long long)sink.ticks, seconds, samples / seconds / 1e6,
+               seconds * 1e9 / (double)(sink.ticks ? sink.ticks : 1),
+               (double)samples / sample_rate / seconds);
+        wav_close(&wav);
+        bitcache_close(&cache);
+        if (audio_sink_close(&sink) < 0) {
+            perror(render_path);
+            return 1;
+        }
+        return 0;
+    }
     
-    if (timer_create(CLOCK_MONOTONIC, &sev, &timerid) == -1) {
-        perror("timer_create");
-        free(audio_buffer);
-        return 1;
+    if (telemetry_open(argv[0]) < 0) {
+        fprintf(stderr, "Warning: telemetry disabled\n");
     }
     
-    // Configure timer for sample rate
-    long interval_ns = 1000000000L / header.sample_rate;
+    if (use_pwm) {
+        printf("Playing audio from a sample clock thread (%s mode, %s, PWM duty to %s)...\n",
+               rt_mode_name(&rt), source, sinks[sink.kind]);
+    } else {
+        printf("Playing audio from a sample clock thread (%s mode, %s, %s modulator at %dx to %s)...\n",
+               rt_mode_name(&rt), source, sdm_name(order), osr, sinks[sink.kind]);
+    }
     
-    struct itimerspec timer_spec;
-    timer_spec.it_value.tv_sec = 0;
-    timer_spec.it_value.tv_nsec = interval_ns;  // Initial expiration
-    timer_spec.it_interval.tv_sec = 0;
-    timer_spec.it_interval.tv_nsec = interval_ns;  // Periodic interval
+    // The decoder thread converts ahead of the sample task; it runs under
+    // SCHED_OTHER, so it never delays a tick
+    if (!use_cache && audio_pipe_start(&decoded, decode_wav, &wav) < 0) {
+        perror("audio_pipe_start");
+        goto fail;
+    }
     
-    if (timer_settime(timerid, 0, &timer_spec, NULL) == -1) {
-        perror("timer_settime");
-        timer_delete(timerid);
-        free(audio_buffer);
-        return 1;
+    // osr ticks per sample at the exact rate (44.1 kHz is not a whole
+    // number of nanoseconds); the clock inherits the RT settings applied
+    // above
+    uint32_t tick_hz = sample_rate * (uint32_t)osr;
+    struct sample_clock clock;
+    if (sample_clock_start(&clock, tick_hz, SAMPLE_CLOCK_CATCHUP, play_sample, NULL, &jitter,
+                           telemetry_task("audio", 1000000000L / tick_hz)) < 0) {
+        perror("sample_clock_start");
+        goto fail;
     }
     
-    // Wait for playback to complete
-    while (!playback_complete) {
-        pause();  // Wait for signals
+    // Keep the stream window ahead of the sample task until playback ends
+    while (!sample_clock_finished(&clock)) {
+        wav_stream(&wav, atomic_load(&current_sample));
+        usleep(STREAM_POLL_US);
     }
+    sample_clock_join(&clock);
     
-    printf("Playback complete!\n");
+    printf("Playback complete! (%lld ticks skipped)\n", atomic_load(&clock.skipped));
+    printf("Time to first sample: %.2f ms, peak RSS: %ld KiB (%s)\n",
+           (atomic_load(&first_sample_ns) - start_ns) / 1e6, peak_rss_kib(), source);
+    rt_jitter_report(&jitter, "Audio sample", &rt);
+    sample_clock_report(&clock, "Audio sample");
+    telemetry_close();
     
-    timer_delete(timerid);
-    free(audio_buffer);
-    gpiod_line_release(led);
-    gpiod_chip_close(chip);
+    audio_pipe_stop(&decoded);
+    if (!use_cache) {
+        long blocks = decoded.blocks_decoded;
+        printf("Decoder: %ld blocks of %d frames, %.1f us mean, %.1f us max; "
+               "%ld underrun ticks in %ld stretches\n",
+               blocks, AUDIO_PIPE_BLOCK_FRAMES,
+               blocks ? decoded.decode_ns_total / 1e3 / blocks : 0.0,
+               decoded.decode_ns_max / 1e3, atomic_load(&decoded.underruns),
+               atomic_load(&decoded.underrun_runs));
+    }
+    wav_close(&wav);
+    bitcache_close(&cache);
+
+    // Tick timing as the mock line saw it, against the exact tick rate
+    struct audio_sink_timing timing;
+    if (mock && audio_sink_timing(&sink, (double)tick_hz, &timing) == 0) {
+        printf("Mock line: %llu ticks, %llu skipped, %llu level changes\n",
+               (unsigned long long)timing.ticks, (unsigned long long)sink.skipped,
+               (unsigned long long)sink.writes);
+        printf("  interval: mean %.1f ns (ideal %.1f), min %.0f, max %.0f, sd %.1f ns\n",
+               timing.period_ns, 1e9 / (double)tick_hz,
+               timing.interval_min_ns, timing.interval_max_ns, timing.interval_sd_ns);
+        printf("  drift at end: %+.3f ms (%+.1f ppm), worst lateness %.3f ms\n",
+               timing.drift_ns / 1e6, timing.drift_ppm, timing.late_max_ns / 1e6);
+        if (mock_log && audio_sink_write_log(&sink, mock_log) < 0) {
+            perror(mock_log);
+        } else if (mock_log) {
+            printf("  timestamps written to %s\n", mock_log);
+        }
+    }
+
+    if (sink.kind == AUDIO_SINK_PWM) {
+        printf("PWM: %ld duty writes, %ld unchanged, %ld failed\n",
+               pwm.writes, pwm.skipped, pwm.errors);
+        pwm_audio_close(&pwm);
+    } else if (sink.kind == AUDIO_SINK_LINE) {
+        printf("GPIO: %llu writes for %llu ticks\n",
+               (unsigned long long)sink.writes, (unsigned long long)sink.ticks);
+        pinmap_close(&pm);
+    }
+    audio_sink_close(&sink);
     return 0;
+
+fail:
+    telemetry_close();
+    audio_pipe_stop(&decoded);
+    wav_close(&wav);
+    bitcache_close(&cache);
+    if (sink.kind == AUDIO_SINK_PWM) pwm_audio_close(&pwm);
+    if (sink.kind == AUDIO_SINK_LINE) pinmap_close(&pm);
+    audio_sink_close(&sink);
+    return 1;
 }
@@ -0,0 +1,162 @@
+#include "dds_api.h"
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t dds_increment(uint32_t tick_hz, uint32_t freq_mhz) {
+    // f / tick * 2^32, with f in millihertz
+    uint64_t num = ((uint64_t)freq_mhz << 32) + 500ULL * tick_hz;
+    return (uint32_t)(num / (1000ULL * tick_hz));
+}
+
+double dds_actual_hz(uint32_t tick_hz, uint32_t increment) {
+    return (double)increment * tick_hz / 4294967296.0;
+}
+
+void dds_init(struct dds *d, uint32_t tick_hz) {
+    d->phase = 0;
+    d->tick_hz = tick_hz;
+    atomic_init(&d->increment, 0);
+}
+
+void dds_set_freq(struct dds *d, uint32_t freq_mhz) {
+    atomic_store_explicit(&d->increment, dds_increment(d->tick_hz, freq_mhz),
+                          memory_order_relaxed);
+}
+
+void dds_seq_load(struct dds_seq *s) {
+    const struct dds_note *n = &s->notes[s->index];
+    uint32_t ticks = (uint32_t)((uint64_t)n->ms * s->dds.tick_hz / 1000);
+    s->ticks_left = ticks ? ticks : 1;
+    s->sounding = n->freq_mhz != 0;
+    if (s->sounding) {
+        dds_set_freq(&s->dds, n->freq_mhz);
+    }
+}
+
+void dds_seq_init(struct dds_seq *s, const struct dds_note *notes, int num_notes,
+                  uint32_t tick_hz) {
+    memset(s, 0, sizeof(*s));
+    dds_init(&s->dds, tick_hz);
+    s->notes = notes;
+    s->num_notes = num_notes;
+    s->gap_ticks = DDS_NOTE_GAP_MS * tick_hz / 1000;
+    s->index = -1;      // The first step loads note 0
+}
+
+// Skips whitespace and returns the next character without consuming it
+static char peek(const char **p) {
+    while (isspace((unsigned char)**p)) (*p)++;
+    return **p;
+}
+
+static int parse_number(const char **p, int *value) {
+    peek(p);
+    if (!isdigit((unsigned char)**p)) {
+        return 0;
+    }
+    *value = (int)strtol(*p, (char **)p, 10);
+    return 1;
+}
+
+int rtttl_parse(const char *text, struct dds_note *notes, int max_notes,
+                char *name, size_t name_len) {
+    // Semitones above C for a..g
+    static const int SEMITONE[] = {9, 11, 0, 2, 4, 5, 7};
+    int def_duration = 4, def_octave = 6, bpm = 63;
+    const char *p = text;
+
+    // Name
+    const char *colon = strchr(p, ':');
+    if (!colon) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (name && name_len) {
+        size_t len = (size_t)(colon - p) < name_len - 1 ? (size_t)(colon - p) : name_len - 1;
+        memcpy(name, p, len);
+        name[len] = '\0';
+    }
+    p = colon + 1;
+
+    // Defaults: d=, o=, b= in any order
+    while (peek(&p) && *p != ':') {
+        char key = (char)tolower((unsigned char)*p++);
+        int value;
+        if (peek(&p) != '=') {
+            errno = EINVAL;
+            return -1;
+        }
+        p++;
+        if (!parse_number(&p, &value)) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (key == 'd') def_duration = value;
+        else if (key == 'o') def_octave = value;
+        else if (key == 'b') bpm = value;
+        if (peek(&p) == ',') p++;
+    }
+    if (*p != ':' || bpm <= 0 || def_duration <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    p++;
+
+    // Notes
+    long whole_ms = 4L * 60000 / bpm;
+    int count = 0;
+    while (peek(&p)) {
+        int duration = def_duration, octave = def_octave, dotted = 0;
+        parse_number(&p, &duration);
+        char c = (char)tolower((unsigned char)peek(&p));
+        if ((c < 'a' || c > 'g') && c != 'p') {
+            errno = EINVAL;
+            return -1;
+        }
+        p++;
+        int semitone = c == 'p' ? -1 : SEMITONE[c - 'a'];
+        if (*p == '#') {
+            semitone++;
+            p++;
+        }
+        if (*p == '.') {
+            dotted = 1;
+            p++;
+        }
+        parse_number(&p, &octave);
+        if (peek(&p) == '.') {
+            dotted = 1;
+            p++;
+        }
+        if (duration <= 0 || octave < 0 || octave > 9) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (count == max_notes) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        struct dds_note *n = &notes[count++];
+        n->ms = (uint32_t)(whole_ms / duration);
+        if (dotted) n->ms += n->ms / 2;
+        if (semitone < 0) {
+            n->freq_mhz = 0;
+        } else {
+            // Equal temperament, A4 = 440 Hz (MIDI note 69)
+            int midi = 12 * (octave + 1) + semitone;
+            n->freq_mhz = (uint32_t)lround(440000.0 * pow(2.0, (midi - 69) / 12.0));
+        }
+
+        if (peek(&p) == ',') {
+            p++;
+        } else if (*p) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,206 @@
+#define _GNU_SOURCE
+#include <gpiod.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/*
+ * Edge-rate stress test: one-event-per-wake-up vs batched draining.
+ *
+ * Wire OUT_PIN to IN_PIN with a jumper. A generator thread toggles OUT_PIN
+ * at a fixed edge rate while the main thread consumes edge events on IN_PIN,
+ * first reading one event per wake-up (gpiod_line_event_read), then draining
+ * up to MAX_EVENTS per wake-up (gpiod_line_event_read_multiple). Events the
+ * kernel FIFO drops show up as received < generated.
+ *
+ * Run: sudo ./edge_stress [out_pin in_pin]
+ */
+
+#define CHIP "/dev/gpiochip4"
+#define OUT_PIN 20
+#define IN_PIN 21
+
+#define MAX_EVENTS 64
+#define RUN_MS 1000           // Generation time per rate step
+#define DRAIN_MS 50           // Extra time to collect late events
+#define LOSS_LIMIT_PPM 1000   // "Sustainable" = at most 0.1% lost
+
+static const long RATES[] = {1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000};
+static const int NUM_RATES = sizeof(RATES) / sizeof(RATES[0]);
+
+struct generator {
+    struct gpiod_line *out;
+    long rate;
+    atomic_int done;
+    long generated;
+};
+
+struct result {
+    long generated;
+    long received;
+    long wakeups;
+};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Toggle the output at a fixed rate, pacing against absolute deadlines
+static void *generator_thread(void *arg) {
+    struct generator *g = arg;
+    long long period_ns = 1000000000LL / g->rate;
+    long long start = now_ns();
+    long long end = start + (long long)RUN_MS * 1000000LL;
+    long long next = start;
+    int level = 0;
+
+    g->generated = 0;
+    while (next < end) {
+        while (now_ns() < next) {
+            // spin: nanosleep granularity is too coarse above ~10 kHz
+        }
+        level = !level;
+        gpiod_line_set_value(g->out, level);
+        g->generated++;
+        next += period_ns;
+    }
+
+    atomic_store(&g->done, 1);
+    return NULL;
+}
+
+static int run_step(struct gpiod_line *out, struct gpiod_line *in,
+                    long rate, int batch, struct result *res) {
+    struct generator g = { .out = out, .rate = rate, .done = 0 };
+    struct gpiod_line_event evs[MAX_EVENTS];
+    pthread_t tid;
+
+    // Flush anything left over from the previous step
+    while (gpiod_line_event_wait(in, &(struct timespec){0, 0}) > 0) {
+        gpiod_line_event_read_multiple(in, evs, MAX_EVENTS);
+    }
+
+    res->received = 0;
+    res->wakeups = 0;
+
+    if (pthread_create(&tid, NULL, generator_thread, &g) != 0) {
+        perror("pthread_create");
+        return -1;
+    }
+
+    long long drain_deadline = 0;
+    while (1) {
+        if (atomic_load(&g.done)) {
+            if (drain_deadline == 0) {
+                drain_deadline = now_ns() + (long long)DRAIN_MS * 1000000LL;
+            } else if (now_ns() >= drain_deadline) {
+                break;
+            }
+        }
+
+        int ret = gpiod_line_event_wait(in, &(struct timespec){ .tv_sec = 0, .tv_nsec = 10000000 });
+        if (ret < 0) {
+            perror("gpiod_line_event_wait");
+            break;
+        }
+        if (ret == 0) {
+            continue;
+        }
+
+        res->wakeups++;
+        if (batch) {
+            int n = gpiod_line_event_read_multiple(in, evs, MAX_EVENTS);
+            if (n > 0) {
+                res->received += n;
+            }
+        } else {
+            if (gpiod_line_event_read(in, &evs[0]) == 0) {
+                res->received++;
+            }
+        }
+    }
+
+    pthread_join(tid, NULL);
+    res->generated = g.generated;
+    return 0;
+}
+
+static int sustainable(const struct result *r) {
+    return r->generated > 0 &&
+           (r->generated - r->received) * 1000000LL <= r->generated * (long long)LOSS_LIMIT_PPM;
+}
+
+int main(int argc, char **argv) {
+    unsigned int out_pin = OUT_PIN;
+    unsigned int in_pin = IN_PIN;
+    if (argc == 3) {
+        out_pin = (unsigned int)atoi(argv[1]);
+        in_pin = (unsigned int)atoi(argv[2]);
+    }
+
+    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
+    if (!chip) {
+        perror("gpiod_chip_open");
+        return 1;
+    }
+
+    struct gpiod_line *out = gpiod_chip_get_line(chip, out_pin);
+    struct gpiod_line *in = gpiod_chip_get_line(chip, in_pin);
+    if (!out || !in) {
+        perror("gpiod_chip_get_line");
+        gpiod_chip_close(chip);
+        return 1;
+    }
+
+    if (gpiod_line_request_output(out, "stress_out", 0) < 0) {
+        perror("gpiod_line_request_output");
+        gpiod_chip_close(chip);
+        return 1;
+    }
+    if (gpiod_line_request_both_edges_events(in, "stress_in") < 0) {
+        perror("gpiod_line_request_both_edges_events");
+        gpiod_chip_close(chip);
+        return 1;
+    }
+
+    printf("Edge stress: GPIO %u -> GPIO %u, %d ms per step\n\n", out_pin, in_pin, RUN_MS);
+    printf("%10s | %-26s | %-26s\n", "", "single read", "batched read");
+    printf("%10s | %9s %7s %8s | %9s %7s %8s\n",
+           "edges/s", "received", "lost%", "wakeups", "received", "lost%", "wakeups");
+
+    long best_single = 0;
+    long best_batch = 0;
+
+    for (int i = 0; i < NUM_RATES; i++) {
+        struct result single, batch;
+        if (run_step(out, in, RATES[i], 0, &single) < 0 ||
+            run_step(out, in, RATES[i], 1, &batch) < 0) {
+            break;
+        }
+
+        printf("%10ld | %9ld %6.2f%% %8ld | %9ld %6.2f%% %8ld\n", RATES[i],
+               single.received,
+               100.0 * (single.generated - single.received) / single.generated,
+               single.wakeups,
+               batch.received,
+               100.0 * (batch.generated - batch.received) / batch.generated,
+               batch.wakeups);
+        fflush(stdout);
+
+        if (sustainable(&single)) best_single = RATES[i];
+        if (sustainable(&batch)) best_batch = RATES[i];
+    }
+
+    printf("\nSustainable edge rate (<= %.1f%% lost): single %ld/s, batched %ld/s\n",
+           LOSS_LIMIT_PPM / 10000.0, best_single, best_batch);
+
+    gpiod_line_release(in);
+    gpiod_line_release(out);
+    gpiod_chip_close(chip);
+    return 0;
+}
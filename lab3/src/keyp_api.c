@@ -1,13 +1,13 @@
 #include "keyp_api.h"
+#include "trace_api.h"
 #include <gpiod.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
-static struct gpiod_chip *chip;
-static struct gpiod_line *cols[3];
-static struct gpiod_line *rows[4];
+static struct pin_edge cols[3];
+static struct pin_out rows[4];
 
 static const char KEYMAP[4][3] = {
     {'1','2','3'},
@@ -16,56 +16,56 @@ static const char KEYMAP[4][3] = {
     {'*','0','#'}
 };
 
-static void set_all_rows(int v) {
+// Drives row `high` to 1 and the others to 0 (or all to 1 if high < 0)
+// with one write per output group
+static void set_rows(int high) {
     for (int i = 0; i < 4; i++) {
-        gpiod_line_set_value(rows[i], v);
+        pin_stage(rows[i], high < 0 || i == high);
+    }
+    for (int i = 0; i < 4; i++) {
+        pin_commit(rows[i]);
     }
 }
 
 char keyp_scan(void) {
+    TRACE_BEGIN(TRACE_KEYP_SCAN, 0);
     // Scan each row by setting it high one at a time
     for (int r = 0; r < 4; r++) {
-        // Set all rows low first
-        set_all_rows(0);
-        // Set current row high
-        gpiod_line_set_value(rows[r], 1);
+        // Current row high, all others low
+        set_rows(r);
 
         // Small settle time
         usleep(300);
 
         // Check each column
         for (int c = 0; c < 3; c++) {
-            int v = gpiod_line_get_value(cols[c]);
+            int v = pin_edge_value(cols[c]);
             if (v == 1) {
-                set_all_rows(1);  // Reset rows
+                set_rows(-1);  // Reset rows
+                TRACE_END(TRACE_KEYP_SCAN, KEYMAP[r][c]);
                 return KEYMAP[r][c];
             }
         }
     }
-    set_all_rows(1);  // Reset all rows
+    set_rows(-1);  // Reset all rows
+    TRACE_END(TRACE_KEYP_SCAN, 0);
     return '\0';
 }
 
-void keyp_init(struct gpiod_chip *chip_arg, 
-              struct gpiod_line *c1_line, 
-              struct gpiod_line *c2_line,
-              struct gpiod_line *c3_line, 
-              struct gpiod_line *r1_line,
-              struct gpiod_line *r2_line, 
-              struct gpiod_line *r3_line,
-              struct gpiod_line *r4_line) {
-    chip = chip_arg;
-    cols[0] = c1_line;
-    cols[1] = c2_line;
-    cols[2] = c3_line;
-    rows[0] = r1_line;
-    rows[1] = r2_line;
-    rows[2] = r3_line;
-    rows[3] = r4_line;
+void keyp_init(struct pin_edge c1, struct pin_edge c2, struct pin_edge c3,
+               struct pin_out r1, struct pin_out r2,
+               struct pin_out r3, struct pin_out r4) {
+    cols[0] = c1;
+    cols[1] = c2;
+    cols[2] = c3;
+    rows[0] = r1;
+    rows[1] = r2;
+    rows[2] = r3;
+    rows[3] = r4;
 
-    set_all_rows(1);
+    set_rows(-1);
 }
 
-struct gpiod_line** keyp_get_cols(void) {
+struct pin_edge *keyp_get_cols(void) {
     return cols;
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+#define _GNU_SOURCE
+#include <gpiod.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "rt_api.h"
+#include "sample_clock_api.h"
+#include "pinmap_api.h"
+#include "dds_api.h"
+
+/*
+ * Melody player: plays an RTTTL ringtone on the buzzer.
+ *
+ * The whole melody runs from one sample clock task at DDS_TICK_HZ. Each tick
+ * advances a phase accumulator and counts down the current note; when a
+ * note ends the next increment is loaded in the same tick. No timer is
+ * reprogrammed between notes, so the tempo is exact and every pitch is
+ * within DDS_TICK_HZ / 2^32 of the note's true frequency.
+ *
+ * The ringtone is the argument if it contains a ':', else the file it
+ * names; with no argument a built-in tune is played. With -l the notes are
+ * listed (requested and produced frequency) without playing.
+ *
+ * Run: sudo ./melody [--rt] [-l] ["name:d=4,o=5,b=120:c,e,g" | file.txt]
+ */
+
+#define CHIP "/dev/gpiochip4"
+#define BUZZER_PIN 21
+#define MAX_TEXT 8192
+
+static const struct pin_desc PINS[] = {
+    { "buzzer", BUZZER_PIN, PIN_OUTPUT, 0, 0, 0 },
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
+
+static const char DEFAULT_TUNE[] =
+    "Tetris:d=4,o=5,b=160:e6,8b,8c6,8d6,16e6,16d6,8c6,8b,a,8a,8c6,e6,8d6,8c6,b,8b,8c6,"
+    "d6,e6,c6,a,2a,8p,d6,8f6,a6,8g6,8f6,e6,8e6,8c6,e6,8d6,8c6,b,8b,8c6,d6,e6,c6,a,a";
+
+static const char *NOTE_NAMES[] = {"c", "c#", "d", "d#", "e", "f", "f#", "g", "g#", "a", "a#", "b"};
+
+// Sequencer state (the tick task owns it until it stops)
+static struct pin_out buzzer;
+static struct dds_seq seq;
+static struct dds_note notes[RTTTL_MAX_NOTES];
+static int state = 0;
+static volatile sig_atomic_t stop = 0;
+static struct rt_jitter jitter;
+
+static void handle_sigint(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+// Sample clock task at DDS_TICK_HZ: one step of the sequencer, a pin
+// write only on a level change, stop after the last note or on Ctrl+C.
+// Skipped ticks are stepped over without output to keep the tempo
+static int melody_tick(void *arg, unsigned skipped) {
+    (void)arg;
+    
+    int level = skipped && dds_seq_skip(&seq, skipped) < 0 ? -1 : dds_seq_step(&seq);
+    if (level < 0 || stop) {
+        pin_write(buzzer, 0);
+        return 1;
+    }
+    if (level != state) {
+        pin_write(buzzer, level);
+        state = level;
+    }
+    return 0;
+}
+
+// Reads a ringtone from a file into buf
+static int read_text(const char *path, char *buf, size_t len) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    size_t n = fread(buf, 1, len - 1, f);
+    int err = ferror(f);
+    fclose(f);
+    if (err) {
+        errno = EIO;
+        return -1;
+    }
+    buf[n] = '\0';
+    return 0;
+}
+
+// Prints the note table with the frequency each increment really produces
+static void list_notes(int count) {
+    printf("%-4s %-6s %12s %14s %10s %8s\n",
+           "#", "note", "wanted Hz", "produced Hz", "err mHz", "ms");
+    for (int i = 0; i < count; i++) {
+        if (notes[i].freq_mhz == 0) {
+            printf("%-4d %-6s %12s %14s %10s %8u\n", i, "p", "-", "-", "-", notes[i].ms);
+            continue;
+        }
+        double wanted = notes[i].freq_mhz / 1000.0;
+        double produced = dds_actual_hz(DDS_TICK_HZ, dds_increment(DDS_TICK_HZ, notes[i].freq_mhz));
+        int midi = (int)lround(69 + 12 * log2(wanted / 440.0));
+        char name[16];
+        snprintf(name, sizeof(name), "%s%d", NOTE_NAMES[midi % 12], midi / 12 - 1);
+        printf("%-4d %-6s %12.3f %14.6f %10.4f %8u\n", i, name, wanted, produced,
+               (produced - wanted) * 1000, notes[i].ms);
+    }
+}
+
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        fprintf(stderr, "Usage: %s [--rt] [-l] [rtttl | file]\n", argv[0]);
+        return 1;
+    }
+
+    int list_only = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "l")) != -1) {
+        switch (opt) {
+        case 'l': list_only = 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [--rt] [-l] [rtttl | file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Ringtone from the argument, a file, or the built-in tune
+    static char text[MAX_TEXT];
+    const char *tune = DEFAULT_TUNE;
+    if (optind < argc) {
+        if (strchr(argv[optind], ':')) {
+            tune = argv[optind];
+        } else if (read_text(argv[optind], text, sizeof(text)) < 0) {
+            perror(argv[optind]);
+            return 1;
+        } else {
+            tune = text;
+        }
+    }
+
+    char name[64];
+    int count = rtttl_parse(tune, notes, RTTTL_MAX_NOTES, name, sizeof(name));
+    if (count < 0) {
+        fprintf(stderr, "Not a valid RTTTL ringtone (at most %d notes)\n", RTTTL_MAX_NOTES);
+        return 1;
+    }
+    long total_ms = 0;
+    for (int i = 0; i < count; i++) total_ms += notes[i].ms;
+    printf("\"%s\": %d notes, %.1f s, DDS tick %d Hz (resolution %.6f Hz)\n",
+           name, count, total_ms / 1000.0, DDS_TICK_HZ, DDS_TICK_HZ / 4294967296.0);
+    if (list_only) {
+        list_notes(count);
+        return 0;
+    }
+
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "melody", PINS, NUM_PINS) < 0) {
+        perror("pinmap_open");
+        return 1;
+    }
+    if (pinmap_out(&pm, "buzzer", &buzzer) < 0) {
+        perror("pins");
+        pinmap_close(&pm);
+        return 1;
+    }
+
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete, tone may jitter\n");
+    }
+
+    if (telemetry_open(argv[0]) < 0) {
+        fprintf(stderr, "Warning: telemetry disabled\n");
+    }
+
+    dds_seq_init(&seq, notes, count, DDS_TICK_HZ);
+
+    signal(SIGINT, handle_sigint);
+    struct sample_clock clock;
+    if (sample_clock_start(&clock, DDS_TICK_HZ, SAMPLE_CLOCK_CATCHUP, melody_tick, NULL, &jitter,
+                           telemetry_task("melody", 1000000000L / DDS_TICK_HZ)) < 0) {
+        perror("sample_clock_start");
+        pinmap_close(&pm);
+        return 1;
+    }
+    printf("Playing on pin %d (%s mode). Press Ctrl+C to stop...\n",
+           BUZZER_PIN, rt_mode_name(&rt));
+    sample_clock_join(&clock);
+
+    printf("%s after %d of %d notes (%lld ticks skipped)\n", stop ? "Stopped" : "Done",
+           seq.index < count ? seq.index + 1 : count, count, atomic_load(&clock.skipped));
+    rt_jitter_report(&jitter, "Melody tick", &rt);
+    sample_clock_report(&clock, "Melody tick");
+    telemetry_close();
+    pinmap_close(&pm);
+    return 0;
+}
@@ -0,0 +1,188 @@
+#define _GNU_SOURCE
+#include "mixer_api.h"
+#include "wav_api.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int mixer_clip_load(struct mixer_clip *c, const char *path) {
+    memset(c, 0, sizeof(*c));
+    struct wav w;
+    if (wav_open(&w, path) < 0) {
+        return -1;
+    }
+    c->samples = malloc(sizeof(int16_t) * (w.num_frames ? w.num_frames : 1));
+    if (!c->samples) {
+        wav_close(&w);
+        return -1;
+    }
+    c->len = wav_read(&w, 0, c->samples, w.num_frames);
+    c->sample_rate = w.sample_rate;
+    const char *base = strrchr(path, '/');
+    snprintf(c->name, sizeof(c->name), "%s", base ? base + 1 : path);
+    wav_close(&w);
+    return 0;
+}
+
+void mixer_clip_free(struct mixer_clip *c) {
+    free(c->samples);
+    memset(c, 0, sizeof(*c));
+}
+
+void mixer_init(struct mixer *m, const struct mixer_clip *clips, int num_clips) {
+    memset(m, 0, sizeof(*m));
+    m->clips = clips;
+    m->num_clips = num_clips;
+    atomic_init(&m->queue_head, 0);
+    atomic_init(&m->queue_tail, 0);
+    atomic_init(&m->playing, 0);
+}
+
+int mixer_idle(struct mixer *m) {
+    return atomic_load(&m->queue_head) == atomic_load(&m->queue_tail) &&
+           atomic_load(&m->playing) == 0;
+}
+
+int mixer_trigger(struct mixer *m, int clip, int16_t gain) {
+    unsigned head = atomic_load_explicit(&m->queue_head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&m->queue_tail, memory_order_acquire) == MIXER_QUEUE) {
+        return -1;
+    }
+    m->queue[head % MIXER_QUEUE] = (struct mixer_trigger){ .clip = clip, .gain = gain };
+    atomic_store_explicit(&m->queue_head, head + 1, memory_order_release);
+    return 0;
+}
+
+// Starts a voice: a free one, else the one closest to its end
+static void start_voice(struct mixer *m, const struct mixer_clip *clip, int16_t gain) {
+    struct mixer_voice *v = NULL;
+    size_t least_left = (size_t)-1;
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        struct mixer_voice *cand = &m->voices[i];
+        if (!cand->clip) {
+            v = cand;
+            break;
+        }
+        size_t left = cand->clip->len - cand->pos;
+        if (left < least_left) {
+            least_left = left;
+            v = cand;
+        }
+    }
+    if (v->clip) {
+        m->stolen++;
+    }
+    v->clip = clip;
+    v->pos = 0;
+    v->gain = gain;
+    m->triggers++;
+}
+
+// Applies the triggers queued since the last block
+static void apply_triggers(struct mixer *m) {
+    unsigned tail = atomic_load_explicit(&m->queue_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&m->queue_head, memory_order_acquire);
+    for (; tail != head; tail++) {
+        struct mixer_trigger t = m->queue[tail % MIXER_QUEUE];
+        if (t.clip < 0) {
+            for (int i = 0; i < MIXER_VOICES; i++) m->voices[i].clip = NULL;
+        } else if (t.clip < m->num_clips && m->clips[t.clip].len) {
+            start_voice(m, &m->clips[t.clip], t.gain);
+        }
+    }
+    atomic_store_explicit(&m->queue_tail, tail, memory_order_release);
+}
+
+void mixer_add_scalar(int16_t *acc, const int16_t *src, size_t n, int16_t gain) {
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = acc[i] + ((src[i] * gain) >> 15);
+        acc[i] = (int16_t)(v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : v);
+    }
+}
+
+void mixer_add(int16_t *acc, const int16_t *src, size_t n, int16_t gain) {
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    // vqdmulh: (2 * src * gain) >> 16 == (src * gain) >> 15
+    int16x8_t g = vdupq_n_s16(gain);
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t s = vqdmulhq_s16(vld1q_s16(src + i), g);
+        vst1q_s16(acc + i, vqaddq_s16(vld1q_s16(acc + i), s));
+    }
+#elif defined(__SSE2__)
+    // (src * gain) >> 15 from the high and low product halves
+    __m128i g = _mm_set1_epi16(gain);
+    for (; i + 8 <= n; i += 8) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i hi = _mm_mulhi_epi16(s, g);
+        __m128i lo = _mm_mullo_epi16(s, g);
+        s = _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        _mm_storeu_si128((__m128i *)(acc + i), _mm_adds_epi16(a, s));
+    }
+#endif
+    mixer_add_scalar(acc + i, src + i, n - i, gain);
+}
+
+const char *mixer_simd_name(void) {
+#if defined(__ARM_NEON)
+    return "neon";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void mixer_mix(struct mixer *m, int16_t *out, size_t count) {
+    long long start = now_ns();
+    int active = 0;
+
+    memset(out, 0, sizeof(int16_t) * count);
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        struct mixer_voice *v = &m->voices[i];
+        if (!v->clip) {
+            continue;
+        }
+        size_t n = v->clip->len - v->pos;
+        if (n > count) n = count;
+        mixer_add(out, v->clip->samples + v->pos, n, v->gain);
+        v->pos += n;
+        m->voice_samples += n;
+        active++;
+        if (v->pos == v->clip->len) {
+            v->clip = NULL;
+        }
+    }
+
+    int playing = 0;
+    for (int i = 0; i < MIXER_VOICES; i++) playing += m->voices[i].clip != NULL;
+    atomic_store_explicit(&m->playing, playing, memory_order_relaxed);
+    if (active > m->peak_voices) m->peak_voices = active;
+    m->frames += count;
+    if (active) {
+        m->mix_ns += now_ns() - start;  // Silence is not mixing
+    }
+}
+
+size_t mixer_decode(void *arg, size_t frame, int16_t *out, size_t count) {
+    (void)frame;
+    struct mixer *m = arg;
+    apply_triggers(m);
+    mixer_mix(m, out, count);
+    return count;
+}
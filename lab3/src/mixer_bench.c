@@ -0,0 +1,134 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdint.h>
+
+#include "mixer_api.h"
+#include "audio_pipe_api.h"
+
+/*
+ * Mixer cost benchmark.
+ *
+ * Checks that the vectorized mixer_add() matches the scalar reference bit
+ * for bit (including saturation), then mixes 1, 2, 4 and 8 voices of the
+ * given clips in AUDIO_PIPE_BLOCK_FRAMES blocks, as the decoder thread
+ * does, and reports ns per sample per voice for both.
+ *
+ * Run: ./mixer_bench [-t run_ms] [clip.wav ...]
+ * (defaults to Chipi.wav and "Vine Boom.wav" in the current directory)
+ */
+
+#define RUN_MS 500
+#define CHECK_SAMPLES 100003
+
+static const int VOICE_COUNTS[] = {1, 2, 4, 8};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Compares both paths on random data, loud enough to saturate
+static int check_simd(void) {
+    int16_t *src = malloc(sizeof(int16_t) * CHECK_SAMPLES);
+    int16_t *a = malloc(sizeof(int16_t) * CHECK_SAMPLES);
+    int16_t *b = malloc(sizeof(int16_t) * CHECK_SAMPLES);
+    if (!src || !a || !b) {
+        free(src); free(a); free(b);
+        return -1;
+    }
+    srand(1);
+    int mismatches = 0;
+    static const int16_t gains[] = {0, 1, 8192, 16383, MIXER_GAIN_UNITY};
+    for (int g = 0; g < 5; g++) {
+        for (int i = 0; i < CHECK_SAMPLES; i++) {
+            src[i] = (int16_t)(rand() & 0xFFFF);
+            a[i] = b[i] = (int16_t)(rand() & 0xFFFF);
+        }
+        mixer_add(a, src, CHECK_SAMPLES, gains[g]);
+        mixer_add_scalar(b, src, CHECK_SAMPLES, gains[g]);
+        mismatches += memcmp(a, b, sizeof(int16_t) * CHECK_SAMPLES) != 0;
+    }
+    free(src); free(a); free(b);
+    return mismatches;
+}
+
+// Mixes `voices` voices, using `add` for each, for about run_ms
+static double bench(const int16_t *const *srcs, const size_t *lens, int voices,
+                    void (*add)(int16_t *, const int16_t *, size_t, int16_t), int run_ms) {
+    static int16_t out[AUDIO_PIPE_BLOCK_FRAMES];
+    size_t pos[MIXER_VOICES] = {0};
+    uint64_t samples = 0;
+    long long start = now_ns(), elapsed;
+
+    do {
+        for (int rep = 0; rep < 64; rep++) {
+            memset(out, 0, sizeof(out));
+            for (int v = 0; v < voices; v++) {
+                size_t n = lens[v] - pos[v];
+                if (n > AUDIO_PIPE_BLOCK_FRAMES) n = AUDIO_PIPE_BLOCK_FRAMES;
+                add(out, srcs[v] + pos[v], n, MIXER_GAIN_UNITY / 2);
+                pos[v] = pos[v] + n == lens[v] ? 0 : pos[v] + n;
+                samples += n;
+            }
+        }
+        elapsed = now_ns() - start;
+    } while (elapsed < run_ms * 1000000LL);
+    return (double)elapsed / samples;
+}
+
+int main(int argc, char **argv) {
+    int run_ms = RUN_MS;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:")) != -1) {
+        switch (opt) {
+        case 't': run_ms = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-t run_ms] [clip.wav ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (run_ms <= 0) run_ms = RUN_MS;
+
+    static const char *default_files[] = {"Chipi.wav", "Vine Boom.wav"};
+    const char *const *files = optind < argc ? (const char *const *)argv + optind : default_files;
+    int num_files = optind < argc ? argc - optind : 2;
+
+    struct mixer_clip clips[MIXER_VOICES];
+    if (num_files > MIXER_VOICES) num_files = MIXER_VOICES;
+    for (int i = 0; i < num_files; i++) {
+        if (mixer_clip_load(&clips[i], files[i]) < 0 || clips[i].len == 0) {
+            perror(files[i]);
+            return 1;
+        }
+    }
+
+    int mismatches = check_simd();
+    printf("mixer_add (%s) vs scalar: %s\n", mixer_simd_name(),
+           mismatches == 0 ? "identical" : "MISMATCH");
+
+    // Voices take the clips in turn, each starting at a different point
+    const int16_t *srcs[MIXER_VOICES];
+    size_t lens[MIXER_VOICES];
+    for (int v = 0; v < MIXER_VOICES; v++) {
+        const struct mixer_clip *c = &clips[v % num_files];
+        size_t offset = c->len / MIXER_VOICES * (size_t)v;
+        srcs[v] = c->samples + offset;
+        lens[v] = c->len - offset;
+    }
+
+    printf("%6s %14s %14s\n", "voices", "simd ns/s/v", "scalar ns/s/v");
+    for (size_t i = 0; i < sizeof(VOICE_COUNTS) / sizeof(VOICE_COUNTS[0]); i++) {
+        int voices = VOICE_COUNTS[i];
+        double simd = bench(srcs, lens, voices, mixer_add, run_ms);
+        double scalar = bench(srcs, lens, voices, mixer_add_scalar, run_ms);
+        printf("%6d %14.3f %14.3f\n", voices, simd, scalar);
+    }
+
+    for (int i = 0; i < num_files; i++) mixer_clip_free(&clips[i]);
+    return mismatches != 0;
+}
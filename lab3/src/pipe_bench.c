@@ -0,0 +1,220 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "rt_api.h"
+#include "periodic_api.h"
+#include "audio_pipe_api.h"
+
+/*
+ * Decoder/output pipeline benchmark with an artificially slow decoder.
+ *
+ * The decoder produces a sine in blocks of AUDIO_PIPE_BLOCK_FRAMES and
+ * spins for a configurable time per block, plus a longer spike every few
+ * blocks (what a page fault, a decompressor or a resampler might cost).
+ * Each scenario is played at 48 kHz twice:
+ *
+ *   inline    the sample task decodes a block itself when it runs out,
+ *             as chipi_chapa did before the pipeline
+ *   pipeline  a decoder thread fills the audio_pipe ring and the sample
+ *             task only pops
+ *
+ * and reports, per run:
+ *
+ *   overrun   sample deadlines skipped because a tick ran late (inline
+ *             stalls show up here)
+ *   max us    worst lateness of a tick
+ *   underrun  ticks with no decoded sample ready, and in how many stretches
+ *             (pipeline stalls longer than the ring show up here)
+ *
+ * Nothing touches a GPIO, so it runs on any Linux host.
+ *
+ * Run: ./pipe_bench [-t run_ms] [--rt] [--rt-prio=N] [--rt-cpu=N]
+ */
+
+#define RATE 48000
+#define RUN_MS 2000
+#define TONE_HZ 440.0
+
+struct scenario {
+    const char *name;
+    long block_us;      // Decode cost of every block
+    long spike_us;      // Extra cost of every spike_every'th block
+    int spike_every;
+};
+
+// A block of 256 frames lasts 5333 us and the ring holds 85 ms
+static const struct scenario SCENARIOS[] = {
+    {"fast", 0, 0, 0},
+    {"2ms/block", 2000, 0, 0},
+    {"20ms spikes", 200, 20000, 16},
+    {"60ms spikes", 200, 60000, 16},
+    {"150ms spikes", 200, 150000, 64},
+    {"6ms/block", 6000, 0, 0},
+};
+static const int NUM_SCENARIOS = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+struct decoder {
+    const struct scenario *s;
+    size_t total_frames;
+    long blocks;
+};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// The slow decoder: a sine, then burn CPU for the scenario's cost
+static size_t slow_decode(void *arg, size_t frame, int16_t *out, size_t count) {
+    struct decoder *d = arg;
+    long long start = now_ns();
+    if (frame >= d->total_frames) {
+        return 0;
+    }
+    if (count > d->total_frames - frame) {
+        count = d->total_frames - frame;
+    }
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (int16_t)(16384 * sin(2 * M_PI * TONE_HZ * (double)(frame + i) / RATE));
+    }
+
+    long cost_us = d->s->block_us;
+    if (d->s->spike_every && ++d->blocks % d->s->spike_every == 0) {
+        cost_us += d->s->spike_us;
+    }
+    while (now_ns() - start < cost_us * 1000LL) {
+    }
+    return count;
+}
+
+// Inline design: the sample task owns these
+static struct decoder inline_dec;
+static int16_t inline_block[AUDIO_PIPE_BLOCK_FRAMES];
+static size_t inline_frame, inline_len, inline_pos;
+
+// Pipeline design
+static struct audio_pipe pipeline;
+
+static volatile int16_t sink;
+
+static int inline_tick(void *arg) {
+    (void)arg;
+    if (inline_pos == inline_len) {
+        inline_len = slow_decode(&inline_dec, inline_frame, inline_block, AUDIO_PIPE_BLOCK_FRAMES);
+        if (inline_len == 0) {
+            return 1;
+        }
+        inline_frame += inline_len;
+        inline_pos = 0;
+    }
+    sink = inline_block[inline_pos++];
+    return 0;
+}
+
+static int pipeline_tick(void *arg) {
+    (void)arg;
+    int16_t sample;
+    int ret = audio_pipe_pop(&pipeline, &sample);
+    if (ret > 0) {
+        sink = sample;
+    }
+    return ret == 0;
+}
+
+struct bench_result {
+    long ticks;
+    long overruns;
+    long underruns;
+    long underrun_runs;
+    struct rt_jitter jitter;
+};
+
+static int run(const struct scenario *s, int pipelined, int run_ms, struct bench_result *r) {
+    struct decoder dec = { .s = s, .total_frames = (size_t)RATE * run_ms / 1000 };
+    struct periodic_task task;
+
+    if (pipelined) {
+        if (audio_pipe_start(&pipeline, slow_decode, &dec) < 0) {
+            perror("audio_pipe_start");
+            return -1;
+        }
+    } else {
+        inline_dec = dec;
+        inline_frame = inline_len = inline_pos = 0;
+    }
+
+    if (periodic_start(&task, 1000000000L / RATE, pipelined ? pipeline_tick : inline_tick,
+                       NULL, &r->jitter, NULL) < 0) {
+        perror("periodic_start");
+        if (pipelined) audio_pipe_stop(&pipeline);
+        return -1;
+    }
+    periodic_join(&task);
+
+    r->ticks = atomic_load(&task.ticks);
+    r->overruns = atomic_load(&task.overruns);
+    if (pipelined) {
+        audio_pipe_stop(&pipeline);
+        r->underruns = atomic_load(&pipeline.underruns);
+        r->underrun_runs = atomic_load(&pipeline.underrun_runs);
+    }
+    return 0;
+}
+
+static void print_row(const char *name, const struct bench_result *r) {
+    printf(" %-8s %8ld %8ld %9.1f %8ld %6ld", name, r->ticks, r->overruns,
+           r->jitter.max_ns / 1e3, r->underruns, r->underrun_runs);
+}
+
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        return 1;
+    }
+
+    int run_ms = RUN_MS;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:")) != -1) {
+        switch (opt) {
+        case 't': run_ms = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-t run_ms] [--rt] [--rt-prio=N] [--rt-cpu=N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (run_ms <= 0) {
+        run_ms = RUN_MS;
+    }
+
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete\n");
+    }
+
+    printf("Pipeline benchmark: %s mode, %d Hz, %d ms per run, %d-frame blocks, "
+           "%d-block ring\n\n", rt_mode_name(&rt), RATE, run_ms,
+           AUDIO_PIPE_BLOCK_FRAMES, AUDIO_PIPE_BLOCKS);
+    printf("%-13s | %-8s %8s %8s %9s %8s %6s\n",
+           "decoder", "design", "ticks", "overrun", "max us", "underrun", "runs");
+
+    for (int i = 0; i < NUM_SCENARIOS; i++) {
+        struct bench_result in = {0}, pipe = {0};
+        if (run(&SCENARIOS[i], 0, run_ms, &in) < 0 ||
+            run(&SCENARIOS[i], 1, run_ms, &pipe) < 0) {
+            break;
+        }
+        printf("%-13s |", SCENARIOS[i].name);
+        print_row("inline", &in);
+        printf("\n%-13s |", "");
+        print_row("pipeline", &pipe);
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
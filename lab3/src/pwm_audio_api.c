@@ -0,0 +1,132 @@
+#define _GNU_SOURCE
+#include "pwm_audio_api.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Writes a value to a sysfs attribute (truncating it when it is a plain file)
+static int attr_write(const char *dir, const char *name, long value) {
+    char path[128], buf[24];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    int len = snprintf(buf, sizeof(buf), "%ld", value);
+
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    int ret = (int)write(fd, buf, (size_t)len);
+    if (ret >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        ret = ftruncate(fd, len);
+    }
+    int err = errno;
+    close(fd);
+    errno = err;
+    return ret < 0 ? -1 : 0;
+}
+
+// Formats a non-negative value without stdio; returns the length
+static int format_ul(char *buf, unsigned long v) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    for (int i = 0; i < n; i++) buf[i] = tmp[n - 1 - i];
+    return n;
+}
+
+static int write_duty(struct pwm_audio *p, long duty_ns) {
+    char buf[20];
+    int len = format_ul(buf, (unsigned long)duty_ns);
+    if (pwrite(p->duty_fd, buf, (size_t)len, 0) != len ||
+        (p->regular && ftruncate(p->duty_fd, len) < 0)) {
+        p->errors++;
+        return -1;
+    }
+    p->duty_ns = duty_ns;
+    p->writes++;
+    return 0;
+}
+
+int pwm_audio_open(struct pwm_audio *p, const char *chip_dir, int channel, long carrier_hz) {
+    memset(p, 0, sizeof(*p));
+    p->duty_fd = -1;
+    if (carrier_hz <= 0 || carrier_hz > 1000000000L) {
+        errno = EINVAL;
+        return -1;
+    }
+    snprintf(p->chip_dir, sizeof(p->chip_dir), "%s", chip_dir);
+    snprintf(p->chan_dir, sizeof(p->chan_dir), "%s/pwm%d", chip_dir, channel);
+    p->channel = channel;
+    p->period_ns = 1000000000L / carrier_hz;
+
+    // Export the channel (skip if already exported) and wait for udev to
+    // hand over the attributes
+    char path[128];
+    snprintf(path, sizeof(path), "%s/duty_cycle", p->chan_dir);
+    if (access(p->chan_dir, F_OK) != 0) {
+        if (attr_write(chip_dir, "export", channel) < 0) {
+            return -1;
+        }
+        p->exported = 1;
+    }
+    for (int waited = 0; access(path, W_OK) != 0; waited += 10) {
+        if (waited >= PWM_AUDIO_EXPORT_WAIT_MS) {
+            pwm_audio_close(p);
+            return -1;
+        }
+        usleep(10000);
+    }
+
+    // Disable -> duty 0 (a period shorter than the old duty is refused)
+    // -> period -> open duty_cycle -> silence -> enable
+    attr_write(p->chan_dir, "enable", 0);
+    if (attr_write(p->chan_dir, "duty_cycle", 0) < 0 ||
+        attr_write(p->chan_dir, "period", p->period_ns) < 0) {
+        pwm_audio_close(p);
+        return -1;
+    }
+
+    p->duty_fd = open(path, O_WRONLY | O_CLOEXEC);
+    struct stat st;
+    if (p->duty_fd < 0 || fstat(p->duty_fd, &st) < 0) {
+        pwm_audio_close(p);
+        return -1;
+    }
+    p->regular = S_ISREG(st.st_mode);
+
+    if (write_duty(p, p->period_ns / 2) < 0 ||
+        attr_write(p->chan_dir, "enable", 1) < 0) {
+        pwm_audio_close(p);
+        return -1;
+    }
+    p->writes = 0;
+    return 0;
+}
+
+int pwm_audio_write(struct pwm_audio *p, int16_t sample) {
+    long duty_ns = (long)(((int64_t)sample + 32768) * p->period_ns >> 16);
+    if (duty_ns == p->duty_ns) {
+        p->skipped++;
+        return 0;
+    }
+    return write_duty(p, duty_ns);
+}
+
+void pwm_audio_close(struct pwm_audio *p) {
+    if (p->duty_fd >= 0) {
+        close(p->duty_fd);
+        p->duty_fd = -1;
+    }
+    attr_write(p->chan_dir, "enable", 0);
+    if (p->exported) {
+        attr_write(p->chip_dir, "unexport", p->channel);
+        p->exported = 0;
+    }
+}
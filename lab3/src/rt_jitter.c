@@ -0,0 +1,124 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#include "rt_api.h"
+
+/*
+ * Timer jitter report: standard vs real-time mode.
+ *
+ * Runs the same SIGRTMIN POSIX timer the lab programs use (chipi_chapa,
+ * seven_segment, buzzer_interrupt), first at default priority and then
+ * after rt_apply(), and prints the lateness of every tick for both runs.
+ * No GPIO is touched, so it runs anywhere; run it while the system is
+ * loaded (e.g. `stress-ng --cpu 4` or a kernel build) to see the difference.
+ *
+ * Run: sudo ./rt_jitter [period_us] [seconds] [--rt-prio=N] [--rt-cpu=N]
+ *   period_us  default 125 (8 kHz audio); use 2000 for the 7-segment mux
+ */
+
+#define DEFAULT_PERIOD_US 125
+#define DEFAULT_SECONDS 5
+
+static struct rt_jitter jitter;
+
+static void tick_handler(int sig, siginfo_t *si, void *uc) {
+    (void)sig;
+    (void)si;
+    (void)uc;
+    rt_jitter_tick(&jitter);
+}
+
+static int run(timer_t timerid, long period_us, int seconds) {
+    struct itimerspec its;
+    its.it_interval.tv_sec = period_us / 1000000;
+    its.it_interval.tv_nsec = (period_us % 1000000) * 1000;
+    its.it_value = its.it_interval;
+
+    rt_jitter_start(&jitter, period_us * 1000LL);
+    if (timer_settime(timerid, 0, &its, NULL) == -1) {
+        perror("timer_settime");
+        return -1;
+    }
+
+    // Every tick interrupts the sleep; keep sleeping until the deadline
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    end.tv_sec += seconds;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &end, NULL) != 0) {
+    }
+
+    struct itimerspec off = {0};
+    timer_settime(timerid, 0, &off, NULL);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        fprintf(stderr, "Usage: %s [period_us] [seconds] [--rt-prio=N] [--rt-cpu=N]\n", argv[0]);
+        return 1;
+    }
+
+    long period_us = argc > 1 ? atol(argv[1]) : DEFAULT_PERIOD_US;
+    int seconds = argc > 2 ? atoi(argv[2]) : DEFAULT_SECONDS;
+    if (period_us <= 0 || seconds <= 0) {
+        fprintf(stderr, "Usage: %s [period_us] [seconds] [--rt-prio=N] [--rt-cpu=N]\n", argv[0]);
+        return 1;
+    }
+
+    struct sigaction sa;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sa.sa_sigaction = tick_handler;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGRTMIN, &sa, NULL) == -1) {
+        perror("sigaction");
+        return 1;
+    }
+
+    timer_t timerid;
+    struct sigevent sev;
+    sev.sigev_notify = SIGEV_SIGNAL;
+    sev.sigev_signo = SIGRTMIN;
+    sev.sigev_value.sival_ptr = &timerid;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &timerid) == -1) {
+        perror("timer_create");
+        return 1;
+    }
+
+    printf("Timer jitter: %ld us period, %d s per mode\n", period_us, seconds);
+
+    // Standard mode first: RT mode cannot be left once memory is locked
+    struct rt_config standard = rt;
+    standard.enabled = 0;
+    if (run(timerid, period_us, seconds) < 0) {
+        return 1;
+    }
+    struct rt_jitter standard_result = jitter;
+
+    rt.enabled = 1;
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete, comparison is not meaningful\n");
+    }
+    if (run(timerid, period_us, seconds) < 0) {
+        return 1;
+    }
+    struct rt_jitter rt_result = jitter;
+
+    rt_jitter_report(&standard_result, "Timer", &standard);
+    rt_jitter_report(&rt_result, "Timer", &rt);
+
+    printf("\n%10s %10s %10s %10s %8s\n", "mode", "mean us", "max us", "ticks", "missed");
+    printf("%10s %10.1f %10.1f %10ld %8ld\n", rt_mode_name(&standard),
+           standard_result.count ? (double)standard_result.sum_ns / standard_result.count / 1e3 : 0.0,
+           standard_result.max_ns / 1e3, standard_result.count, standard_result.missed);
+    printf("%10s %10.1f %10.1f %10ld %8ld\n", rt_mode_name(&rt),
+           rt_result.count ? (double)rt_result.sum_ns / rt_result.count / 1e3 : 0.0,
+           rt_result.max_ns / 1e3, rt_result.count, rt_result.missed);
+
+    timer_delete(timerid);
+    return 0;
+}
@@ -0,0 +1,180 @@
+#define _GNU_SOURCE
+#include "sample_clock_api.h"
+#include "trace_api.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/prctl.h>
+
+#define NSEC_PER_SEC 1000000000LL
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+// Moves a deadline n periods on, carrying the fractional nanoseconds
+static void advance(const struct sample_clock *c, long long *next, uint64_t *frac, uint64_t n) {
+    *next += (long long)n * c->period_ns;
+    *frac += n * c->period_rem;
+    *next += (long long)(*frac / c->rate_hz);
+    *frac %= c->rate_hz;
+}
+
+static void *runner(void *arg) {
+    struct sample_clock *c = arg;
+
+    // Exact wake-ups, as in periodic_api
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    long long next = c->start_ns;
+    uint64_t frac = 0;
+    advance(c, &next, &frac, 1);
+    long long prev_wake = 0;
+    unsigned skipped = 0;
+
+    if (c->jitter) {
+        rt_jitter_start(c->jitter, c->period_ns);
+    }
+
+    while (!atomic_load_explicit(&c->stop, memory_order_relaxed)) {
+        long long wake = now_ns();
+        if (wake < next) {
+            struct timespec deadline = {
+                .tv_sec = next / NSEC_PER_SEC,
+                .tv_nsec = next % NSEC_PER_SEC,
+            };
+            if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+                continue;
+            }
+            wake = now_ns();
+        } else if (prev_wake) {
+            // Deadline already passed when the last tick finished
+            atomic_fetch_add_explicit(&c->caught_up, 1, memory_order_relaxed);
+        }
+
+        long long late = wake - next;
+        if (c->jitter) {
+            rt_jitter_record(c->jitter, late);
+        }
+        atomic_store_explicit(&c->late_ns, late, memory_order_relaxed);
+        atomic_store_explicit(&c->last_ns, wake, memory_order_relaxed);
+        if (late > atomic_load_explicit(&c->late_max_ns, memory_order_relaxed)) {
+            atomic_store_explicit(&c->late_max_ns, late, memory_order_relaxed);
+        }
+
+        TRACE_BEGIN(TRACE_TIMER_TICK, skipped);
+        int done = c->fn(c->arg, skipped);
+        TRACE_END(TRACE_TIMER_TICK, done);
+        long long now = now_ns();
+        atomic_fetch_add_explicit(&c->ticks, 1, memory_order_relaxed);
+        skipped = 0;
+
+        if (c->telemetry) {
+            long long error = prev_wake ? (wake - prev_wake) - c->period_ns : 0;
+            telemetry_tick(c->telemetry, late, error, now - wake);
+        }
+        prev_wake = wake;
+
+        if (done) {
+            break;
+        }
+
+        // Too far behind to catch up: skip every deadline that has passed
+        // and tell the next tick, which is due in the future again
+        advance(c, &next, &frac, 1);
+        if (now >= next) {
+            uint64_t behind = (uint64_t)(now - next) * c->rate_hz / NSEC_PER_SEC + 1;
+            if (behind > c->max_catchup) {
+                advance(c, &next, &frac, behind);
+                skipped = behind > UINT32_MAX ? UINT32_MAX : (unsigned)behind;
+                atomic_fetch_add_explicit(&c->skipped, (long long)behind, memory_order_relaxed);
+                telemetry_overrun(c->telemetry, (long long)behind);
+                if (c->jitter) {
+                    c->jitter->missed += (long)behind;
+                }
+            }
+        }
+    }
+
+    atomic_store(&c->finished, 1);
+    return NULL;
+}
+
+int sample_clock_start(struct sample_clock *c, uint32_t rate_hz, unsigned max_catchup,
+                       sample_clock_fn fn, void *arg, struct rt_jitter *jitter,
+                       struct telemetry_task *telemetry) {
+    if (rate_hz == 0 || !fn) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    c->rate_hz = rate_hz;
+    c->period_ns = NSEC_PER_SEC / rate_hz;
+    c->period_rem = (uint32_t)(NSEC_PER_SEC % rate_hz);
+    c->max_catchup = max_catchup;
+    c->fn = fn;
+    c->arg = arg;
+    c->jitter = jitter;
+    c->telemetry = telemetry;
+    atomic_init(&c->stop, 0);
+    atomic_init(&c->finished, 0);
+    atomic_init(&c->ticks, 0);
+    atomic_init(&c->caught_up, 0);
+    atomic_init(&c->skipped, 0);
+    atomic_init(&c->late_ns, 0);
+    atomic_init(&c->late_max_ns, 0);
+    atomic_init(&c->last_ns, 0);
+    c->start_ns = now_ns();
+
+    // Signals stay on the caller's thread, as with periodic_start()
+    sigset_t all, old_mask;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old_mask);
+    int ret = pthread_create(&c->thread, NULL, runner, c);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    if (ret != 0) {
+        errno = ret;
+        return -1;
+    }
+    return 0;
+}
+
+void sample_clock_stop(struct sample_clock *c) {
+    atomic_store(&c->stop, 1);
+    pthread_join(c->thread, NULL);
+}
+
+void sample_clock_join(struct sample_clock *c) {
+    pthread_join(c->thread, NULL);
+}
+
+int sample_clock_finished(struct sample_clock *c) {
+    return atomic_load(&c->finished);
+}
+
+void sample_clock_report(const struct sample_clock *c, const char *label) {
+    long long ticks = atomic_load(&c->ticks);
+    long long skipped = atomic_load(&c->skipped);
+    long long last = atomic_load(&c->last_ns);
+    double exact_ns = (double)NSEC_PER_SEC / c->rate_hz;
+
+    printf("\n%s clock: %u Hz (period %.3f ns), %lld ticks, %lld caught up, %lld skipped\n",
+           label, c->rate_hz, exact_ns, ticks, atomic_load(&c->caught_up), skipped);
+    if (ticks == 0) {
+        return;
+    }
+
+    // Position: tick index reached vs the ticks due by the last wake-up
+    double due = (double)(last - c->start_ns) / exact_ns;
+    printf("  last tick %.1f us late (worst %.1f us); position %+.1f ticks against "
+           "the time elapsed\n",
+           atomic_load(&c->late_ns) / 1e3, atomic_load(&c->late_max_ns) / 1e3,
+           (double)(ticks + skipped) - due);
+    printf("  a %lld ns period would have drifted %+.3f ms (%+.1f ppm) over these %lld ticks\n",
+           c->period_ns, ((double)c->period_ns - exact_ns) * (double)(ticks + skipped) / 1e6,
+           ((double)c->period_ns - exact_ns) / exact_ns * 1e6, ticks + skipped);
+    fflush(stdout);
+}
@@ -4,27 +4,29 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include "pinmap_api.h"
+
 #define CHIP "/dev/gpiochip4"
 #define INPUT_PIN 21
+#define MAX_EVENTS PINMAP_EVENT_BUFFER  // Edge events pulled per wake-up
 
-int main(void) {
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip) {
-        perror("gpiod_chip_open");
-        return 1;
-    }
+static const struct pin_desc PINS[] = {
+    { "input", INPUT_PIN, PIN_EDGE_RISING, 0, 0, 0 },
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
 
+int main(void) {
     // Set up GPIO 21 as input with rising edge detection
-    struct gpiod_line *input = gpiod_chip_get_line(chip, INPUT_PIN);
-    if (!input) {
-        perror("gpiod_chip_get_line");
-        gpiod_chip_close(chip);
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "input", PINS, NUM_PINS) < 0) {
+        perror("pinmap_open");
         return 1;
     }
-    
-    if (gpiod_line_request_rising_edge_events(input, "input") < 0) {
-        perror("gpiod_line_request_rising_edge_events");
-        gpiod_chip_close(chip);
+
+    struct pin_edge input;
+    if (pinmap_edge(&pm, "input", &input) < 0) {
+        perror("pinmap_edge");
+        pinmap_close(&pm);
         return 1;
     }
     
@@ -35,26 +37,34 @@ int main(void) {
 
     while (1) {
         // Wait for rising edge event
-        int ret = gpiod_line_event_wait(input, NULL);
+        int ret = pin_edge_wait(input, NULL);
         if (ret < 0) {
-            perror("gpiod_line_event_wait");
+            perror("pin_edge_wait");
             break;
         }
         
         if (ret > 0) {
-            struct gpiod_line_event event;
-            if (gpiod_line_event_read(input, &event) == 0) {
-                if (event.event_type == GPIOD_LINE_EVENT_RISING_EDGE) {
-                    counter++;
-                    printf("\rCount: %d", counter);
-                    fflush(stdout);
+            struct pin_event events[MAX_EVENTS];
+            int n = pin_edge_read(input, events, MAX_EVENTS);
+            if (n < 0) {
+                perror("pin_edge_read");
+                break;
+            }
+            int rising = 0;
+            for (int i = 0; i < n; i++) {
+                if (events[i].type == PIN_EVENT_RISING) {
+                    rising++;
                 }
             }
+            if (rising > 0) {
+                counter += rising;
+                printf("\rCount: %d", counter);
+                fflush(stdout);
+            }
         }
     }
 
     printf("\n");
-    gpiod_line_release(input);
-    gpiod_chip_close(chip);
+    pinmap_close(&pm);
     return 0;
 }
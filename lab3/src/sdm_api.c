@@ -0,0 +1,15 @@
+#include "sdm_api.h"
+#include <string.h>
+
+void sdm_init(struct sdm *m, enum sdm_order order) {
+    memset(m, 0, sizeof(*m));
+    m->order = order;
+}
+
+const char *sdm_name(enum sdm_order order) {
+    switch (order) {
+    case SDM_ORDER1: return "1st";
+    case SDM_ORDER2: return "2nd";
+    default: return "clip";
+    }
+}
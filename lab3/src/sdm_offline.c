@@ -0,0 +1,200 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "sdm_api.h"
+#include "wav_api.h"
+
+/*
+ * Offline sigma-delta check: runs a WAV file through the same modulator
+ * and interpolation as chipi_chapa, on the host, without GPIO.
+ *
+ * For the clipper and both sigma-delta orders it reconstructs audio from
+ * the bitstream with a low-pass FIR (what the RC filter and speaker do on
+ * the board), decimates back to the file's rate and prints the in-band SNR
+ * against the input through the same filter, after fitting the gain. With
+ * -o it also writes the bitstream of the -m order to a file, packed 8 bits
+ * per byte, MSB first.
+ *
+ * Run: ./sdm_offline [-r osr] [-m order] [-o out.pdm] file.wav
+ */
+
+#define DEFAULT_OSR 8
+#define FIR_TAPS_PER_OSR 32     // Filter length in samples of the original rate
+#define BAND_EDGE 0.45          // Pass band as a fraction of the original rate
+
+// Runs the modulator over the whole file with linear interpolation. The
+// input is the file converted to Q15 mono, as chipi_chapa plays it
+static void modulate(const int16_t *in, size_t frames, int osr, enum sdm_order order,
+                     uint8_t *bits) {
+    struct sdm m;
+    sdm_init(&m, order);
+    size_t k = 0;
+    for (size_t n = 0; n < frames; n++) {
+        int32_t x0 = in[n];
+        int32_t x1 = n + 1 < frames ? in[n + 1] : x0;
+        for (int j = 0; j < osr; j++) {
+            bits[k++] = (uint8_t)sdm_step(&m, x0 + (x1 - x0) * j / osr);
+        }
+    }
+}
+
+// Blackman-windowed sinc low-pass, unity gain at DC
+static double *make_fir(int osr, int *num_taps) {
+    int taps = FIR_TAPS_PER_OSR * osr + 1;
+    double *h = malloc(sizeof(double) * (size_t)taps);
+    if (!h) {
+        return NULL;
+    }
+    double fc = BAND_EDGE / osr / 2.0;     // Cycles per oversampled tick
+    double sum = 0;
+    for (int i = 0; i < taps; i++) {
+        double t = i - (taps - 1) / 2.0;
+        double sinc = t == 0 ? 2 * fc : sin(2 * M_PI * fc * t) / (M_PI * t);
+        double win = 0.42 - 0.5 * cos(2 * M_PI * i / (taps - 1)) +
+                     0.08 * cos(4 * M_PI * i / (taps - 1));
+        h[i] = sinc * win;
+        sum += h[i];
+    }
+    for (int i = 0; i < taps; i++) h[i] /= sum;
+    *num_taps = taps;
+    return h;
+}
+
+// Interpolated input at oversampled tick k, as modulate() feeds it
+static int32_t input_at(const int16_t *in, size_t frames, int osr, size_t k) {
+    size_t n = k / (size_t)osr;
+    int32_t x0 = in[n];
+    int32_t x1 = n + 1 < frames ? in[n + 1] : x0;
+    return x0 + (x1 - x0) * (int32_t)(k % (size_t)osr) / osr;
+}
+
+// Filters the bitstream back to the original rate and returns the SNR in
+// dB. The reference is the modulator's input through the same filter, so
+// only noise the modulator adds inside the pass band counts.
+static double measure_snr(const int16_t *in, size_t frames, int osr, const uint8_t *bits,
+                          const double *h, int taps) {
+    size_t total = frames * (size_t)osr;
+    int half = (taps - 1) / 2;
+    double sxx = 0, sxy = 0, syy = 0;
+
+    double *x = malloc(sizeof(double) * frames);
+    double *y = malloc(sizeof(double) * frames);
+    if (!x || !y) {
+        free(x);
+        free(y);
+        return NAN;
+    }
+    for (size_t n = 0; n < frames; n++) {
+        long centre = (long)(n * (size_t)osr);
+        double acc_x = 0, acc_y = 0;
+        for (int i = 0; i < taps; i++) {
+            long k = centre + i - half;
+            if (k >= 0 && (size_t)k < total) {
+                acc_x += h[i] * input_at(in, frames, osr, (size_t)k) / 32768.0;
+                acc_y += h[i] * (bits[k] ? 1.0 : -1.0);
+            }
+        }
+        x[n] = acc_x;
+        y[n] = acc_y;
+        sxx += acc_x * acc_x;
+        sxy += acc_x * acc_y;
+        syy += acc_y * acc_y;
+    }
+
+    // Least-squares gain, then the residual is the noise
+    double gain = syy > 0 ? sxy / syy : 0;
+    double noise = 0;
+    for (size_t n = 0; n < frames; n++) {
+        double e = x[n] - gain * y[n];
+        noise += e * e;
+    }
+    free(x);
+    free(y);
+    return noise > 0 ? 10 * log10(sxx / noise) : INFINITY;
+}
+
+static int write_bits(const char *path, const uint8_t *bits, size_t count) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    for (size_t k = 0; k < count; k += 8) {
+        uint8_t byte = 0;
+        for (size_t j = 0; j < 8; j++) {
+            byte = (uint8_t)(byte << 1 | (k + j < count ? bits[k + j] : 0));
+        }
+        fputc(byte, f);
+    }
+    return fclose(f);
+}
+
+int main(int argc, char **argv) {
+    int osr = DEFAULT_OSR;
+    int write_order = SDM_ORDER2;
+    const char *out_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:m:o:")) != -1) {
+        switch (opt) {
+        case 'r': osr = atoi(optarg); break;
+        case 'm': write_order = atoi(optarg); break;
+        case 'o': out_path = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-r osr] [-m order] [-o out.pdm] file.wav\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || osr < 1 || write_order < SDM_CLIP || write_order > SDM_ORDER2) {
+        fprintf(stderr, "Usage: %s [-r osr] [-m order] [-o out.pdm] file.wav\n", argv[0]);
+        return 1;
+    }
+
+    struct wav w;
+    if (wav_open(&w, argv[optind]) < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    size_t frames = w.num_frames;
+    size_t total = frames * (size_t)osr;
+    int16_t *in = malloc(sizeof(int16_t) * (frames ? frames : 1));
+    uint8_t *bits = malloc(total ? total : 1);
+    int taps;
+    double *h = make_fir(osr, &taps);
+    if (!in || !bits || !h) {
+        perror("malloc");
+        return 1;
+    }
+    wav_read(&w, 0, in, frames);
+
+    printf("%s: %zu frames at %u Hz, OSR %d (%u Hz bit rate), %d-tap reconstruction\n",
+           argv[optind], w.num_frames, w.sample_rate, osr, w.sample_rate * osr, taps);
+    printf("%-6s %10s %10s\n", "order", "SNR dB", "ones %");
+
+    for (int order = SDM_CLIP; order <= SDM_ORDER2; order++) {
+        modulate(in, frames, osr, order, bits);
+        size_t ones = 0;
+        for (size_t k = 0; k < total; k++) ones += bits[k];
+        printf("%-6s %10.1f %10.1f\n", sdm_name(order),
+               measure_snr(in, frames, osr, bits, h, taps), 100.0 * ones / total);
+
+        if (out_path && order == write_order) {
+            if (write_bits(out_path, bits, total) < 0) {
+                perror(out_path);
+                return 1;
+            }
+            printf("       wrote %zu bits to %s\n", total, out_path);
+        }
+    }
+
+    free(h);
+    free(bits);
+    free(in);
+    wav_close(&w);
+    return 0;
+}
@@ -4,7 +4,13 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
+#include <string.h>
 #include <time.h>
+#include <sys/resource.h>
+
+#include "rt_api.h"
+#include "periodic_api.h"
+#include "pinmap_api.h"
 
 #define CHIP "/dev/gpiochip4"
 
@@ -21,7 +27,7 @@
 #define SEG_F 21
 #define SEG_G 20
 
-#define MULTIPLEX_INTERVAL_US 2000  // 2ms per digit (500Hz refresh rate)
+#define MULTIPLEX_HZ 500            // Digits shown per second (2 ms each)
 #define COUNTER_INTERVAL_MS 500     // Increment counter every 500ms
 
 // 7-segment patterns for hex digits 0-F
@@ -46,152 +52,178 @@ static const unsigned char HEX_PATTERNS[16] = {
     0b0001110   // F
 };
 
-static struct gpiod_line *seg_a, *seg_b, *seg_c, *seg_d, *seg_e, *seg_f, *seg_g;
-static struct gpiod_line *sel_7s1, *sel_7s2;
+// Segments and selects are one output group: pinmap requests them with a
+// single bulk call, and a staged change of any number of them is one write
+static const struct pin_desc PINS[] = {
+    { "seg_a", SEG_A, PIN_OUTPUT, 0, 1, 0 },
+    { "seg_b", SEG_B, PIN_OUTPUT, 0, 1, 0 },
+    { "seg_c", SEG_C, PIN_OUTPUT, 0, 1, 0 },
+    { "seg_d", SEG_D, PIN_OUTPUT, 0, 1, 0 },
+    { "seg_e", SEG_E, PIN_OUTPUT, 0, 1, 0 },
+    { "seg_f", SEG_F, PIN_OUTPUT, 0, 1, 0 },
+    { "seg_g", SEG_G, PIN_OUTPUT, 0, 1, 0 },
+    { "sel_7s1", SEL_7S1, PIN_OUTPUT, 0, 1, 0 },    // Start disabled (OFF = 1)
+    { "sel_7s2", SEL_7S2, PIN_OUTPUT, 0, 1, 0 },
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
+#define NUM_SEGMENTS 7
+
+static struct pin_out segments[NUM_SEGMENTS];
+static struct pin_out sel_7s1, sel_7s2;
 
-// Global state for interrupt handlers
+// Global state shared with the multiplex task
 static volatile unsigned char current_counter = 0;
 static volatile int current_digit = 0;  // 0 = first digit, 1 = second digit
 static volatile unsigned long multiplex_count = 0;
+static unsigned long ticks_per_count = COUNTER_INTERVAL_MS * MULTIPLEX_HZ / 1000;
+static volatile sig_atomic_t stop = 0;
+static struct rt_jitter jitter;
 
-void setup_gpio(struct gpiod_chip *chip) {
-    // Get segment lines
-    seg_a = gpiod_chip_get_line(chip, SEG_A);
-    seg_b = gpiod_chip_get_line(chip, SEG_B);
-    seg_c = gpiod_chip_get_line(chip, SEG_C);
-    seg_d = gpiod_chip_get_line(chip, SEG_D);
-    seg_e = gpiod_chip_get_line(chip, SEG_E);
-    seg_f = gpiod_chip_get_line(chip, SEG_F);
-    seg_g = gpiod_chip_get_line(chip, SEG_G);
-    
-    // Get selector lines
-    sel_7s1 = gpiod_chip_get_line(chip, SEL_7S1);
-    sel_7s2 = gpiod_chip_get_line(chip, SEL_7S2);
-    
-    // Request all as outputs (start with segments OFF = 1)
-    gpiod_line_request_output(seg_a, "seg_a", 1);
-    gpiod_line_request_output(seg_b, "seg_b", 1);
-    gpiod_line_request_output(seg_c, "seg_c", 1);
-    gpiod_line_request_output(seg_d, "seg_d", 1);
-    gpiod_line_request_output(seg_e, "seg_e", 1);
-    gpiod_line_request_output(seg_f, "seg_f", 1);
-    gpiod_line_request_output(seg_g, "seg_g", 1);
-    
-    gpiod_line_request_output(sel_7s1, "sel_7s1", 1); // Start disabled (OFF = 1)
-    gpiod_line_request_output(sel_7s2, "sel_7s2", 1); // Start disabled (OFF = 1)
+static void handle_sigint(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static int setup_gpio(struct pinmap *pm) {
+    static const char *names[NUM_SEGMENTS] = {
+        "seg_a", "seg_b", "seg_c", "seg_d", "seg_e", "seg_f", "seg_g",
+    };
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        if (pinmap_out(pm, names[i], &segments[i]) < 0) {
+            return -1;
+        }
+    }
+    if (pinmap_out(pm, "sel_7s1", &sel_7s1) < 0 || pinmap_out(pm, "sel_7s2", &sel_7s2) < 0) {
+        return -1;
+    }
+    return 0;
 }
 
-void set_segments(unsigned char pattern) {
-    gpiod_line_set_value(seg_a, ((pattern >> 0) & 1));
-    gpiod_line_set_value(seg_b, ((pattern >> 1) & 1));
-    gpiod_line_set_value(seg_c, ((pattern >> 2) & 1));
-    gpiod_line_set_value(seg_d, ((pattern >> 3) & 1));
-    gpiod_line_set_value(seg_e, ((pattern >> 4) & 1));
-    gpiod_line_set_value(seg_f, ((pattern >> 5) & 1));
-    gpiod_line_set_value(seg_g, ((pattern >> 6) & 1));
+// Stages a pattern; nothing is written until the next pin_commit()
+static void stage_segments(unsigned char pattern) {
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        pin_stage(segments[i], (pattern >> i) & 1);
+    }
 }
 
-// Timer interrupt handler for multiplexing
-void multiplex_timer_handler(int sig, siginfo_t *si, void *uc) {
-    (void)sig;
-    (void)si;
-    (void)uc;
+static long long cpu_ns(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL;
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Periodic task: show the next digit (runs on the multiplex thread). All
+// nine lines are one bulk request, so a tick is two writes: both digits
+// off (against ghosting), then the new segments with their digit on
+static int multiplex_tick(void *arg) {
+    (void)arg;
     
-    // current_counter = 18;
     unsigned char high_nibble = (current_counter >> 4) & 0x0F;
     unsigned char low_nibble = current_counter & 0x0F;
     
-    // printf("Counter: %02X : %02X\n", current_digit, current_counter);
     // Turn off BOTH digits first to prevent ghosting
-    gpiod_line_set_value(sel_7s1, 1);
-    gpiod_line_set_value(sel_7s2, 1);
-    // set_segments(0b1111111);
+    pin_stage(sel_7s1, 1);
+    pin_stage(sel_7s2, 1);
+    pin_commit(sel_7s1);
     
     if (current_digit == 0) {
-        set_segments(HEX_PATTERNS[high_nibble]);
-        gpiod_line_set_value(sel_7s1, 0); // Turn on first digit
+        stage_segments(HEX_PATTERNS[high_nibble]);
+        pin_stage(sel_7s1, 0); // Turn on first digit
         current_digit = 1;
     } else {
-        set_segments(HEX_PATTERNS[low_nibble]);
-        gpiod_line_set_value(sel_7s2, 0); // Turn on second digit
+        stage_segments(HEX_PATTERNS[low_nibble]);
+        pin_stage(sel_7s2, 0); // Turn on second digit
         current_digit = 0;
     }
-    // usleep(5000);
+    pin_commit(sel_7s1);
     
     // Increment counter every COUNTER_INTERVAL_MS
     multiplex_count++;
-    if (multiplex_count >= (COUNTER_INTERVAL_MS * 1000) / MULTIPLEX_INTERVAL_US) {
+    if (multiplex_count >= ticks_per_count) {
         current_counter++;
         multiplex_count = 0;
     }
+    return 0;
 }
 
-int main(void) {
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip) {
-        perror("gpiod_chip_open");
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        fprintf(stderr, "Usage: %s [--rt] [--rt-prio=N] [--rt-cpu=N] [--refresh=HZ]\n", argv[0]);
+        return 1;
+    }
+
+    // --refresh: digits shown per second (default MULTIPLEX_HZ)
+    long refresh_hz = MULTIPLEX_HZ;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--refresh=", 10) == 0) {
+            refresh_hz = atol(argv[i] + 10);
+        }
+    }
+    if (refresh_hz < 1 || refresh_hz > 1000000) {
+        fprintf(stderr, "--refresh must be 1 to 1000000 Hz\n");
+        return 1;
+    }
+    long long interval_ns = 1000000000LL / refresh_hz;
+    ticks_per_count = (unsigned long)(COUNTER_INTERVAL_MS * refresh_hz / 1000);
+    if (ticks_per_count == 0) ticks_per_count = 1;
+
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "seven_segment", PINS, NUM_PINS) < 0) {
+        perror("pinmap_open");
+        return 1;
+    }
+    if (setup_gpio(&pm) < 0) {
+        perror("pins");
+        pinmap_close(&pm);
         return 1;
     }
     
-    setup_gpio(chip);
-
-    // while(1){
-    //     // gpiod_line_set_value(sel_7s1, 1);
-    //     // gpiod_line_set_value(sel_7s2, 1);
-    //     // usleep(50000); 
-        
-    //     // set_segments(HEX_PATTERNS[8]);
-    //     // usleep(50000); 
-        
-    //     multiplex_timer_handler(0, NULL, NULL); // Manually call handler to update display
-    //     // usleep(1000000); // Sleep for 1 second
-    // }
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete, multiplexing may flicker\n");
+    }
     
     printf("7-Segment Counter: 00 to FF\n");
     printf("Press Ctrl+C to stop...\n\n");
     
-    // Setup signal handler for multiplex timer
-    struct sigaction sa;
-    sa.sa_flags = SA_SIGINFO;
-    sa.sa_sigaction = multiplex_timer_handler;
-    sigemptyset(&sa.sa_mask);
-    if (sigaction(SIGRTMIN, &sa, NULL) == -1) {
-        perror("sigaction");
-        gpiod_chip_close(chip);
-        return 1;
-    }
-    
-    // Create multiplex timer
-    timer_t multiplex_timer_id;
-    struct sigevent sev;
-    sev.sigev_notify = SIGEV_SIGNAL;
-    sev.sigev_signo = SIGRTMIN;
-    sev.sigev_value.sival_ptr = &multiplex_timer_id;
-    
-    if (timer_create(CLOCK_REALTIME, &sev, &multiplex_timer_id) == -1) {
-        perror("timer_create");
-        gpiod_chip_close(chip);
-        return 1;
+    if (telemetry_open(argv[0]) < 0) {
+        fprintf(stderr, "Warning: telemetry disabled\n");
     }
     
-    // Start multiplex timer (500Hz = 2ms per interrupt)
-    struct itimerspec its;
-    its.it_value.tv_sec = 0;
-    its.it_value.tv_nsec = MULTIPLEX_INTERVAL_US * 1000;
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = MULTIPLEX_INTERVAL_US * 1000;
-    
-    if (timer_settime(multiplex_timer_id, 0, &its, NULL) == -1) {
-        perror("timer_settime");
-        gpiod_chip_close(chip);
+    // Start multiplexing (one digit per tick) on its own thread
+    long long cpu_start = cpu_ns(), wall_start = now_ns();
+    struct periodic_task task;
+    if (periodic_start(&task, interval_ns, multiplex_tick, NULL, &jitter,
+                       telemetry_task("multiplex", interval_ns)) < 0) {
+        perror("periodic_start");
+        pinmap_close(&pm);
         return 1;
     }
     
-    // Main loop - just wait for interrupts
-    while (1) {
+    // Main loop - nothing to do until Ctrl+C
+    signal(SIGINT, handle_sigint);
+    while (!stop) {
         pause();
     }
     
-    gpiod_chip_close(chip);
+    periodic_stop(&task);
+    double seconds = (now_ns() - wall_start) / 1e9;
+    double cpu_ms = (cpu_ns() - cpu_start) / 1e6;
+    unsigned long writes = sel_7s1.group->writes;
+    long ticks = atomic_load(&task.ticks);
+    printf("\n%ld overruns\n", atomic_load(&task.overruns));
+    printf("%ld Hz refresh: %lu bulk writes (%.2f per tick, %.0f/s), CPU %.2f ms per second\n",
+           refresh_hz, writes, ticks ? (double)writes / ticks : 0.0, writes / seconds,
+           cpu_ms / seconds);
+    rt_jitter_report(&jitter, "Multiplex", &rt);
+    telemetry_close();
+    pinmap_close(&pm);
     return 0;
 }
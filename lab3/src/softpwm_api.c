@@ -0,0 +1,279 @@
+#define _GNU_SOURCE
+#include "softpwm_api.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/prctl.h>
+
+#define NSEC_PER_SEC 1000000000LL
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+// Converts a request to period and high time, or returns -1 if invalid
+static int to_times(double freq_hz, double duty, long long *period_ns, long long *high_ns) {
+    if (!(freq_hz > 0) || freq_hz > NSEC_PER_SEC / 2) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (duty < 0) duty = 0;
+    if (duty > 1) duty = 1;
+    *period_ns = (long long)(NSEC_PER_SEC / freq_hz + 0.5);
+    *high_ns = (long long)(*period_ns * duty + 0.5);
+    return 0;
+}
+
+static void reset_stats(struct softpwm_channel *c) {
+    c->edges = 0;
+    c->overruns = 0;
+    c->late_sum_ns = 0;
+    c->late_max_ns = 0;
+    c->rises = 0;
+    c->pulses = 0;
+    c->high_sum_ns = 0;
+}
+
+// Min-heap of channel numbers keyed by next_ns
+
+static int earlier(const struct softpwm *pwm, unsigned int a, unsigned int b) {
+    return pwm->ch[pwm->heap[a]].next_ns < pwm->ch[pwm->heap[b]].next_ns;
+}
+
+static void sift_down(struct softpwm *pwm, unsigned int i) {
+    unsigned int n = pwm->num_channels;
+    for (;;) {
+        unsigned int l = 2 * i + 1, r = l + 1, min = i;
+        if (l < n && earlier(pwm, l, min)) min = l;
+        if (r < n && earlier(pwm, r, min)) min = r;
+        if (min == i) {
+            return;
+        }
+        unsigned char tmp = pwm->heap[i];
+        pwm->heap[i] = pwm->heap[min];
+        pwm->heap[min] = tmp;
+        i = min;
+    }
+}
+
+// Counts an edge written at time now; coalesced early edges count as on time
+static void note_edge(struct softpwm_channel *c, long long now) {
+    long long late = now - c->next_ns;
+    if (late > 0) {
+        c->late_sum_ns += late;
+        if (late > c->late_max_ns) c->late_max_ns = late;
+    }
+    c->edges++;
+}
+
+// Applies the channel's due edge at time now and schedules the next one
+static void run_edge(struct softpwm_channel *c, long long now) {
+    if (!c->rising) {
+        // End of the high phase
+        note_edge(c, now);
+        pin_stage(c->pin, 0);
+        c->pulses++;
+        c->high_sum_ns += now - c->rise_ns;
+        c->next_ns = c->start_ns + c->cur_period_ns;
+        c->rising = 1;
+        return;
+    }
+
+    // Start of a period: pick up new settings, skip periods already missed
+    c->start_ns = c->next_ns;
+    if (c->changed) {
+        c->cur_period_ns = c->period_ns;
+        c->cur_high_ns = c->high_ns;
+        c->changed = 0;
+        reset_stats(c);
+    } else if (now - c->start_ns >= c->cur_period_ns) {
+        long long missed = (now - c->start_ns) / c->cur_period_ns;
+        c->overruns += missed;
+        c->start_ns += missed * c->cur_period_ns;
+    }
+
+    int level = c->cur_high_ns > 0;
+    if (level && c->pin.group->values[c->pin.index] == 0) {
+        note_edge(c, now);
+        if (c->rises++ == 0) c->first_rise_ns = now;
+        c->last_rise_ns = now;
+        c->rise_ns = now;
+    }
+    pin_stage(c->pin, level);
+
+    if (c->cur_high_ns > 0 && c->cur_high_ns < c->cur_period_ns) {
+        c->next_ns = c->start_ns + c->cur_high_ns;
+        c->rising = 0;
+    } else {
+        c->next_ns = c->start_ns + c->cur_period_ns;     // Held high or low
+    }
+}
+
+static void *runner(void *arg) {
+    struct softpwm *pwm = arg;
+    struct pin_out touched[SOFTPWM_MAX_CHANNELS];
+
+    // Exact wake-ups, as in periodic_api
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    while (!atomic_load_explicit(&pwm->stop, memory_order_relaxed)) {
+        long long next = pwm->ch[pwm->heap[0]].next_ns;
+        struct timespec deadline = {
+            .tv_sec = next / NSEC_PER_SEC,
+            .tv_nsec = next % NSEC_PER_SEC,
+        };
+        int ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        if (ret == EINTR) {
+            continue;
+        }
+
+        pthread_mutex_lock(&pwm->lock);
+        long long now = now_ns();
+        unsigned int num_touched = 0;
+        pwm->wakeups++;
+
+        // Stage every edge due now or within the coalescing window
+        while (pwm->ch[pwm->heap[0]].next_ns <= now + SOFTPWM_COALESCE_NS) {
+            struct softpwm_channel *c = &pwm->ch[pwm->heap[0]];
+            run_edge(c, now);
+
+            unsigned int t = 0;
+            while (t < num_touched && touched[t].group != c->pin.group) t++;
+            if (t == num_touched) touched[num_touched++] = c->pin;
+
+            sift_down(pwm, 0);
+        }
+
+        // One write per group that changed
+        for (unsigned int t = 0; t < num_touched; t++) {
+            if (touched[t].group->dirty) {
+                pin_commit(touched[t]);
+                pwm->writes++;
+            }
+        }
+        pthread_mutex_unlock(&pwm->lock);
+    }
+    return NULL;
+}
+
+void softpwm_init(struct softpwm *pwm) {
+    memset(pwm, 0, sizeof(*pwm));
+    pthread_mutex_init(&pwm->lock, NULL);
+    atomic_init(&pwm->stop, 0);
+}
+
+int softpwm_add(struct softpwm *pwm, struct pin_out pin, double freq_hz, double duty) {
+    if (pwm->num_channels >= SOFTPWM_MAX_CHANNELS) {
+        errno = ENOSPC;
+        return -1;
+    }
+    struct softpwm_channel *c = &pwm->ch[pwm->num_channels];
+    memset(c, 0, sizeof(*c));
+    if (to_times(freq_hz, duty, &c->period_ns, &c->high_ns) < 0) {
+        return -1;
+    }
+    c->pin = pin;
+    c->changed = 1;
+    return (int)pwm->num_channels++;
+}
+
+int softpwm_set(struct softpwm *pwm, int channel, double freq_hz, double duty) {
+    long long period_ns, high_ns;
+    if (channel < 0 || (unsigned int)channel >= pwm->num_channels) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (to_times(freq_hz, duty, &period_ns, &high_ns) < 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pwm->lock);
+    struct softpwm_channel *c = &pwm->ch[channel];
+    c->period_ns = period_ns;
+    c->high_ns = high_ns;
+    c->changed = 1;
+    pthread_mutex_unlock(&pwm->lock);
+    return 0;
+}
+
+int softpwm_start(struct softpwm *pwm) {
+    if (pwm->num_channels == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Every channel starts a period at the same instant, so the first
+    // rising edges all go out in one write per group
+    long long start = now_ns() + SOFTPWM_COALESCE_NS;
+    for (unsigned int i = 0; i < pwm->num_channels; i++) {
+        pwm->ch[i].next_ns = start;
+        pwm->ch[i].rising = 1;
+        pwm->heap[i] = (unsigned char)i;
+    }
+    pwm->wakeups = 0;
+    pwm->writes = 0;
+    atomic_store(&pwm->stop, 0);
+
+    // Signals stay on the caller's thread, as with periodic_start()
+    sigset_t all, old_mask;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old_mask);
+    int ret = pthread_create(&pwm->thread, NULL, runner, pwm);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    if (ret != 0) {
+        errno = ret;
+        return -1;
+    }
+    return 0;
+}
+
+void softpwm_stop(struct softpwm *pwm) {
+    atomic_store(&pwm->stop, 1);
+    pthread_join(pwm->thread, NULL);
+
+    for (unsigned int i = 0; i < pwm->num_channels; i++) {
+        pin_stage(pwm->ch[i].pin, 0);
+    }
+    for (unsigned int i = 0; i < pwm->num_channels; i++) {
+        pin_commit(pwm->ch[i].pin);
+    }
+}
+
+void softpwm_report(struct softpwm *pwm) {
+    pthread_mutex_lock(&pwm->lock);
+
+    printf("\n%-3s %11s %11s %8s %8s %10s %10s %9s\n", "ch", "req Hz", "got Hz",
+           "req duty", "got duty", "late avg", "late max", "overruns");
+    long edges = 0;
+    for (unsigned int i = 0; i < pwm->num_channels; i++) {
+        const struct softpwm_channel *c = &pwm->ch[i];
+        double req_hz = (double)NSEC_PER_SEC / c->cur_period_ns;
+        double req_duty = (double)c->cur_high_ns / c->cur_period_ns;
+        edges += c->edges;
+
+        printf("%-3u %11.2f ", i, req_hz);
+        if (c->rises >= 2 && c->pulses > 0) {
+            double period = (double)(c->last_rise_ns - c->first_rise_ns) / (c->rises - 1);
+            double high = (double)c->high_sum_ns / c->pulses;
+            printf("%11.2f %7.1f%% %7.1f%% ", NSEC_PER_SEC / period, req_duty * 100,
+                   high / period * 100);
+        } else {
+            // Held high or low: there are no edges to time
+            printf("%11s %7.1f%% %8s ", "-", req_duty * 100, "-");
+        }
+        if (c->edges > 0) {
+            printf("%8.1fus %8.1fus", c->late_sum_ns / 1e3 / c->edges, c->late_max_ns / 1e3);
+        } else {
+            printf("%10s %10s", "-", "-");
+        }
+        printf(" %9ld\n", c->overruns);
+    }
+    printf("%ld wake-ups, %ld group writes for %ld edges (%.2f edges per write)\n",
+           pwm->wakeups, pwm->writes, edges, pwm->writes ? (double)edges / pwm->writes : 0.0);
+
+    pthread_mutex_unlock(&pwm->lock);
+}
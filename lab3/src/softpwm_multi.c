@@ -0,0 +1,134 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#include "rt_api.h"
+#include "pinmap_api.h"
+#include "softpwm_api.h"
+
+/*
+ * Several PWM outputs from one timer thread.
+ *
+ * Each -p pin:freq:duty adds a channel (duty in percent). By default it
+ * drives the buzzer at 1 kHz next to two slow dimmer channels, one of which
+ * is a sub-harmonic of the buzzer so their period starts coincide and share
+ * one write. All channels share one output group. Runs until Ctrl+C or -t
+ * seconds, then prints requested vs achieved frequency and duty per channel.
+ *
+ * Run: sudo ./softpwm_multi [--rt] [-p pin:freq:duty]... [-t seconds]
+ */
+
+#define CHIP "/dev/gpiochip4"
+
+static const char *const DEFAULT_CHANNELS[] = {
+    "21:1000:50",   // Buzzer
+    "20:250:25",    // Dimmer, every 4th buzzer period starts with it
+    "26:90:10",     // Dimmer, unrelated frequency
+};
+#define NUM_DEFAULT (sizeof(DEFAULT_CHANNELS) / sizeof(DEFAULT_CHANNELS[0]))
+
+static volatile sig_atomic_t stop = 0;
+
+static void handle_sigint(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        fprintf(stderr, "Usage: %s [--rt] [-p pin:freq:duty]... [-t seconds]\n", argv[0]);
+        return 1;
+    }
+
+    const char *specs[SOFTPWM_MAX_CHANNELS];
+    unsigned int num_specs = 0;
+    int seconds = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:t:")) != -1) {
+        switch (opt) {
+        case 'p':
+            if (num_specs == SOFTPWM_MAX_CHANNELS) {
+                fprintf(stderr, "At most %d channels\n", SOFTPWM_MAX_CHANNELS);
+                return 1;
+            }
+            specs[num_specs++] = optarg;
+            break;
+        case 't': seconds = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [--rt] [-p pin:freq:duty]... [-t seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (num_specs == 0) {
+        for (unsigned int i = 0; i < NUM_DEFAULT; i++) specs[num_specs++] = DEFAULT_CHANNELS[i];
+    }
+
+    // One output group for every channel, so coinciding edges share a write
+    struct pin_desc pins[SOFTPWM_MAX_CHANNELS];
+    char names[SOFTPWM_MAX_CHANNELS][8];
+    double freq[SOFTPWM_MAX_CHANNELS], duty[SOFTPWM_MAX_CHANNELS];
+    for (unsigned int i = 0; i < num_specs; i++) {
+        unsigned int offset;
+        if (sscanf(specs[i], "%u:%lf:%lf", &offset, &freq[i], &duty[i]) != 3) {
+            fprintf(stderr, "Bad channel '%s', expected pin:freq:duty\n", specs[i]);
+            return 1;
+        }
+        snprintf(names[i], sizeof(names[i]), "pwm%u", i);
+        pins[i] = (struct pin_desc){ names[i], offset, PIN_OUTPUT, 0, 0, 0 };
+    }
+
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "softpwm_multi", pins, num_specs) < 0) {
+        perror("pinmap_open");
+        return 1;
+    }
+
+    struct softpwm pwm;
+    softpwm_init(&pwm);
+    for (unsigned int i = 0; i < num_specs; i++) {
+        struct pin_out p;
+        if (pinmap_out(&pm, names[i], &p) < 0 ||
+            softpwm_add(&pwm, p, freq[i], duty[i] / 100.0) < 0) {
+            fprintf(stderr, "Channel '%s': ", specs[i]);
+            perror(NULL);
+            pinmap_close(&pm);
+            return 1;
+        }
+        printf("Channel %u: GPIO %u, %.2f Hz, %.1f%% duty\n",
+               i, pins[i].offset, freq[i], duty[i]);
+    }
+
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete, edges may jitter\n");
+    }
+
+    signal(SIGINT, handle_sigint);
+    if (softpwm_start(&pwm) < 0) {
+        perror("softpwm_start");
+        pinmap_close(&pm);
+        return 1;
+    }
+    printf("Running in %s mode. Press Ctrl+C to stop...\n", rt_mode_name(&rt));
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    end.tv_sec += seconds;
+    while (!stop) {
+        if (seconds > 0 &&
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &end, NULL) == 0) {
+            break;
+        }
+        if (seconds <= 0) {
+            pause();
+        }
+    }
+
+    softpwm_stop(&pwm);
+    softpwm_report(&pwm);
+    pinmap_close(&pm);
+    return 0;
+}
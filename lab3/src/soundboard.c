@@ -0,0 +1,424 @@
+#define _GNU_SOURCE
+#include <gpiod.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <stdint.h>
+
+#include "rt_api.h"
+#include "sample_clock_api.h"
+#include "pinmap_api.h"
+#include "keyp_api.h"
+#include "sdm_api.h"
+#include "pwm_audio_api.h"
+#include "audio_pipe_api.h"
+#include "mixer_api.h"
+
+/*
+ * Sound-effect board: plays several clips at once through the mixer.
+ *
+ * Keys: 1-9 play clip 1-9 (again and again, overlapping), # cycles the
+ * gain of new voices (100%, 50%, 25%), * stops everything.
+ *
+ * Input, one of:
+ *   keypad     (default) the 4x3 keypad, wired as in lab2
+ *   --button   the button on GPIO 14 plays the first clip
+ *   --stdin    the same keys typed on stdin; at end of input the program
+ *              waits for the voices to finish and exits, so it can be
+ *              scripted: (echo 1; sleep 0.2; echo 2) | ./soundboard --stdin
+ *
+ * Output is the chipi_chapa path: 1-bit on GPIO 21 (--sdm, --osr) or the
+ * hardware PWM sink (--pwm; GPIO 18 is then taken, so not with the
+ * keypad). The mixer runs on the audio_pipe decoder thread, a few blocks
+ * ahead of the sample task.
+ *
+ * Run: sudo ./soundboard [--rt] [--sdm=0|1|2] [--osr=N] [--pwm[=chip_dir]]
+ *                        [--carrier=HZ] [--button|--stdin] [clip.wav ...]
+ */
+
+#define CHIP "/dev/gpiochip4"
+#define AUDIO_PIN 21
+#define BUTTON_PIN 14
+#define MAX_EVENTS 16
+#define DEBOUNCE_MS 30
+
+#define CLIP_DIR "/home/alfredo/Desktop/repositories/Embedded-lab/"
+#define MAX_CLIPS 9
+
+static const struct pin_desc AUDIO_PINS[] = {
+    { "audio", AUDIO_PIN, PIN_OUTPUT, 0, 0, 0 },
+};
+
+static const struct pin_desc KEYPAD_PINS[] = {
+    { "col1", 14, PIN_EDGE_BOTH, 0, 0, 0 },
+    { "col2", 15, PIN_EDGE_BOTH, 0, 0, 0 },
+    { "col3", 18, PIN_EDGE_BOTH, 0, 0, 0 },
+    { "row1", 27, PIN_OUTPUT, 0, 1, 0 },
+    { "row2", 22, PIN_OUTPUT, 0, 1, 0 },
+    { "row3", 23, PIN_OUTPUT, 0, 1, 0 },
+    { "row4", 24, PIN_OUTPUT, 0, 1, 0 },
+};
+
+static const struct pin_desc BUTTON_PINS[] = {
+    { "button", BUTTON_PIN, PIN_EDGE_FALLING, 0, 0, 10000 },  // 10 ms kernel debounce (v2)
+};
+
+static const int16_t GAINS[] = {MIXER_GAIN_UNITY, MIXER_GAIN_UNITY / 2, MIXER_GAIN_UNITY / 4};
+#define NUM_GAINS (int)(sizeof(GAINS) / sizeof(GAINS[0]))
+
+static struct mixer mixer;
+static struct audio_pipe mixed;
+static struct mixer_clip clips[MAX_CLIPS];
+static int num_clips = 0;
+static int gain_index = 0;
+static volatile sig_atomic_t stop = 0;
+
+// Output state (the sample task owns these)
+static struct pin_out audio_out;
+static struct pwm_audio pwm;
+static int use_pwm = 0;
+static struct sdm modulator;
+static int osr = 1;
+static int sub_tick = 0;
+static int32_t x0, x1;
+static int last_output = -1;
+static struct rt_jitter jitter;
+
+static void handle_sigint(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+// Sample clock task: the chipi_chapa output path, fed by the mixer. The
+// samples skipped ticks would have started are dropped, so the mix stays
+// in step with the clock
+static int play_sample(void *arg, unsigned skipped) {
+    (void)arg;
+    if (skipped) {
+        unsigned drop = (sub_tick + skipped - 1) / (unsigned)osr + (sub_tick == 0);
+        sub_tick = (int)((sub_tick + skipped) % (unsigned)osr);
+        for (unsigned i = 0; i < drop; i++) {
+            int16_t next;
+            x0 = x1;
+            if (audio_pipe_pop(&mixed, &next) > 0) {
+                x1 = next;
+            }
+        }
+    }
+    if (sub_tick == 0) {
+        int16_t next;
+        int ret = audio_pipe_pop(&mixed, &next);
+        x0 = x1;
+        if (ret > 0) {
+            x1 = next;
+        }
+    }
+
+    if (use_pwm) {
+        pwm_audio_write(&pwm, (int16_t)x1);
+    } else {
+        int output = sdm_step(&modulator, x0 + (x1 - x0) * sub_tick / osr);
+        if (output != last_output) {
+            pin_write(audio_out, output);
+            last_output = output;
+        }
+    }
+    if (++sub_tick == osr) {
+        sub_tick = 0;
+    }
+    return 0;
+}
+
+static int gain_percent(int16_t gain) {
+    return (200 * gain / MIXER_GAIN_UNITY + 1) / 2;
+}
+
+static void handle_key(char key) {
+    if (key >= '1' && key <= '9') {
+        int clip = key - '1';
+        if (clip >= num_clips) {
+            return;
+        }
+        if (mixer_trigger(&mixer, clip, GAINS[gain_index]) < 0) {
+            printf("Trigger queue full\n");
+            return;
+        }
+        printf("Play %s at %d%%\n", clips[clip].name, gain_percent(GAINS[gain_index]));
+    } else if (key == '#') {
+        gain_index = (gain_index + 1) % NUM_GAINS;
+        printf("Gain %d%%\n", gain_percent(GAINS[gain_index]));
+    } else if (key == '*') {
+        mixer_trigger(&mixer, -1, 0);
+        printf("Stop all\n");
+    }
+    fflush(stdout);
+}
+
+// Keys typed on stdin; returns when stopped or, at end of input, once
+// the mixer has gone quiet
+static void run_stdin(long long block_ns) {
+    int eof = 0;
+    while (!stop) {
+        if (eof) {
+            if (mixer_idle(&mixer)) {
+                // Let the blocks already in the pipe play out
+                usleep((useconds_t)(block_ns * (MIXER_PIPE_DEPTH + 1) / 1000));
+                return;
+            }
+            usleep(10000);
+            continue;
+        }
+        struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        char buf[64];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if (n <= 0) {
+            eof = 1;
+            continue;
+        }
+        for (ssize_t i = 0; i < n; i++) handle_key(buf[i]);
+    }
+}
+
+static void run_button(struct pin_edge button) {
+    while (!stop) {
+        struct timespec timeout = {.tv_sec = 0, .tv_nsec = 100000000L};
+        if (pin_edge_wait(button, &timeout) <= 0) {
+            continue;
+        }
+        // A bouncing press arrives as a burst; one trigger per burst
+        struct pin_event events[MAX_EVENTS];
+        int n = pin_edge_read(button, events, MAX_EVENTS);
+        for (int i = 0; i < n; i++) {
+            if (events[i].type == PIN_EVENT_FALLING) {
+                handle_key('1');
+                break;
+            }
+        }
+    }
+}
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+}
+
+static void run_keypad(void) {
+    long long last_key_ms = 0;
+    struct pin_edge *cols = keyp_get_cols();
+    while (!stop) {
+        for (int i = 0; i < 3; i++) {
+            if (pin_edge_wait(cols[i], &(struct timespec){ .tv_sec = 0, .tv_nsec = 10000000L }) <= 0) {
+                continue;
+            }
+            struct pin_event evs[MAX_EVENTS];
+            int n = pin_edge_read(cols[i], evs, MAX_EVENTS);
+            int rising = 0;
+            for (int k = 0; k < n; k++) {
+                if (evs[k].type == PIN_EVENT_RISING) {
+                    rising = 1;
+                }
+            }
+            long long t = now_ms();
+            if (!rising || t - last_key_ms < DEBOUNCE_MS) {
+                continue;
+            }
+            last_key_ms = t;
+
+            char key = keyp_scan();
+            if (key != '\0') {
+                handle_key(key);
+            }
+            // Drain the events the scan itself caused
+            for (int j = 0; j < 3; j++) {
+                while (pin_edge_wait(cols[j], &(struct timespec){0, 0}) > 0) {
+                    if (pin_edge_read(cols[j], evs, MAX_EVENTS) < 0) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        fprintf(stderr, "Usage: %s [--rt] [--rt-prio=N] [--rt-cpu=N] [--sdm=0|1|2] [--osr=N] "
+                        "[--pwm[=chip_dir]] [--carrier=HZ] [--button|--stdin] [clip.wav ...]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *pwm_chip = PWM_AUDIO_CHIP;
+    long carrier_hz = PWM_AUDIO_CARRIER_HZ;
+    int order = SDM_CLIP;
+    int use_button = 0, use_stdin = 0;
+    const char *paths[MAX_CLIPS];
+    int num_paths = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--button") == 0) {
+            use_button = 1;
+        } else if (strcmp(argv[i], "--stdin") == 0) {
+            use_stdin = 1;
+        } else if (strcmp(argv[i], "--pwm") == 0) {
+            use_pwm = 1;
+        } else if (strncmp(argv[i], "--pwm=", 6) == 0) {
+            use_pwm = 1;
+            pwm_chip = argv[i] + 6;
+        } else if (strncmp(argv[i], "--carrier=", 10) == 0) {
+            carrier_hz = atol(argv[i] + 10);
+        } else if (strncmp(argv[i], "--sdm=", 6) == 0) {
+            order = atoi(argv[i] + 6);
+        } else if (strncmp(argv[i], "--osr=", 6) == 0) {
+            osr = atoi(argv[i] + 6);
+        } else if (num_paths < MAX_CLIPS) {
+            paths[num_paths++] = argv[i];
+        }
+    }
+    if (num_paths == 0) {
+        paths[num_paths++] = CLIP_DIR "Chipi.wav";
+        paths[num_paths++] = CLIP_DIR "Vine Boom.wav";
+    }
+    if (order < SDM_CLIP || order > SDM_ORDER2 || osr < 1 ||
+        (use_pwm && (order != SDM_CLIP || osr != 1))) {
+        fprintf(stderr, "--sdm must be 0, 1 or 2 and --osr at least 1 (GPIO output only)\n");
+        return 1;
+    }
+    if (use_pwm && !use_button && !use_stdin) {
+        fprintf(stderr, "--pwm takes GPIO 18, which the keypad uses; add --button or --stdin\n");
+        return 1;
+    }
+    sdm_init(&modulator, order);
+
+    // Clips, converted to 16-bit mono up front
+    for (int i = 0; i < num_paths; i++) {
+        if (mixer_clip_load(&clips[num_clips], paths[i]) < 0) {
+            perror(paths[i]);
+            return 1;
+        }
+        if (clips[num_clips].sample_rate != clips[0].sample_rate) {
+            fprintf(stderr, "%s: %u Hz, but the first clip is %u Hz\n", paths[i],
+                    clips[num_clips].sample_rate, clips[0].sample_rate);
+            return 1;
+        }
+        printf("Key %d: %s (%.2f s)\n", num_clips + 1, clips[num_clips].name,
+               (double)clips[num_clips].len / clips[num_clips].sample_rate);
+        num_clips++;
+    }
+    unsigned rate = clips[0].sample_rate;
+    mixer_init(&mixer, clips, num_clips);
+
+    // The audio pin gets a pin map of its own, so the sample task never
+    // shares a group shadow with the keypad rows
+    struct pinmap audio_pm, input_pm;
+    int have_audio_pm = 0, have_input_pm = 0;
+    if (use_pwm) {
+        if (pwm_audio_open(&pwm, pwm_chip, 0, carrier_hz) < 0) {
+            perror(pwm_chip);
+            return 1;
+        }
+    } else {
+        if (pinmap_open(&audio_pm, CHIP, "soundboard", AUDIO_PINS, 1) < 0 ||
+            pinmap_out(&audio_pm, "audio", &audio_out) < 0) {
+            perror("pinmap(audio)");
+            return 1;
+        }
+        have_audio_pm = 1;
+    }
+
+    struct pin_edge button;
+    if (use_button) {
+        if (pinmap_open(&input_pm, CHIP, "soundboard", BUTTON_PINS, 1) < 0 ||
+            pinmap_edge(&input_pm, "button", &button) < 0) {
+            perror("pinmap(button)");
+            return 1;
+        }
+        have_input_pm = 1;
+    } else if (!use_stdin) {
+        struct pin_edge col1, col2, col3;
+        struct pin_out row1, row2, row3, row4;
+        if (pinmap_open(&input_pm, CHIP, "soundboard", KEYPAD_PINS,
+                        sizeof(KEYPAD_PINS) / sizeof(KEYPAD_PINS[0])) < 0 ||
+            pinmap_edge(&input_pm, "col1", &col1) < 0 || pinmap_edge(&input_pm, "col2", &col2) < 0 ||
+            pinmap_edge(&input_pm, "col3", &col3) < 0 ||
+            pinmap_out(&input_pm, "row1", &row1) < 0 || pinmap_out(&input_pm, "row2", &row2) < 0 ||
+            pinmap_out(&input_pm, "row3", &row3) < 0 || pinmap_out(&input_pm, "row4", &row4) < 0) {
+            perror("pinmap(keypad)");
+            return 1;
+        }
+        keyp_init(col1, col2, col3, row1, row2, row3, row4);
+        have_input_pm = 1;
+    }
+
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete, timing may jitter\n");
+    }
+    if (telemetry_open(argv[0]) < 0) {
+        fprintf(stderr, "Warning: telemetry disabled\n");
+    }
+
+    // Mixer on the decoder thread, only a few blocks ahead so new voices
+    // are heard quickly
+    if (audio_pipe_start(&mixed, mixer_decode, &mixer) < 0) {
+        perror("audio_pipe_start");
+        return 1;
+    }
+    audio_pipe_set_depth(&mixed, MIXER_PIPE_DEPTH);
+
+    uint32_t tick_hz = (uint32_t)rate * (uint32_t)osr;
+    long long block_ns = 1000000000LL * AUDIO_PIPE_BLOCK_FRAMES / rate;
+    struct sample_clock clock;
+    if (sample_clock_start(&clock, tick_hz, SAMPLE_CLOCK_CATCHUP, play_sample, NULL, &jitter,
+                           telemetry_task("audio", 1000000000L / tick_hz)) < 0) {
+        perror("sample_clock_start");
+        audio_pipe_stop(&mixed);
+        return 1;
+    }
+
+    printf("Mixing up to %d voices with %s adds, %s output, %s mode, ~%.0f ms trigger latency\n",
+           MIXER_VOICES, mixer_simd_name(),
+           use_pwm ? "PWM" : order == SDM_CLIP ? "1-bit" : "sigma-delta",
+           rt_mode_name(&rt), (MIXER_PIPE_DEPTH + 0.5) * block_ns / 1e6);
+    printf("Keys: 1-%d play, # gain, * stop all. Ctrl+C to quit\n", num_clips);
+    fflush(stdout);
+
+    signal(SIGINT, handle_sigint);
+    if (use_stdin) {
+        run_stdin(block_ns);
+    } else if (use_button) {
+        run_button(button);
+    } else {
+        run_keypad();
+    }
+
+    sample_clock_stop(&clock);
+    audio_pipe_stop(&mixed);
+
+    printf("\n%ld voices started (%ld taken over), peak %d at once\n",
+           mixer.triggers, mixer.stolen, mixer.peak_voices);
+    printf("Mix cost: %.2f ns per sample per voice, %.2f ns per output sample\n",
+           mixer.voice_samples ? (double)mixer.mix_ns / mixer.voice_samples : 0.0,
+           mixer.frames ? (double)mixer.mix_ns / mixer.frames : 0.0);
+    printf("%lld ticks skipped, %ld underrun ticks in %ld stretches\n",
+           atomic_load(&clock.skipped), atomic_load(&mixed.underruns),
+           atomic_load(&mixed.underrun_runs));
+    rt_jitter_report(&jitter, "Audio sample", &rt);
+    sample_clock_report(&clock, "Audio sample");
+    telemetry_close();
+
+    if (use_pwm) {
+        pwm_audio_close(&pwm);
+    }
+    if (have_audio_pm) pinmap_close(&audio_pm);
+    if (have_input_pm) pinmap_close(&input_pm);
+    for (int i = 0; i < num_clips; i++) mixer_clip_free(&clips[i]);
+    return 0;
+}
@@ -5,29 +5,30 @@
 #include <unistd.h>
 #include <time.h>
 
+#include "pinmap_api.h"
+
 #define CHIP "/dev/gpiochip4"
 #define INPUT_PIN 21
 #define MEASUREMENT_PERIOD_MS 1000  // Measure RPM over 1 second
 #define PULSES_PER_REVOLUTION 6     // 6 pulses = 1 full rotation
+#define MAX_EVENTS 64               // Edge events pulled per wake-up
+
+// GPIO 21 as input with rising edge detection
+static const struct pin_desc PINS[] = {
+    { "input", INPUT_PIN, PIN_EDGE_RISING, 0, 0, 0 },
+};
 
 int main(void) {
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip) {
-        perror("gpiod_chip_open");
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "tacometer", PINS, 1) < 0) {
+        perror("pinmap_open");
         return 1;
     }
 
-    // Set up GPIO 21 as input with rising edge detection
-    struct gpiod_line *input = gpiod_chip_get_line(chip, INPUT_PIN);
-    if (!input) {
-        perror("gpiod_chip_get_line");
-        gpiod_chip_close(chip);
-        return 1;
-    }
-    
-    if (gpiod_line_request_rising_edge_events(input, "input") < 0) {
-        perror("gpiod_line_request_rising_edge_events");
-        gpiod_chip_close(chip);
+    struct pin_edge input;
+    if (pinmap_edge(&pm, "input", &input) < 0) {
+        perror("input pin");
+        pinmap_close(&pm);
         return 1;
     }
     
@@ -43,17 +44,24 @@ int main(void) {
     while (1) {
         // Wait for rising edge event with timeout
         struct timespec timeout = {.tv_sec = 0, .tv_nsec = 100000000}; // 100ms timeout
-        int ret = gpiod_line_event_wait(input, &timeout);
+        int ret = pin_edge_wait(input, &timeout);
         
         if (ret < 0) {
-            perror("gpiod_line_event_wait");
+            perror("pin_edge_wait");
             break;
         }
         
         if (ret > 0) {
-            struct gpiod_line_event event;
-            if (gpiod_line_event_read(input, &event) == 0) {
-                if (event.event_type == GPIOD_LINE_EVENT_RISING_EDGE) {
+            // At high RPM several pulses queue up between wake-ups;
+            // count the whole batch with a single read
+            struct pin_event events[MAX_EVENTS];
+            int n = pin_edge_read(input, events, MAX_EVENTS);
+            if (n < 0) {
+                perror("pin_edge_read");
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                if (events[i].type == PIN_EVENT_RISING) {
                     pulse_count++;
                     total_pulses++;
                 }
@@ -81,7 +89,6 @@ int main(void) {
     }
 
     printf("\n");
-    gpiod_line_release(input);
-    gpiod_chip_close(chip);
+    pinmap_close(&pm);
     return 0;
 }
@@ -0,0 +1,193 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "telemetry_api.h"
+
+/*
+ * Live view of the periodic-task telemetry published by chipi_chapa,
+ * seven_segment and buzzer_interrupt (see telemetry_api.h).
+ *
+ * Run: ./telemetry_top                 list programs publishing telemetry
+ *      ./telemetry_top seven_segment   watch one (refreshes every 500 ms)
+ *      ./telemetry_top -1 chipi_chapa  print one snapshot and exit
+ *
+ * Needs no privileges: the segment is world-readable.
+ */
+
+#define REFRESH_MS 500
+
+static volatile sig_atomic_t stop = 0;
+
+static void handle_sigint(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static void list_programs(void) {
+    glob_t g;
+    if (glob("/dev/shm/telemetry.*", 0, NULL, &g) != 0) {
+        printf("No programs are publishing telemetry\n");
+        return;
+    }
+    for (size_t i = 0; i < g.gl_pathc; i++) {
+        printf("%s\n", g.gl_pathv[i] + strlen("/dev/shm/telemetry."));
+    }
+    globfree(&g);
+}
+
+static const struct telemetry_segment *map_segment(const char *program) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%s", TELEMETRY_SHM_PREFIX, program);
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        perror(name);
+        return NULL;
+    }
+
+    const struct telemetry_segment *seg =
+        mmap(NULL, sizeof(*seg), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (seg == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+
+    if (seg->magic != TELEMETRY_MAGIC || seg->version != TELEMETRY_VERSION) {
+        fprintf(stderr, "%s: not a telemetry segment (or still starting)\n", name);
+        munmap((void *)seg, sizeof(*seg));
+        return NULL;
+    }
+    return seg;
+}
+
+static uint64_t load_u64(const _Atomic uint64_t *v) {
+    return atomic_load_explicit(v, memory_order_relaxed);
+}
+
+static int64_t load_i64(const _Atomic int64_t *v) {
+    return atomic_load_explicit(v, memory_order_relaxed);
+}
+
+// Snapshot of a task taken once per refresh, used to compute rates
+struct task_snapshot {
+    uint64_t ticks;
+    uint64_t overruns;
+    uint64_t hist[TELEMETRY_BUCKETS];
+};
+
+static void take_snapshot(const struct telemetry_task *t, struct task_snapshot *s) {
+    s->ticks = load_u64(&t->ticks);
+    s->overruns = load_u64(&t->overruns);
+    for (int b = 0; b < TELEMETRY_BUCKETS; b++) {
+        s->hist[b] = load_u64(&t->error_hist[b]);
+    }
+}
+
+static void print_task(const struct telemetry_task *t, const struct task_snapshot *now,
+                       const struct task_snapshot *prev, double dt_s) {
+    int64_t period = load_i64(&t->period_ns);
+    uint64_t ticks = now->ticks;
+    double rate = dt_s > 0 ? (now->ticks - prev->ticks) / dt_s : 0.0;
+    double nominal = period > 0 ? 1e9 / period : 0.0;
+
+    printf("%-16s %9.1f us %10.1f/s (%.0f/s) %10llu ticks %8llu overruns\n",
+           t->name, period / 1e3, rate, nominal,
+           (unsigned long long)ticks, (unsigned long long)now->overruns);
+    printf("%-16s max late %.1f us, runtime mean %.2f us / max %.1f us\n", "",
+           load_i64(&t->max_late_ns) / 1e3,
+           ticks ? load_i64(&t->sum_runtime_ns) / 1e3 / ticks : 0.0,
+           load_i64(&t->max_runtime_ns) / 1e3);
+
+    // Period error histogram: total, plus the share seen since the last refresh
+    uint64_t peak = 1, recent_total = 0;
+    for (int b = 0; b < TELEMETRY_BUCKETS; b++) {
+        if (now->hist[b] > peak) peak = now->hist[b];
+        recent_total += now->hist[b] - prev->hist[b];
+    }
+    for (int b = 0; b < TELEMETRY_BUCKETS; b++) {
+        if (now->hist[b] == 0) continue;
+        long lo = b ? 1L << (b - 1) : 0;
+        int width = (int)(now->hist[b] * 30 / peak);
+        double recent = recent_total ? 100.0 * (now->hist[b] - prev->hist[b]) / recent_total : 0.0;
+        if (b == TELEMETRY_BUCKETS - 1) {
+            printf("%-16s  >=%-9ld us %10llu %5.1f%% |%.*s\n", "", lo,
+                   (unsigned long long)now->hist[b], recent, width,
+                   "##############################");
+        } else {
+            printf("%-16s %5ld-%-6ld us %10llu %5.1f%% |%.*s\n", "", lo, 1L << b,
+                   (unsigned long long)now->hist[b], recent, width,
+                   "##############################");
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int once = 0;
+    const char *program = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-1") == 0) once = 1;
+        else program = argv[i];
+    }
+
+    if (!program) {
+        list_programs();
+        return 0;
+    }
+
+    const struct telemetry_segment *seg = map_segment(program);
+    if (!seg) {
+        return 1;
+    }
+
+    signal(SIGINT, handle_sigint);
+
+    // Baseline snapshot so the first screen already shows live rates
+    struct task_snapshot prev[TELEMETRY_MAX_TASKS], cur[TELEMETRY_MAX_TASKS];
+    for (uint32_t i = 0; i < TELEMETRY_MAX_TASKS; i++) {
+        take_snapshot(&seg->tasks[i], &prev[i]);
+    }
+    struct timespec last;
+    clock_gettime(CLOCK_MONOTONIC, &last);
+    usleep(REFRESH_MS * 1000);
+
+    while (!stop) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double dt = (now.tv_sec - last.tv_sec) + (now.tv_nsec - last.tv_nsec) / 1e9;
+        last = now;
+
+        uint32_t n = atomic_load(&seg->num_tasks);
+        if (n > TELEMETRY_MAX_TASKS) n = TELEMETRY_MAX_TASKS;
+        int alive = kill(seg->pid, 0) == 0 || errno == EPERM;
+
+        if (!once) printf("\033[H\033[2J");
+        printf("%s (pid %d%s)  period error = interval between ticks - period,"
+               " %% = share since last refresh\n\n",
+               seg->program, seg->pid, alive ? "" : ", exited");
+
+        for (uint32_t i = 0; i < n; i++) {
+            take_snapshot(&seg->tasks[i], &cur[i]);
+            print_task(&seg->tasks[i], &cur[i], &prev[i], dt);
+            prev[i] = cur[i];
+        }
+        fflush(stdout);
+
+        if (once || !alive) break;
+        usleep(REFRESH_MS * 1000);
+    }
+
+    munmap((void *)seg, sizeof(*seg));
+    return 0;
+}
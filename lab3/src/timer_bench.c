@@ -0,0 +1,236 @@
+#define _GNU_SOURCE
+#include <gpiod.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "rt_api.h"
+#include "periodic_api.h"
+
+/*
+ * Periodic tick benchmark: SIGRTMIN timer handler vs timer thread.
+ *
+ * For each audio rate, runs the old design (POSIX timer delivering
+ * SIGRTMIN to a handler) and the new one (periodic_api thread sleeping with
+ * clock_nanosleep(TIMER_ABSTIME)) for RUN_MS each, and reports:
+ *
+ *   ticks     callbacks actually run (expected = rate * seconds)
+ *   overrun   expirations lost (si_overrun for signals, skipped deadlines
+ *             for the thread)
+ *   mean/max  lateness of each tick against its ideal time
+ *   cpu/tick  user+system CPU time of the whole process per tick
+ *
+ * By default each tick only bumps a counter, so it runs on any Linux host.
+ * With -g PIN each tick also toggles that GPIO, like chipi_chapa does.
+ *
+ * Run: sudo ./timer_bench [-g pin] [-t run_ms] [--rt] [--rt-prio=N] [--rt-cpu=N]
+ */
+
+#define CHIP "/dev/gpiochip4"
+#define RUN_MS 1000
+
+static const long RATES[] = {8000, 11025, 16000, 22050, 32000, 44100, 48000};
+static const int NUM_RATES = sizeof(RATES) / sizeof(RATES[0]);
+
+struct bench_result {
+    long ticks;
+    long overruns;
+    struct rt_jitter jitter;
+    double cpu_ns_per_tick;
+};
+
+static struct gpiod_line *out = NULL;
+static int level = 0;
+static volatile long sig_ticks = 0;
+static volatile long sig_overruns = 0;
+static struct rt_jitter sig_jitter;
+
+static void do_tick(void) {
+    if (out) {
+        gpiod_line_set_value(out, level);
+        level = !level;
+    }
+}
+
+static void tick_handler(int sig, siginfo_t *si, void *uc) {
+    (void)sig;
+    (void)uc;
+    rt_jitter_tick(&sig_jitter);
+    sig_overruns += si->si_overrun;
+    do_tick();
+    sig_ticks++;
+}
+
+static int thread_tick(void *arg) {
+    (void)arg;
+    do_tick();
+    return 0;
+}
+
+static long long cpu_ns(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL;
+}
+
+static void sleep_ms(int ms) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    end.tv_sec += ms / 1000;
+    end.tv_nsec += (ms % 1000) * 1000000L;
+    if (end.tv_nsec >= 1000000000L) {
+        end.tv_sec++;
+        end.tv_nsec -= 1000000000L;
+    }
+    // Timer signals interrupt the sleep; keep going until the deadline
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &end, NULL) != 0) {
+    }
+}
+
+static int run_signal(timer_t timerid, long rate, int run_ms, struct bench_result *r) {
+    long interval_ns = 1000000000L / rate;
+    struct itimerspec its;
+    its.it_interval.tv_sec = 0;
+    its.it_interval.tv_nsec = interval_ns;
+    its.it_value = its.it_interval;
+
+    sig_ticks = 0;
+    sig_overruns = 0;
+    long long cpu0 = cpu_ns();
+    rt_jitter_start(&sig_jitter, interval_ns);
+    if (timer_settime(timerid, 0, &its, NULL) == -1) {
+        perror("timer_settime");
+        return -1;
+    }
+
+    sleep_ms(run_ms);
+
+    struct itimerspec off = {0};
+    timer_settime(timerid, 0, &off, NULL);
+    long long cpu = cpu_ns() - cpu0;
+
+    r->ticks = sig_ticks;
+    r->overruns = sig_overruns;
+    r->jitter = sig_jitter;
+    r->cpu_ns_per_tick = r->ticks ? (double)cpu / r->ticks : 0.0;
+    return 0;
+}
+
+static int run_thread(long rate, int run_ms, struct bench_result *r) {
+    struct periodic_task task;
+    long long cpu0 = cpu_ns();
+    if (periodic_start(&task, 1000000000L / rate, thread_tick, NULL, &r->jitter, NULL) < 0) {
+        perror("periodic_start");
+        return -1;
+    }
+
+    sleep_ms(run_ms);
+
+    periodic_stop(&task);
+    long long cpu = cpu_ns() - cpu0;
+
+    r->ticks = atomic_load(&task.ticks);
+    r->overruns = atomic_load(&task.overruns);
+    r->cpu_ns_per_tick = r->ticks ? (double)cpu / r->ticks : 0.0;
+    return 0;
+}
+
+static void print_row(const char *name, const struct bench_result *r) {
+    const struct rt_jitter *j = &r->jitter;
+    printf(" %-7s %8ld %8ld %9.1f %9.1f %9.2f", name, r->ticks, r->overruns,
+           j->count ? (double)j->sum_ns / j->count / 1e3 : 0.0,
+           j->max_ns / 1e3, r->cpu_ns_per_tick / 1e3);
+}
+
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        return 1;
+    }
+
+    int gpio_pin = -1;
+    int run_ms = RUN_MS;
+    int opt;
+    while ((opt = getopt(argc, argv, "g:t:")) != -1) {
+        switch (opt) {
+        case 'g': gpio_pin = atoi(optarg); break;
+        case 't': run_ms = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-g pin] [-t run_ms] [--rt] [--rt-prio=N] [--rt-cpu=N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (run_ms <= 0) {
+        run_ms = RUN_MS;
+    }
+
+    struct gpiod_chip *chip = NULL;
+    if (gpio_pin >= 0) {
+        chip = gpiod_chip_open(CHIP);
+        if (!chip) {
+            perror("gpiod_chip_open");
+            return 1;
+        }
+        out = gpiod_chip_get_line(chip, gpio_pin);
+        if (!out || gpiod_line_request_output(out, "timer_bench", 0) < 0) {
+            perror("timer_bench output");
+            gpiod_chip_close(chip);
+            return 1;
+        }
+    }
+
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete\n");
+    }
+
+    struct sigaction sa;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sa.sa_sigaction = tick_handler;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGRTMIN, &sa, NULL) == -1) {
+        perror("sigaction");
+        return 1;
+    }
+
+    timer_t timerid;
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_SIGNAL;
+    sev.sigev_signo = SIGRTMIN;
+    sev.sigev_value.sival_ptr = &timerid;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &timerid) == -1) {
+        perror("timer_create");
+        return 1;
+    }
+
+    printf("Tick benchmark: %s mode, %d ms per run, %s\n\n", rt_mode_name(&rt), run_ms,
+           out ? "toggling GPIO" : "no GPIO");
+    printf("%7s %8s | %-7s %8s %8s %9s %9s %9s\n",
+           "rate", "expected", "design", "ticks", "overrun", "mean us", "max us", "cpu/tick");
+
+    for (int i = 0; i < NUM_RATES; i++) {
+        struct bench_result sig = {0}, thr = {0};
+        if (run_signal(timerid, RATES[i], run_ms, &sig) < 0 ||
+            run_thread(RATES[i], run_ms, &thr) < 0) {
+            break;
+        }
+
+        long expected = RATES[i] * run_ms / 1000;
+        printf("%7ld %8ld |", RATES[i], expected);
+        print_row("signal", &sig);
+        printf("\n%7s %8s |", "", "");
+        print_row("thread", &thr);
+        printf("\n");
+        fflush(stdout);
+    }
+
+    timer_delete(timerid);
+    if (out) gpiod_line_release(out);
+    if (chip) gpiod_chip_close(chip);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "trace_api.h"
+
+/*
+ * Converts a binary trace dump (see trace_api.h) to Chrome trace JSON,
+ * which chrome://tracing and ui.perfetto.dev open directly.
+ *
+ * Run: ./trace2json /tmp/scroll.trace > scroll.json
+ *
+ * Timestamps are made relative to the earliest record so the timeline
+ * starts at zero; each thread becomes one track, named after the thread.
+ */
+
+static int read_exact(FILE *f, void *buf, size_t len) {
+    return fread(buf, 1, len, f) == len ? 0 : -1;
+}
+
+// JSON-escape a thread name (comm names are short and mostly printable)
+static void print_json_string(const char *s, size_t max) {
+    putchar('"');
+    for (size_t i = 0; i < max && s[i]; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\') {
+            printf("\\%c", c);
+        } else if (c < 0x20) {
+            printf("\\u%04x", c);
+        } else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s trace_file > trace.json\n", argv[0]);
+        return 1;
+    }
+
+    FILE *f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    struct trace_dump_header hdr;
+    if (read_exact(f, &hdr, sizeof(hdr)) < 0 ||
+        hdr.magic != TRACE_MAGIC || hdr.version != TRACE_VERSION) {
+        fprintf(stderr, "%s: not a trace dump\n", argv[1]);
+        fclose(f);
+        return 1;
+    }
+
+    // Load everything first: the base timestamp is the minimum over all rings
+    struct trace_dump_ring *rh = calloc(hdr.num_rings ? hdr.num_rings : 1, sizeof(*rh));
+    struct trace_record **recs = calloc(hdr.num_rings ? hdr.num_rings : 1, sizeof(*recs));
+    if (!rh || !recs) {
+        perror("calloc");
+        fclose(f);
+        return 1;
+    }
+
+    uint64_t base = UINT64_MAX;
+    for (uint32_t i = 0; i < hdr.num_rings; i++) {
+        if (read_exact(f, &rh[i], sizeof(rh[i])) < 0 || rh[i].count > TRACE_RING_SIZE) {
+            fprintf(stderr, "%s: truncated ring header\n", argv[1]);
+            fclose(f);
+            return 1;
+        }
+        recs[i] = malloc((rh[i].count ? rh[i].count : 1) * sizeof(struct trace_record));
+        if (!recs[i] || read_exact(f, recs[i], rh[i].count * sizeof(struct trace_record)) < 0) {
+            fprintf(stderr, "%s: truncated ring data\n", argv[1]);
+            fclose(f);
+            return 1;
+        }
+        if (rh[i].count > 0 && recs[i][0].ts_ns < base) {
+            base = recs[i][0].ts_ns;
+        }
+    }
+    fclose(f);
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    int first = 1;
+
+    for (uint32_t i = 0; i < hdr.num_rings; i++) {
+        printf("%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32
+               ",\"args\":{\"name\":", first ? "" : ",\n", hdr.pid, rh[i].tid);
+        print_json_string(rh[i].name, TRACE_NAME_LEN);
+        printf("}}");
+        first = 0;
+
+        if (rh[i].dropped > 0) {
+            fprintf(stderr, "thread %" PRIu32 ": %" PRIu64 " older records were overwritten\n",
+                    rh[i].tid, rh[i].dropped);
+        }
+
+        for (uint32_t k = 0; k < rh[i].count; k++) {
+            const struct trace_record *r = &recs[i][k];
+            uint64_t ts = r->ts_ns - base;
+            char ph = (char)r->phase;
+
+            printf(",\n{\"name\":\"%s\",\"cat\":\"gpio\",\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03" PRIu64
+                   ",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32,
+                   trace_id_name(r->id), ph, ts / 1000, ts % 1000, hdr.pid, rh[i].tid);
+            if (ph == TRACE_PH_INSTANT) {
+                printf(",\"s\":\"t\"");
+            }
+            printf(",\"args\":{\"arg\":%" PRIu32 "}}", r->arg);
+        }
+        free(recs[i]);
+    }
+
+    printf("\n]}\n");
+    free(recs);
+    free(rh);
+    return 0;
+}
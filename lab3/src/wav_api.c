@@ -0,0 +1,426 @@
+#define _GNU_SOURCE
+#include "wav_api.h"
+#include "adpcm_api.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// KSDATAFORMAT_SUBTYPE_* GUIDs share everything after the format tag
+static const uint8_t subformat_tail[14] = {
+    0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+};
+
+// ADPCM decode buffer: one block of mono samples
+struct wav_block_cache {
+    size_t block;               // Block held, or SIZE_MAX
+    size_t frames;
+    int16_t samples[];
+};
+
+static uint16_t get16(const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t get32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Reads the fmt chunk body, resolving WAVE_FORMAT_EXTENSIBLE
+static int parse_fmt(struct wav *w, const uint8_t *body, size_t size) {
+    w->audio_format = get16(body);
+    w->num_channels = get16(body + 2);
+    w->sample_rate = get32(body + 4);
+    w->block_align = get16(body + 12);
+    w->bits_per_sample = get16(body + 14);
+    w->valid_bits = w->bits_per_sample;
+    w->frames_per_block = 1;
+
+    if (w->audio_format == WAV_FORMAT_IMA_ADPCM) {
+        // cbSize, wSamplesPerBlock; derived from block_align if missing
+        w->frames_per_block = adpcm_samples_per_block(w->block_align, w->num_channels);
+        if (size >= 20 && get16(body + 16) >= 2 && get16(body + 18) != 0) {
+            if (get16(body + 18) > w->frames_per_block) {
+                return -1;
+            }
+            w->frames_per_block = get16(body + 18);
+        }
+        return 0;
+    }
+    if (w->audio_format == WAV_FORMAT_EXTENSIBLE) {
+        // cbSize, wValidBitsPerSample, dwChannelMask, SubFormat GUID
+        if (size < 40 || get16(body + 16) < 22 ||
+            memcmp(body + 26, subformat_tail, sizeof(subformat_tail)) != 0) {
+            return -1;
+        }
+        if (get16(body + 18) != 0) {
+            w->valid_bits = get16(body + 18);
+        }
+        w->audio_format = get16(body + 24);
+    }
+    return 0;
+}
+
+// Checks the format fields and fills in the derived ones
+static int check_format(struct wav *w, size_t fact_frames) {
+    unsigned bytes = w->bits_per_sample / 8u;
+
+    if (w->audio_format == WAV_FORMAT_IMA_ADPCM) {
+        if (w->num_channels == 0 || w->num_channels > WAV_MAX_CHANNELS ||
+            w->sample_rate == 0 || w->bits_per_sample != 4 ||
+            w->block_align > ADPCM_MAX_BLOCK_ALIGN || w->frames_per_block == 0) {
+            return -1;
+        }
+        // Whole blocks, then what a cut last block holds; the fact chunk,
+        // if there is one, trims the padding of the last block
+        size_t blocks = w->data_size / w->block_align;
+        size_t tail = adpcm_block_frames(w->data_size % w->block_align, w->num_channels);
+        w->encoding = WAV_IMA_ADPCM;
+        w->num_frames = blocks * w->frames_per_block +
+                        (tail < w->frames_per_block ? tail : w->frames_per_block);
+        if (fact_frames < w->num_frames) {
+            w->num_frames = fact_frames;
+        }
+        return 0;
+    }
+    if (w->num_channels == 0 || w->num_channels > WAV_MAX_CHANNELS ||
+        w->sample_rate == 0 || w->bits_per_sample % 8 != 0 ||
+        w->valid_bits == 0 || w->valid_bits > w->bits_per_sample ||
+        w->block_align < w->num_channels * bytes) {
+        return -1;
+    }
+    if (w->audio_format == WAV_FORMAT_PCM) {
+        switch (w->bits_per_sample) {
+        case 8: w->encoding = WAV_U8; break;
+        case 16: w->encoding = WAV_S16; break;
+        case 24: w->encoding = WAV_S24; break;
+        case 32: w->encoding = WAV_S32; break;
+        default: return -1;
+        }
+    } else if (w->audio_format == WAV_FORMAT_IEEE_FLOAT) {
+        switch (w->bits_per_sample) {
+        case 32: w->encoding = WAV_F32; break;
+        case 64: w->encoding = WAV_F64; break;
+        default: return -1;
+        }
+    } else {
+        return -1;
+    }
+    w->num_frames = w->data_size / w->block_align;
+    return 0;
+}
+
+// Walks the chunks of a RIFF/WAVE file held in memory
+static int parse(struct wav *w, const uint8_t *buf, size_t len) {
+    int have_fmt = 0, have_data = 0;
+    size_t fact_frames = SIZE_MAX;
+
+    if (len < 12 || memcmp(buf, "RIFF", 4) != 0 || memcmp(buf + 8, "WAVE", 4) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    size_t off = 12;
+    while (off + 8 <= len && !(have_fmt && have_data)) {
+        const uint8_t *chunk = buf + off;
+        size_t size = get32(chunk + 4);
+        size_t body = off + 8;
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && !have_fmt) {
+            if (size < 16 || size > len - body || parse_fmt(w, chunk + 8, size) < 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            have_fmt = 1;
+        } else if (memcmp(chunk, "data", 4) == 0 && !have_data) {
+            w->data = chunk + 8;
+            w->data_size = size < len - body ? size : len - body;
+            have_data = 1;
+        } else if (memcmp(chunk, "fact", 4) == 0 && size >= 4 && size <= len - body) {
+            fact_frames = get32(chunk + 8);
+        }
+        if (size > len - body) {
+            break;      // Truncated file; the data chunk, if any, is cut above
+        }
+        off = body + size + (size & 1);     // Chunks are word aligned
+    }
+
+    if (!have_fmt || !have_data || check_format(w, fact_frames) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (w->encoding == WAV_IMA_ADPCM) {
+        // Room for everything a block can hold, even if the header says
+        // fewer frames are used
+        size_t frames = adpcm_samples_per_block(w->block_align, w->num_channels);
+        w->cache = malloc(sizeof(*w->cache) + sizeof(int16_t) * frames);
+        if (!w->cache) {
+            return -1;
+        }
+        w->cache->block = SIZE_MAX;
+        w->cache->frames = 0;
+    }
+    return 0;
+}
+
+int wav_parse(struct wav *w, const void *buf, size_t len) {
+    memset(w, 0, sizeof(*w));
+    return parse(w, buf, len);
+}
+
+int wav_open(struct wav *w, const char *path) {
+    memset(w, 0, sizeof(*w));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);      // The mapping keeps the file open
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    w->map = map;
+    w->map_size = (size_t)st.st_size;
+    if (parse(w, map, w->map_size) < 0) {
+        int err = errno;
+        wav_close(w);
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+int wav_load(struct wav *w, const char *path) {
+    memset(w, 0, sizeof(*w));
+
+    FILE *wav_file = fopen(path, "rb");
+    if (!wav_file) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fileno(wav_file), &st) < 0) {
+        fclose(wav_file);
+        return -1;
+    }
+
+    // Read the whole file, then parse it like a mapped one
+    size_t len = (size_t)st.st_size;
+    w->buffer = malloc(len ? len : 1);
+    if (!w->buffer) {
+        fclose(wav_file);
+        return -1;
+    }
+    size_t bytes_read = fread(w->buffer, 1, len, wav_file);
+    fclose(wav_file);
+    if (bytes_read != len) {
+        wav_close(w);
+        errno = EIO;
+        return -1;
+    }
+    if (parse(w, w->buffer, len) < 0) {
+        wav_close(w);
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+// Per-format sample loaders, scaled to Q15. Each is a few instructions on
+// an unaligned load, so the loops below stay branch-free
+static inline int32_t load_u8(const uint8_t *p) {
+    return ((int32_t)p[0] - 128) * 256;
+}
+
+static inline int32_t load_s16(const uint8_t *p) {
+    int16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline int32_t load_s24(const uint8_t *p) {
+    return (int16_t)(p[1] | p[2] << 8);     // Top 16 of the 24 bits
+}
+
+static inline int32_t load_s32(const uint8_t *p) {
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v >> 16;
+}
+
+static inline int32_t float_to_q15(float f) {
+    float v = f * 32768.0f;
+    if (!(v >= -32768.0f)) v = -32768.0f;   // Also catches NaN
+    if (v > 32767.0f) v = 32767.0f;
+    return (int32_t)v;
+}
+
+static inline int32_t load_f32(const uint8_t *p) {
+    float f;
+    memcpy(&f, p, sizeof(f));
+    return float_to_q15(f);
+}
+
+static inline int32_t load_f64(const uint8_t *p) {
+    double d;
+    memcpy(&d, p, sizeof(d));
+    return float_to_q15((float)d);
+}
+
+// One converter per encoding: a tight loop for packed mono and stereo
+// (the files we play), a generic averaging loop for anything else
+#define WAV_CONVERTER(name, load, width)                                        \
+    static void name(const uint8_t *p, size_t stride, unsigned channels,        \
+                     int16_t *out, size_t count) {                              \
+        if (channels == 1 && stride == (width)) {                               \
+            for (size_t i = 0; i < count; i++) {                                \
+                out[i] = (int16_t)load(p + i * (width));                        \
+            }                                                                   \
+        } else if (channels == 2 && stride == 2 * (width)) {                    \
+            for (size_t i = 0; i < count; i++) {                                \
+                const uint8_t *f = p + i * 2 * (width);                         \
+                out[i] = (int16_t)((load(f) + load(f + (width))) >> 1);         \
+            }                                                                   \
+        } else {                                                                \
+            for (size_t i = 0; i < count; i++) {                                \
+                const uint8_t *f = p + i * stride;                              \
+                int32_t sum = 0;                                                \
+                for (unsigned c = 0; c < channels; c++) {                       \
+                    sum += load(f + c * (width));                               \
+                }                                                               \
+                out[i] = (int16_t)(sum / (int32_t)channels);                    \
+            }                                                                   \
+        }                                                                       \
+    }
+
+WAV_CONVERTER(convert_u8, load_u8, 1)
+WAV_CONVERTER(convert_s16, load_s16, 2)
+WAV_CONVERTER(convert_s24, load_s24, 3)
+WAV_CONVERTER(convert_s32, load_s32, 4)
+WAV_CONVERTER(convert_f32, load_f32, 4)
+WAV_CONVERTER(convert_f64, load_f64, 8)
+
+// Copies frames out of ADPCM blocks, decoding each block once into the
+// cache. A block decodes in one pass wherever the run starts in it
+static size_t read_adpcm(const struct wav *w, size_t frame, int16_t *out, size_t count) {
+    struct wav_block_cache *c = w->cache;
+    size_t done = 0;
+    while (done < count) {
+        size_t block = (frame + done) / w->frames_per_block;
+        size_t offset = (frame + done) % w->frames_per_block;
+        if (c->block != block) {
+            size_t start = block * w->block_align;
+            size_t bytes = w->data_size - start < w->block_align ? w->data_size - start
+                                                                  : w->block_align;
+            c->frames = adpcm_decode_block(w->data + start, bytes, w->num_channels, c->samples);
+            if (c->frames > w->frames_per_block) {
+                c->frames = w->frames_per_block;
+            }
+            c->block = block;
+        }
+        if (offset >= c->frames) {
+            break;
+        }
+        size_t n = c->frames - offset;
+        if (n > count - done) {
+            n = count - done;
+        }
+        memcpy(out + done, c->samples + offset, sizeof(int16_t) * n);
+        done += n;
+    }
+    return done;
+}
+
+size_t wav_read(const struct wav *w, size_t frame, int16_t *out, size_t count) {
+    if (frame >= w->num_frames) {
+        return 0;
+    }
+    if (count > w->num_frames - frame) {
+        count = w->num_frames - frame;
+    }
+    if (w->encoding == WAV_IMA_ADPCM) {
+        return read_adpcm(w, frame, out, count);
+    }
+    const uint8_t *p = w->data + frame * w->block_align;
+    switch (w->encoding) {
+    case WAV_U8: convert_u8(p, w->block_align, w->num_channels, out, count); break;
+    case WAV_S16: convert_s16(p, w->block_align, w->num_channels, out, count); break;
+    case WAV_S24: convert_s24(p, w->block_align, w->num_channels, out, count); break;
+    case WAV_S32: convert_s32(p, w->block_align, w->num_channels, out, count); break;
+    case WAV_F32: convert_f32(p, w->block_align, w->num_channels, out, count); break;
+    case WAV_F64: convert_f64(p, w->block_align, w->num_channels, out, count); break;
+    case WAV_IMA_ADPCM: break;
+    }
+    return count;
+}
+
+const char *wav_encoding_name(enum wav_encoding encoding) {
+    switch (encoding) {
+    case WAV_U8: return "u8";
+    case WAV_S16: return "s16";
+    case WAV_S24: return "s24";
+    case WAV_S32: return "s32";
+    case WAV_F32: return "f32";
+    case WAV_F64: return "f64";
+    case WAV_IMA_ADPCM: return "ima-adpcm";
+    }
+    return "?";
+}
+
+void wav_stream(struct wav *w, size_t frame) {
+    if (!w->map) {
+        return;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t pos = (size_t)(w->data - (const uint8_t *)w->map) +
+                 frame / w->frames_per_block * w->block_align;
+
+    // Touch the pages ahead so the sample task finds them mapped
+    size_t ahead = pos + WAV_STREAM_AHEAD;
+    if (ahead > w->map_size) ahead = w->map_size;
+    if (w->mapped_to < pos) w->mapped_to = pos & ~(page - 1);
+    const volatile uint8_t *p = w->map;
+    for (; w->mapped_to < ahead; w->mapped_to += page) {
+        (void)p[w->mapped_to];
+    }
+
+    // Release what was played; fails harmlessly (EINVAL) on locked memory
+    if (pos > WAV_STREAM_BEHIND) {
+        size_t behind = (pos - WAV_STREAM_BEHIND) & ~(page - 1);
+        if (behind > w->released_to &&
+            madvise((uint8_t *)w->map + w->released_to, behind - w->released_to,
+                    MADV_DONTNEED) == 0) {
+            w->released_to = behind;
+        }
+    }
+}
+
+void wav_close(struct wav *w) {
+    if (w->map) {
+        munmap(w->map, w->map_size);
+    }
+    free(w->buffer);
+    free(w->cache);
+    memset(w, 0, sizeof(*w));
+}
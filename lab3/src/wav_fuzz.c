@@ -0,0 +1,401 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "wav_api.h"
+#include "adpcm_api.h"
+
+/*
+ * Mutation fuzzer for the WAV parser and converter.
+ *
+ * Seeds are the WAV files given on the command line plus generated files
+ * covering every encoding wav_api accepts (8/16/24/32-bit PCM, 32/64-bit
+ * float, WAVE_FORMAT_EXTENSIBLE, IMA ADPCM with a cut last block, 1-6
+ * channels, an odd-sized chunk before the data). Each iteration takes a seed and flips bytes, rewrites chunk
+ * sizes, truncates or extends it, then runs wav_parse() and converts every
+ * frame with wav_read(). A mutant that crashes, or that parses to a data
+ * region outside the buffer, is written to wav_fuzz_crash.wav.
+ *
+ * Build with ASan/UBSan to catch out-of-bounds reads, e.g.
+ *   gcc -g -fsanitize=address,undefined -Iinclude src/wav_fuzz.c src/wav_api.c \
+ *       src/adpcm_api.c
+ * or with -DWAV_FUZZ_LIBFUZZER -fsanitize=fuzzer to drive the same check
+ * from libFuzzer instead of the built-in mutator.
+ *
+ * Run: ./wav_fuzz [-n iterations] [-s seed] [file.wav ...]
+ */
+
+#define DEFAULT_ITERATIONS 200000
+#define MAX_SEEDS 32
+#define MAX_SEED_BYTES (1 << 20)    // Larger files are cut to this
+#define MAX_MUTATIONS 8
+#define GEN_FRAMES 97               // Odd, so packed 8-bit mono data is odd-sized
+
+struct seed {
+    uint8_t *data;
+    size_t len;
+    char name[64];
+};
+
+static struct seed seeds[MAX_SEEDS];
+static int num_seeds;
+static int16_t scratch[4096];
+
+// Parses and converts one input; returns -1 if the result is inconsistent
+static int check_one(const uint8_t *buf, size_t len) {
+    struct wav w;
+    if (wav_parse(&w, buf, len) < 0) {
+        return 0;
+    }
+    // PCM frames must lie inside the data; ADPCM blocks must start there
+    // (the last may be cut)
+    size_t last_block = w.num_frames ? (w.num_frames - 1) / w.frames_per_block : 0;
+    if (w.data < buf || w.data + w.data_size > buf + len ||
+        (w.encoding != WAV_IMA_ADPCM ? w.num_frames * w.block_align > w.data_size
+                                 : w.num_frames && last_block * w.block_align >= w.data_size)) {
+        wav_close(&w);
+        return -1;
+    }
+    for (size_t frame = 0; frame < w.num_frames; ) {
+        size_t n = wav_read(&w, frame, scratch, sizeof(scratch) / sizeof(scratch[0]));
+        if (n == 0) {
+            wav_close(&w);
+            return -1;
+        }
+        frame += n;
+    }
+    wav_close(&w);
+    return 0;
+}
+
+#ifdef WAV_FUZZ_LIBFUZZER
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (check_one(data, size) < 0) {
+        abort();
+    }
+    return 0;
+}
+
+#else
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static void put16(uint8_t *p, uint16_t v) { memcpy(p, &v, sizeof(v)); }
+static void put32(uint8_t *p, uint32_t v) { memcpy(p, &v, sizeof(v)); }
+
+static void add_seed(uint8_t *data, size_t len, const char *name) {
+    if (num_seeds == MAX_SEEDS) {
+        free(data);
+        return;
+    }
+    seeds[num_seeds].data = data;
+    seeds[num_seeds].len = len;
+    snprintf(seeds[num_seeds].name, sizeof(seeds[num_seeds].name), "%s", name);
+    num_seeds++;
+}
+
+// Builds a small WAV file holding a sine in the given encoding
+static void make_seed(uint16_t format, int bits, int channels, int extensible) {
+    int bytes = bits / 8;
+    size_t data_size = (size_t)GEN_FRAMES * channels * bytes;
+    size_t fmt_size = extensible ? 40 : 16;
+    size_t len = 12 + 8 + fmt_size + 8 + 3 + 1 + 8 + data_size + (data_size & 1);
+    uint8_t *buf = calloc(1, len);
+    if (!buf) {
+        return;
+    }
+
+    memcpy(buf, "RIFF", 4);
+    put32(buf + 4, (uint32_t)(len - 8));
+    memcpy(buf + 8, "WAVE", 4);
+    uint8_t *p = buf + 12;
+    memcpy(p, "fmt ", 4);
+    put32(p + 4, (uint32_t)fmt_size);
+    put16(p + 8, extensible ? WAV_FORMAT_EXTENSIBLE : format);
+    put16(p + 10, (uint16_t)channels);
+    put32(p + 12, 48000);
+    put32(p + 16, (uint32_t)(48000 * channels * bytes));
+    put16(p + 20, (uint16_t)(channels * bytes));
+    put16(p + 22, (uint16_t)bits);
+    if (extensible) {
+        static const uint8_t tail[14] = {
+            0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+        };
+        put16(p + 24, 22);
+        put16(p + 26, (uint16_t)(bits == 32 && format == WAV_FORMAT_PCM ? 24 : bits));
+        put32(p + 28, (1u << channels) - 1);
+        put16(p + 32, format);
+        memcpy(p + 34, tail, sizeof(tail));
+    }
+    p += 8 + fmt_size;
+
+    // An odd-sized chunk the parser must skip, pad byte included
+    memcpy(p, "junk", 4);
+    put32(p + 4, 3);
+    memcpy(p + 8, "abc", 3);
+    p += 12;
+
+    memcpy(p, "data", 4);
+    put32(p + 4, (uint32_t)data_size);
+    p += 8;
+    for (int i = 0; i < GEN_FRAMES; i++) {
+        double v = 0.5 * sin(2 * M_PI * i / 16.0);
+        for (int c = 0; c < channels; c++, p += bytes) {
+            int32_t s = (int32_t)(v * 2147483647.0);
+            if (format == WAV_FORMAT_IEEE_FLOAT && bits == 32) {
+                float f = (float)v;
+                memcpy(p, &f, 4);
+            } else if (format == WAV_FORMAT_IEEE_FLOAT) {
+                memcpy(p, &v, 8);
+            } else if (bits == 8) {
+                p[0] = (uint8_t)((s >> 24) + 128);
+            } else {
+                for (int b = 0; b < bytes; b++) {
+                    p[b] = (uint8_t)(s >> (32 - 8 * bytes + 8 * b));
+                }
+            }
+        }
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "generated %s %d-bit x%d%s",
+             format == WAV_FORMAT_PCM ? "pcm" : "float", bits, channels,
+             extensible ? " extensible" : "");
+    add_seed(buf, len, name);
+}
+
+// Builds an IMA ADPCM file: a sine through the encoder for mono, hand-made
+// blocks for more channels, with the last block cut short
+static void make_adpcm_seed(int channels, unsigned block_align) {
+    if (channels == 1) {
+        int16_t in[3 * GEN_FRAMES];
+        for (int i = 0; i < 3 * GEN_FRAMES; i++) {
+            in[i] = (int16_t)(16000 * sin(2 * M_PI * i / 16.0));
+        }
+        size_t len;
+        uint8_t *buf = adpcm_wav_encode(in, 3 * GEN_FRAMES, 48000, block_align, &len);
+        if (buf) {
+            char name[64];
+            snprintf(name, sizeof(name), "generated ima-adpcm x1 block %u", block_align);
+            add_seed(buf, len, name);
+        }
+        return;
+    }
+
+    unsigned spb = adpcm_samples_per_block(block_align, (unsigned)channels);
+    size_t data_size = 2 * (size_t)block_align + 4 * (size_t)channels + 12;
+    size_t len = 12 + 8 + 20 + 8 + data_size + (data_size & 1);
+    uint8_t *buf = calloc(1, len);
+    if (!buf || spb == 0) {
+        free(buf);
+        return;
+    }
+    memcpy(buf, "RIFF", 4);
+    put32(buf + 4, (uint32_t)(len - 8));
+    memcpy(buf + 8, "WAVE", 4);
+    uint8_t *p = buf + 12;
+    memcpy(p, "fmt ", 4);
+    put32(p + 4, 20);
+    put16(p + 8, WAV_FORMAT_IMA_ADPCM);
+    put16(p + 10, (uint16_t)channels);
+    put32(p + 12, 48000);
+    put32(p + 16, 48000 * block_align / spb);
+    put16(p + 20, (uint16_t)block_align);
+    put16(p + 22, 4);
+    put16(p + 24, 2);
+    put16(p + 26, (uint16_t)spb);
+    p += 28;
+    memcpy(p, "data", 4);
+    put32(p + 4, (uint32_t)data_size);
+    p += 8;
+    for (size_t i = 0; i < data_size; i++) {
+        size_t in_block = i % block_align;
+        if (in_block < 4 * (size_t)channels) {
+            p[i] = in_block % 4 == 2 ? (uint8_t)(i % 89) : (uint8_t)(i * 37);
+        } else {
+            p[i] = (uint8_t)(i * 73 + 11);
+        }
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "generated ima-adpcm x%d block %u", channels, block_align);
+    add_seed(buf, len, name);
+}
+
+static void load_seed(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return;
+    }
+    uint8_t *buf = malloc(MAX_SEED_BYTES);
+    size_t len = buf ? fread(buf, 1, MAX_SEED_BYTES, f) : 0;
+    fclose(f);
+    if (!buf) {
+        return;
+    }
+    add_seed(buf, len, path);
+}
+
+// Offsets of the chunk size fields in a seed (RIFF size included)
+static size_t find_sizes(const uint8_t *buf, size_t len, size_t *offs, size_t max) {
+    size_t n = 0;
+    if (len >= 8) offs[n++] = 4;
+    for (size_t off = 12; off + 8 <= len && n < max; ) {
+        offs[n++] = off + 4;
+        uint32_t size;
+        memcpy(&size, buf + off + 4, sizeof(size));
+        if (size > len - off - 8) break;
+        off += 8 + size + (size & 1);
+    }
+    return n;
+}
+
+// Applies a few random mutations in place; returns the new length
+static size_t mutate(uint8_t *buf, size_t len, size_t cap) {
+    static const uint32_t sizes[] = {
+        0, 1, 2, 3, 15, 16, 17, 18, 39, 40, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFE, 0xFFFFFFFF
+    };
+    size_t offs[16];
+    int mutations = 1 + (int)(rng() % MAX_MUTATIONS);
+
+    for (int m = 0; m < mutations && len > 0; m++) {
+        switch (rng() % 6) {
+        case 0: {   // Flip a bit, mostly in the headers
+            size_t span = len < 128 || rng() % 4 == 0 ? len : 128;
+            buf[rng() % span] ^= (uint8_t)(1u << (rng() % 8));
+            break;
+        }
+        case 1:     // Random byte anywhere
+            buf[rng() % len] = (uint8_t)rng();
+            break;
+        case 2: {   // Rewrite a chunk size with an interesting value
+            size_t n = find_sizes(buf, len, offs, 16);
+            if (n) {
+                uint32_t v = rng() % 2 ? sizes[rng() % (sizeof(sizes) / sizeof(sizes[0]))]
+                                       : rng() % 4096;
+                put32(buf + offs[rng() % n], v);
+            }
+            break;
+        }
+        case 3: {   // Rewrite a format field
+            if (len >= 36) {
+                size_t field = 20 + 2 * (rng() % 8);
+                put16(buf + field, (uint16_t)(rng() % 3 ? rng() % 80 : rng()));
+            }
+            break;
+        }
+        case 4:     // Truncate
+            len = rng() % (len + 1);
+            break;
+        case 5: {   // Extend with garbage
+            size_t extra = rng() % 64;
+            if (len + extra > cap) extra = cap - len;
+            for (size_t i = 0; i < extra; i++) buf[len + i] = (uint8_t)rng();
+            len += extra;
+            break;
+        }
+        }
+    }
+    return len;
+}
+
+int main(int argc, char **argv) {
+    long iterations = DEFAULT_ITERATIONS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n': iterations = atol(optarg); break;
+        case 's': rng_state = strtoull(optarg, NULL, 0) | 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [-n iterations] [-s seed] [file.wav ...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (int i = optind; i < argc; i++) load_seed(argv[i]);
+    static const int pcm_bits[] = {8, 16, 24, 32};
+    for (int b = 0; b < 4; b++) make_seed(WAV_FORMAT_PCM, pcm_bits[b], 1 + b % 2, 0);
+    make_seed(WAV_FORMAT_PCM, 24, 6, 1);
+    make_seed(WAV_FORMAT_PCM, 32, 2, 1);
+    make_seed(WAV_FORMAT_IEEE_FLOAT, 32, 2, 0);
+    make_seed(WAV_FORMAT_IEEE_FLOAT, 64, 1, 0);
+    make_seed(WAV_FORMAT_IEEE_FLOAT, 32, 3, 1);
+    make_adpcm_seed(1, 64);
+    make_adpcm_seed(1, 256);
+    make_adpcm_seed(2, 72);
+    make_adpcm_seed(5, 140);
+
+    // Every seed must parse cleanly before it is mutated
+    int failed = 0;
+    for (int i = 0; i < num_seeds; i++) {
+        struct wav w;
+        if (wav_parse(&w, seeds[i].data, seeds[i].len) < 0) {
+            printf("seed %-40s does not parse\n", seeds[i].name);
+            failed = 1;
+            continue;
+        }
+        printf("seed %-40s %s x%u, %zu frames\n", seeds[i].name,
+               wav_encoding_name(w.encoding), w.num_channels, w.num_frames);
+        wav_close(&w);
+    }
+
+    size_t cap = MAX_SEED_BYTES + 64 * MAX_MUTATIONS;
+    uint8_t *buf = malloc(cap);
+    if (!buf || num_seeds == 0) {
+        fprintf(stderr, "No seeds\n");
+        return 1;
+    }
+
+    long parsed = 0;
+    for (long it = 0; it < iterations; it++) {
+        const struct seed *s = &seeds[rng() % (uint32_t)num_seeds];
+        memcpy(buf, s->data, s->len);
+        size_t len = mutate(buf, s->len, cap);
+
+        // Exact-size copy, so ASan sees reads past the end
+        uint8_t *input = malloc(len ? len : 1);
+        if (!input) {
+            perror("malloc");
+            return 1;
+        }
+        memcpy(input, buf, len);
+        struct wav w;
+        if (wav_parse(&w, input, len) == 0) {
+            parsed++;
+            wav_close(&w);
+        }
+        if (check_one(input, len) < 0) {
+            FILE *f = fopen("wav_fuzz_crash.wav", "wb");
+            if (f) {
+                fwrite(input, 1, len, f);
+                fclose(f);
+            }
+            printf("iteration %ld: inconsistent parse of a %s mutant, saved to "
+                   "wav_fuzz_crash.wav\n", it, s->name);
+            return 1;
+        }
+        free(input);
+    }
+
+    printf("%ld mutants, %ld parsed, %ld rejected, no failures\n",
+           iterations, parsed, iterations - parsed);
+    free(buf);
+    for (int i = 0; i < num_seeds; i++) free(seeds[i].data);
+    return failed;
+}
+
+#endif // WAV_FUZZ_LIBFUZZER
@@ -0,0 +1,96 @@
+#ifndef PERIODIC_API_H
+#define PERIODIC_API_H
+
+/**
+ * @file periodic_api.h
+ * @brief Periodic task runner on a dedicated thread
+ *
+ * Runs a callback at a fixed rate from its own thread, sleeping with
+ * clock_nanosleep(TIMER_ABSTIME) on CLOCK_MONOTONIC between ticks. Unlike
+ * a SIGRTMIN timer handler, the callback runs in normal thread context, so
+ * it may call libgpiod (which is not async-signal-safe), and each tick costs
+ * one wake-up instead of a signal frame setup and sigreturn.
+ *
+ * Deadlines are absolute, so a late tick does not shift the ones after it.
+ * When a tick runs so late that later deadlines have already passed, those
+ * deadlines are skipped and counted as overruns instead of firing back to
+ * back.
+ *
+ * The thread inherits the scheduling policy, priority and CPU affinity of
+ * the thread that starts it, so call rt_apply() first for real-time mode.
+ * It blocks all signals, so SIGINT and friends reach the main thread.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "rt_api.h"
+#include "telemetry_api.h"
+
+/**
+ * @brief Periodic callback
+ *
+ * @param arg The pointer passed to periodic_start()
+ * @return 0 to keep running, non-zero to stop the task
+ */
+typedef int (*periodic_fn)(void *arg);
+
+/**
+ * @brief State of one periodic task
+ */
+struct periodic_task {
+    pthread_t thread;           /**< Runner thread */
+    long long period_ns;        /**< Tick period */
+    periodic_fn fn;             /**< Callback */
+    void *arg;                  /**< Callback argument */
+    struct rt_jitter *jitter;   /**< Optional lateness statistics, or NULL */
+    struct telemetry_task *telemetry; /**< Optional live telemetry, or NULL */
+    atomic_int stop;            /**< Set to end the task */
+    atomic_int finished;        /**< Set by the runner when it exits */
+    atomic_long ticks;          /**< Callbacks run */
+    atomic_long overruns;       /**< Deadlines skipped because they had passed */
+};
+
+/**
+ * @brief Starts a periodic task
+ *
+ * The first tick is one period after the call.
+ *
+ * @param t Task state (owned by the caller, must outlive the task)
+ * @param period_ns Tick period in nanoseconds
+ * @param fn Callback run once per tick
+ * @param arg Passed to fn
+ * @param jitter If not NULL, reset and updated with each tick's lateness
+ * @param telemetry If not NULL, updated with period error, callback runtime
+ *        and overruns for telemetry_top
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int periodic_start(struct periodic_task *t, long long period_ns,
+                   periodic_fn fn, void *arg, struct rt_jitter *jitter,
+                   struct telemetry_task *telemetry);
+
+/**
+ * @brief Asks the task to stop and waits for the runner to exit
+ *
+ * Safe to call after the callback has already stopped the task. Call
+ * either this or periodic_join() once per task, not both.
+ *
+ * @param t The task
+ */
+void periodic_stop(struct periodic_task *t);
+
+/**
+ * @brief Waits until the callback stops the task by returning non-zero
+ *
+ * @param t The task
+ */
+void periodic_join(struct periodic_task *t);
+
+/**
+ * @brief Returns non-zero once the runner has exited
+ *
+ * @param t The task
+ */
+int periodic_finished(struct periodic_task *t);
+
+#endif // PERIODIC_API_H
@@ -0,0 +1,138 @@
+#ifndef RT_API_H
+#define RT_API_H
+
+/**
+ * @file rt_api.h
+ * @brief Real-time execution mode and period jitter statistics
+ *
+ * Timing-critical programs (audio playback, display multiplexing, tone
+ * generation) accept the same command line switches:
+ *
+ *   --rt            enable real-time mode
+ *   --rt-prio=N     SCHED_FIFO priority (default RT_DEFAULT_PRIORITY)
+ *   --rt-cpu=N      pin to CPU N (default: last isolated CPU, else last CPU)
+ *
+ * Real-time mode locks all current and future memory, disables heap
+ * trimming, prefaults the stack, pins the process to one CPU and switches
+ * it to SCHED_FIFO. Buffers allocated before rt_apply() are faulted in by
+ * mlockall(); rt_prefault() touches buffers allocated afterwards.
+ *
+ * struct rt_jitter measures how late each tick of a periodic handler runs
+ * relative to its ideal schedule, so the same program can be run with and
+ * without --rt and the two reports compared.
+ */
+
+#include <stddef.h>
+
+#define RT_DEFAULT_PRIORITY 80
+#define RT_PREFAULT_STACK (512 * 1024)  // Bytes of stack touched up front
+#define RT_JITTER_BUCKETS 14            // log2 buckets: <1us ... >=4ms
+
+/**
+ * @brief Real-time settings parsed from the command line
+ */
+struct rt_config {
+    int enabled;        /**< Non-zero if --rt was given */
+    int priority;       /**< SCHED_FIFO priority (1-99) */
+    int cpu;            /**< CPU to pin to, or -1 to pick automatically */
+};
+
+/**
+ * @brief Lateness statistics for one periodic activity
+ *
+ * Updated from the periodic handler itself (signal handler safe: no
+ * allocation, no locks, only clock_gettime()).
+ */
+struct rt_jitter {
+    long long period_ns;                /**< Nominal period */
+    long long next_ns;                  /**< Ideal time of the next tick */
+    long count;                         /**< Ticks measured */
+    long missed;                        /**< Whole periods skipped */
+    long long min_ns;                   /**< Smallest lateness */
+    long long max_ns;                   /**< Largest lateness */
+    long long sum_ns;                   /**< Sum of lateness (for the mean) */
+    long buckets[RT_JITTER_BUCKETS];    /**< Lateness histogram */
+};
+
+/**
+ * @brief Extracts the --rt switches from argv
+ *
+ * Recognised switches are removed from argv and argc is updated, so the
+ * program's own argument handling is unaffected.
+ *
+ * @param argc Pointer to main()'s argc
+ * @param argv main()'s argv
+ * @param cfg Filled with the parsed settings
+ * @return 0 on success, -1 on a malformed value
+ */
+int rt_parse_args(int *argc, char **argv, struct rt_config *cfg);
+
+/**
+ * @brief Enters real-time mode if cfg->enabled is set
+ *
+ * Every step is attempted even if an earlier one fails (typically with
+ * EPERM when not run as root); each failure is reported with perror().
+ *
+ * @param cfg Settings from rt_parse_args()
+ * @return 0 if every step succeeded (or RT mode is off), -1 otherwise
+ */
+int rt_apply(const struct rt_config *cfg);
+
+/**
+ * @brief Touches every page of a buffer so it is resident before use
+ *
+ * @param buf Start of the buffer
+ * @param len Length in bytes
+ */
+void rt_prefault(void *buf, size_t len);
+
+/**
+ * @brief Returns a short description of the current mode
+ *
+ * @param cfg Settings from rt_parse_args()
+ * @return "standard" or "rt"
+ */
+const char *rt_mode_name(const struct rt_config *cfg);
+
+/**
+ * @brief Starts jitter measurement for a periodic activity
+ *
+ * Call immediately before arming the timer, so the first ideal tick is
+ * one period from now.
+ *
+ * @param j The statistics to reset
+ * @param period_ns Nominal period in nanoseconds
+ */
+void rt_jitter_start(struct rt_jitter *j, long long period_ns);
+
+/**
+ * @brief Records one tick; call first thing in the periodic handler
+ *
+ * @param j The statistics to update
+ */
+void rt_jitter_tick(struct rt_jitter *j);
+
+/**
+ * @brief Records one tick whose lateness the caller measured itself
+ *
+ * For loops that keep their own schedule instead of the one
+ * rt_jitter_start() set up, e.g. an absolute-deadline clock that measures
+ * each tick against its own deadline. Updates the histogram and min/mean/
+ * max only; next_ns and missed are left alone.
+ *
+ * @param j The statistics to update
+ * @param late_ns How late the tick ran
+ */
+void rt_jitter_record(struct rt_jitter *j, long long late_ns);
+
+/**
+ * @brief Prints min/mean/max lateness and a histogram
+ *
+ * @param j The statistics to print
+ * @param label Name of the activity (e.g. "audio sample")
+ * @param cfg Mode the program ran in, printed in the header
+ */
+void rt_jitter_report(const struct rt_jitter *j, const char *label,
+                      const struct rt_config *cfg);
+
+#endif // RT_API_H
@@ -0,0 +1,102 @@
+#ifndef TELEMETRY_API_H
+#define TELEMETRY_API_H
+
+/**
+ * @file telemetry_api.h
+ * @brief Live timing telemetry for periodic tasks in shared memory
+ *
+ * A program publishes one segment, /dev/shm/telemetry.<program>, holding a
+ * record per periodic task: tick and overrun counts, worst lateness, worst
+ * callback runtime and a histogram of period error (how far each interval
+ * between two ticks was from the nominal period). telemetry_top maps the
+ * segment read-only and shows it live while the program runs.
+ *
+ * Each record has exactly one writer (the task's own thread), so counters
+ * are updated with relaxed atomic loads and stores: no locks, no
+ * read-modify-write instructions, nothing that can block the writer. The
+ * reader may see a tick half-applied (e.g. the count bumped before the
+ * histogram), which is fine for a monitor.
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define TELEMETRY_MAGIC 0x544c4d31u   // "TLM1"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_MAX_TASKS 8
+#define TELEMETRY_NAME_LEN 24
+#define TELEMETRY_BUCKETS 16          // log2 buckets: <1us, 1-2us, ... >=16ms
+#define TELEMETRY_SHM_PREFIX "/telemetry."
+
+/**
+ * @brief Counters for one periodic task
+ */
+struct telemetry_task {
+    char name[TELEMETRY_NAME_LEN];          /**< Task name, NUL terminated */
+    _Atomic int64_t period_ns;              /**< Nominal period */
+    _Atomic uint64_t ticks;                 /**< Callbacks run */
+    _Atomic uint64_t overruns;              /**< Deadlines skipped */
+    _Atomic int64_t max_late_ns;            /**< Worst wake-up lateness */
+    _Atomic int64_t max_runtime_ns;         /**< Worst callback runtime */
+    _Atomic int64_t sum_runtime_ns;         /**< For the mean runtime */
+    _Atomic uint64_t error_hist[TELEMETRY_BUCKETS]; /**< |period error| */
+};
+
+/**
+ * @brief Layout of the shared-memory segment
+ */
+struct telemetry_segment {
+    uint32_t magic;                         /**< TELEMETRY_MAGIC once ready */
+    uint32_t version;                       /**< TELEMETRY_VERSION */
+    int32_t pid;                            /**< Publishing process */
+    _Atomic uint32_t num_tasks;             /**< Records in use */
+    char program[32];                       /**< Program name */
+    struct telemetry_task tasks[TELEMETRY_MAX_TASKS];
+};
+
+/**
+ * @brief Creates and maps this program's telemetry segment
+ *
+ * @param program Program name; the segment is TELEMETRY_SHM_PREFIX program
+ * @return 0 on success, -1 on failure (telemetry is then disabled)
+ */
+int telemetry_open(const char *program);
+
+/**
+ * @brief Returns the record for a task, creating it on first use
+ *
+ * Asking again for the same name returns the same record with the new
+ * period, so a task restarted at another rate keeps its history.
+ *
+ * @param name Task name (truncated to TELEMETRY_NAME_LEN - 1)
+ * @param period_ns Nominal period in nanoseconds
+ * @return The record, or NULL if telemetry is not open or the table is full
+ */
+struct telemetry_task *telemetry_task(const char *name, long long period_ns);
+
+/**
+ * @brief Records one tick; called by the task's thread only
+ *
+ * @param t The task's record (NULL is ignored)
+ * @param late_ns Wake-up time minus deadline
+ * @param period_error_ns Interval since the previous tick minus the period
+ *        (pass 0 for the first tick)
+ * @param runtime_ns How long the callback ran
+ */
+void telemetry_tick(struct telemetry_task *t, long long late_ns,
+                    long long period_error_ns, long long runtime_ns);
+
+/**
+ * @brief Adds skipped deadlines to a task's overrun count
+ *
+ * @param t The task's record (NULL is ignored)
+ * @param missed Number of deadlines skipped
+ */
+void telemetry_overrun(struct telemetry_task *t, long long missed);
+
+/**
+ * @brief Unmaps and removes this program's segment
+ */
+void telemetry_close(void);
+
+#endif // TELEMETRY_API_H
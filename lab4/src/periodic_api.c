@@ -0,0 +1,120 @@
+#define _GNU_SOURCE
+#include "periodic_api.h"
+#include "trace_api.h"
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/prctl.h>
+
+#define NSEC_PER_SEC 1000000000LL
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void *runner(void *arg) {
+    struct periodic_task *t = arg;
+
+    // Non-RT threads get 50 us of timer slack by default, which would show
+    // up as lateness on every tick; ask for exact wake-ups instead
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    long long next = now_ns() + t->period_ns;
+    long long prev_wake = 0;
+
+    if (t->jitter) {
+        rt_jitter_start(t->jitter, t->period_ns);
+        t->jitter->next_ns = next;
+    }
+
+    while (!atomic_load_explicit(&t->stop, memory_order_relaxed)) {
+        struct timespec deadline = {
+            .tv_sec = next / NSEC_PER_SEC,
+            .tv_nsec = next % NSEC_PER_SEC,
+        };
+        int ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        if (ret == EINTR) {
+            continue;
+        }
+
+        long long wake = now_ns();
+        if (t->jitter) {
+            rt_jitter_tick(t->jitter);
+        }
+
+        TRACE_BEGIN(TRACE_TIMER_TICK, 0);
+        int done = t->fn(t->arg);
+        TRACE_END(TRACE_TIMER_TICK, done);
+        long long now = now_ns();
+        atomic_fetch_add_explicit(&t->ticks, 1, memory_order_relaxed);
+
+        if (t->telemetry) {
+            long long error = prev_wake ? (wake - prev_wake) - t->period_ns : 0;
+            telemetry_tick(t->telemetry, wake - next, error, now - wake);
+        }
+        prev_wake = wake;
+
+        if (done) {
+            break;
+        }
+
+        // Skip deadlines that already passed rather than firing a burst
+        next += t->period_ns;
+        if (next <= now) {
+            long long missed = (now - next) / t->period_ns + 1;
+            atomic_fetch_add_explicit(&t->overruns, missed, memory_order_relaxed);
+            telemetry_overrun(t->telemetry, missed);
+            next += missed * t->period_ns;
+        }
+    }
+
+    atomic_store(&t->finished, 1);
+    return NULL;
+}
+
+int periodic_start(struct periodic_task *t, long long period_ns,
+                   periodic_fn fn, void *arg, struct rt_jitter *jitter,
+                   struct telemetry_task *telemetry) {
+    if (period_ns <= 0 || !fn) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    t->period_ns = period_ns;
+    t->fn = fn;
+    t->arg = arg;
+    t->jitter = jitter;
+    t->telemetry = telemetry;
+    atomic_init(&t->stop, 0);
+    atomic_init(&t->finished, 0);
+    atomic_init(&t->ticks, 0);
+    atomic_init(&t->overruns, 0);
+
+    // The runner inherits a fully blocked mask, so signals such as SIGINT
+    // always land on the caller's thread (where pause() waits for them)
+    sigset_t all, old_mask;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old_mask);
+    int ret = pthread_create(&t->thread, NULL, runner, t);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    if (ret != 0) {
+        errno = ret;
+        return -1;
+    }
+    return 0;
+}
+
+void periodic_stop(struct periodic_task *t) {
+    atomic_store(&t->stop, 1);
+    pthread_join(t->thread, NULL);
+}
+
+void periodic_join(struct periodic_task *t) {
+    pthread_join(t->thread, NULL);
+}
+
+int periodic_finished(struct periodic_task *t) {
+    return atomic_load(&t->finished);
+}
@@ -4,7 +4,13 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
+#include <string.h>
 #include <time.h>
+#include <sys/resource.h>
+
+#include "rt_api.h"
+#include "periodic_api.h"
+#include "pinmap_api.h"
 
 #define CHIP "/dev/gpiochip4"
 
@@ -19,143 +25,181 @@
 #define OUT_3 13  // Bit 2 (C)
 #define OUT_4 6   // Bit 3 (D)
 
-#define MULTIPLEX_INTERVAL_US 2000  // 2ms per digit (500Hz refresh rate)
+#define MULTIPLEX_HZ 500            // Digits shown per second (2 ms each)
 #define COUNTER_INTERVAL_MS 500     // Increment counter every 500ms
 
-static struct gpiod_line *bcd_bit0, *bcd_bit1, *bcd_bit2, *bcd_bit3;
-static struct gpiod_line *sel_7s1, *sel_7s2;
+// BCD and select lines are one output group: pinmap requests them with a
+// single bulk call, and a staged change of any number of them is one write
+static const struct pin_desc PINS[] = {
+    { "bcd_bit0", OUT_1, PIN_OUTPUT, 0, 1, 0 },
+    { "bcd_bit1", OUT_2, PIN_OUTPUT, 0, 1, 0 },
+    { "bcd_bit2", OUT_3, PIN_OUTPUT, 0, 1, 0 },
+    { "bcd_bit3", OUT_4, PIN_OUTPUT, 0, 1, 0 },
+    { "sel_7s1", SEL_7S1, PIN_OUTPUT, 0, 1, 0 },    // Start disabled (OFF = 1)
+    { "sel_7s2", SEL_7S2, PIN_OUTPUT, 0, 1, 0 },
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
+#define NUM_BCD_BITS 4
+
+static struct pin_out bcd_bits[NUM_BCD_BITS];
+static struct pin_out sel_7s1, sel_7s2;
 
-// Global state for interrupt handlers
+// Global state shared with the multiplex task
 static volatile unsigned char current_counter = 0;
 static volatile int current_digit = 0;  // 0 = first digit, 1 = second digit
 static volatile unsigned long multiplex_count = 0;
+static unsigned long ticks_per_count = COUNTER_INTERVAL_MS * MULTIPLEX_HZ / 1000;
+static volatile sig_atomic_t stop = 0;
+static struct rt_jitter jitter;
 
-void setup_gpio(struct gpiod_chip *chip) {
-    // Get BCD output lines
-    bcd_bit0 = gpiod_chip_get_line(chip, OUT_1);
-    bcd_bit1 = gpiod_chip_get_line(chip, OUT_2);
-    bcd_bit2 = gpiod_chip_get_line(chip, OUT_3);
-    bcd_bit3 = gpiod_chip_get_line(chip, OUT_4);
-    
-    // Get selector lines
-    sel_7s1 = gpiod_chip_get_line(chip, SEL_7S1);
-    sel_7s2 = gpiod_chip_get_line(chip, SEL_7S2);
-    
-    // Request all as outputs (start with BCD = 0, inverted for active low = all HIGH)
-    gpiod_line_request_output(bcd_bit0, "bcd_bit0", 1);
-    gpiod_line_request_output(bcd_bit1, "bcd_bit1", 1);
-    gpiod_line_request_output(bcd_bit2, "bcd_bit2", 1);
-    gpiod_line_request_output(bcd_bit3, "bcd_bit3", 1);
-    
-    gpiod_line_request_output(sel_7s1, "sel_7s1", 1); // Start disabled (OFF = 1)
-    gpiod_line_request_output(sel_7s2, "sel_7s2", 1); // Start disabled (OFF = 1)
+static void handle_sigint(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static int setup_gpio(struct pinmap *pm) {
+    static const char *names[NUM_BCD_BITS] = {"bcd_bit0", "bcd_bit1", "bcd_bit2", "bcd_bit3"};
+    for (int i = 0; i < NUM_BCD_BITS; i++) {
+        if (pinmap_out(pm, names[i], &bcd_bits[i]) < 0) {
+            return -1;
+        }
+    }
+    if (pinmap_out(pm, "sel_7s1", &sel_7s1) < 0 || pinmap_out(pm, "sel_7s2", &sel_7s2) < 0) {
+        return -1;
+    }
+    return 0;
 }
 
-void set_bcd_output(unsigned char digit) {
-    // Output 4-bit BCD value (0-9) to 74LS47 decoder
-    // Active low: invert the bits (0 = HIGH, 1 = LOW)
-    gpiod_line_set_value(bcd_bit0, ((digit >> 0) & 1));
-    gpiod_line_set_value(bcd_bit1, ((digit >> 1) & 1));
-    gpiod_line_set_value(bcd_bit2, ((digit >> 2) & 1));
-    gpiod_line_set_value(bcd_bit3, ((digit >> 3) & 1));
+// Stages a 4-bit BCD value (0-9) for the 74LS47 decoder; nothing is
+// written until the next pin_commit()
+static void stage_bcd_output(unsigned char digit) {
+    for (int i = 0; i < NUM_BCD_BITS; i++) {
+        pin_stage(bcd_bits[i], (digit >> i) & 1);
+    }
+}
 
-    // printf("Counter: %02x \n", digit);
+static long long cpu_ns(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL;
 }
 
-// Timer interrupt handler for multiplexing
-void multiplex_timer_handler(int sig, siginfo_t *si, void *uc) {
-    (void)sig;
-    (void)si;
-    (void)uc;
-    
-    // current_counter = 88;
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
 
+// Periodic task: show the next digit (runs on the multiplex thread). All
+// six lines are one bulk request, so a tick is two writes: both digits
+// off (against ghosting), then the new BCD value with its digit on
+static int multiplex_tick(void *arg) {
+    (void)arg;
+    
     // Extract tens and ones digits for decimal display (00-99)
     unsigned char tens_digit = current_counter / 10;
     unsigned char ones_digit = current_counter % 10;
     
-    // set_bcd_output(tens_digit);
-    // gpiod_line_set_value(sel_7s1, 0); // Turn on first digit (tens)
-    // gpiod_line_set_value(sel_7s2, 1); // Turn on first digit (tens)
     // Turn off BOTH digits first to prevent ghosting
-    gpiod_line_set_value(sel_7s1, 1);
-    gpiod_line_set_value(sel_7s2, 1);
+    pin_stage(sel_7s1, 1);
+    pin_stage(sel_7s2, 1);
+    pin_commit(sel_7s1);
     
     if (current_digit == 0) {
-        set_bcd_output(tens_digit);
-        gpiod_line_set_value(sel_7s1, 0); // Turn on first digit (tens)
+        stage_bcd_output(tens_digit);
+        pin_stage(sel_7s1, 0); // Turn on first digit (tens)
         current_digit = 1;
     } else {
-        set_bcd_output(ones_digit);
-        gpiod_line_set_value(sel_7s2, 0); // Turn on second digit (ones)
+        stage_bcd_output(ones_digit);
+        pin_stage(sel_7s2, 0); // Turn on second digit (ones)
         current_digit = 0;
     }
+    pin_commit(sel_7s1);
     
     // Increment counter every COUNTER_INTERVAL_MS
     multiplex_count++;
-    if (multiplex_count >= (COUNTER_INTERVAL_MS * 1000) / MULTIPLEX_INTERVAL_US) {
+    if (multiplex_count >= ticks_per_count) {
         current_counter++;
         if (current_counter > 99) {
             current_counter = 0;  // Wrap at 99
         }
         multiplex_count = 0;
     }
+    return 0;
 }
 
-int main(void) {
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip) {
-        perror("gpiod_chip_open");
+int main(int argc, char **argv) {
+    struct rt_config rt;
+    if (rt_parse_args(&argc, argv, &rt) < 0) {
+        fprintf(stderr, "Usage: %s [--rt] [--rt-prio=N] [--rt-cpu=N] [--refresh=HZ]\n", argv[0]);
+        return 1;
+    }
+
+    // --refresh: digits shown per second (default MULTIPLEX_HZ)
+    long refresh_hz = MULTIPLEX_HZ;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--refresh=", 10) == 0) {
+            refresh_hz = atol(argv[i] + 10);
+        }
+    }
+    if (refresh_hz < 1 || refresh_hz > 1000000) {
+        fprintf(stderr, "--refresh must be 1 to 1000000 Hz\n");
+        return 1;
+    }
+    long long interval_ns = 1000000000LL / refresh_hz;
+    ticks_per_count = (unsigned long)(COUNTER_INTERVAL_MS * refresh_hz / 1000);
+    if (ticks_per_count == 0) ticks_per_count = 1;
+
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "seven_segment", PINS, NUM_PINS) < 0) {
+        perror("pinmap_open");
+        return 1;
+    }
+    if (setup_gpio(&pm) < 0) {
+        perror("pins");
+        pinmap_close(&pm);
         return 1;
     }
     
-    setup_gpio(chip);
+    if (rt_apply(&rt) < 0) {
+        fprintf(stderr, "Warning: RT setup incomplete, multiplexing may flicker\n");
+    }
     
     printf("7-Segment Counter: 00 to 99 (Decimal)\n");
     printf("Press Ctrl+C to stop...\n\n");
     
-    // Setup signal handler for multiplex timer
-    struct sigaction sa;
-    sa.sa_flags = SA_SIGINFO;
-    sa.sa_sigaction = multiplex_timer_handler;
-    sigemptyset(&sa.sa_mask);
-    if (sigaction(SIGRTMIN, &sa, NULL) == -1) {
-        perror("sigaction");
-        gpiod_chip_close(chip);
-        return 1;
+    if (telemetry_open(argv[0]) < 0) {
+        fprintf(stderr, "Warning: telemetry disabled\n");
     }
     
-    // Create multiplex timer
-    timer_t multiplex_timer_id;
-    struct sigevent sev;
-    sev.sigev_notify = SIGEV_SIGNAL;
-    sev.sigev_signo = SIGRTMIN;
-    sev.sigev_value.sival_ptr = &multiplex_timer_id;
-    
-    if (timer_create(CLOCK_REALTIME, &sev, &multiplex_timer_id) == -1) {
-        perror("timer_create");
-        gpiod_chip_close(chip);
-        return 1;
-    }
-    
-    // Start multiplex timer (500Hz = 2ms per interrupt)
-    struct itimerspec its;
-    its.it_value.tv_sec = 0;
-    its.it_value.tv_nsec = MULTIPLEX_INTERVAL_US * 1000;
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = MULTIPLEX_INTERVAL_US * 1000;
-    
-    if (timer_settime(multiplex_timer_id, 0, &its, NULL) == -1) {
-        perror("timer_settime");
-        gpiod_chip_close(chip);
+    // Start multiplexing (one digit per tick) on its own thread
+    long long cpu_start = cpu_ns(), wall_start = now_ns();
+    struct periodic_task task;
+    if (periodic_start(&task, interval_ns, multiplex_tick, NULL, &jitter,
+                       telemetry_task("multiplex", interval_ns)) < 0) {
+        perror("periodic_start");
+        pinmap_close(&pm);
         return 1;
     }
     
-    // Main loop - just wait for interrupts
-    while (1) {
+    // Main loop - nothing to do until Ctrl+C
+    signal(SIGINT, handle_sigint);
+    while (!stop) {
         pause();
     }
     
-    gpiod_chip_close(chip);
+    periodic_stop(&task);
+    double seconds = (now_ns() - wall_start) / 1e9;
+    double cpu_ms = (cpu_ns() - cpu_start) / 1e6;
+    unsigned long writes = sel_7s1.group->writes;
+    long ticks = atomic_load(&task.ticks);
+    printf("\n%ld overruns\n", atomic_load(&task.overruns));
+    printf("%ld Hz refresh: %lu bulk writes (%.2f per tick, %.0f/s), CPU %.2f ms per second\n",
+           refresh_hz, writes, ticks ? (double)writes / ticks : 0.0, writes / seconds,
+           cpu_ms / seconds);
+    rt_jitter_report(&jitter, "Multiplex", &rt);
+    telemetry_close();
+    pinmap_close(&pm);
     return 0;
 }
@@ -0,0 +1,117 @@
+#define _GNU_SOURCE
+#include "telemetry_api.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+static struct telemetry_segment *seg = NULL;
+static char shm_name[64];
+
+// Single writer per record, so plain load + store is enough
+#define BUMP(field, n) \
+    atomic_store_explicit(&(field), atomic_load_explicit(&(field), memory_order_relaxed) + (n), \
+                          memory_order_relaxed)
+
+#define RAISE(field, v) \
+    do { \
+        if ((v) > atomic_load_explicit(&(field), memory_order_relaxed)) \
+            atomic_store_explicit(&(field), (v), memory_order_relaxed); \
+    } while (0)
+
+int telemetry_open(const char *program) {
+    // Segment name from the program's basename
+    const char *base = strrchr(program, '/');
+    base = base ? base + 1 : program;
+    snprintf(shm_name, sizeof(shm_name), "%s%s", TELEMETRY_SHM_PREFIX, base);
+
+    int fd = shm_open(shm_name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(struct telemetry_segment)) < 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(shm_name);
+        return -1;
+    }
+
+    seg = mmap(NULL, sizeof(*seg), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (seg == MAP_FAILED) {
+        perror("mmap");
+        seg = NULL;
+        shm_unlink(shm_name);
+        return -1;
+    }
+
+    // ftruncate zero-filled the segment; publish the header last
+    seg->version = TELEMETRY_VERSION;
+    seg->pid = (int32_t)getpid();
+    snprintf(seg->program, sizeof(seg->program), "%s", base);
+    atomic_thread_fence(memory_order_release);
+    seg->magic = TELEMETRY_MAGIC;
+    return 0;
+}
+
+struct telemetry_task *telemetry_task(const char *name, long long period_ns) {
+    if (!seg) {
+        return NULL;
+    }
+
+    uint32_t n = atomic_load(&seg->num_tasks);
+    for (uint32_t i = 0; i < n; i++) {
+        if (strncmp(seg->tasks[i].name, name, TELEMETRY_NAME_LEN - 1) == 0) {
+            atomic_store(&seg->tasks[i].period_ns, period_ns);
+            return &seg->tasks[i];
+        }
+    }
+
+    if (n >= TELEMETRY_MAX_TASKS) {
+        return NULL;
+    }
+
+    struct telemetry_task *t = &seg->tasks[n];
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    atomic_store(&t->period_ns, period_ns);
+    atomic_store(&seg->num_tasks, n + 1);
+    return t;
+}
+
+void telemetry_tick(struct telemetry_task *t, long long late_ns,
+                    long long period_error_ns, long long runtime_ns) {
+    if (!t) {
+        return;
+    }
+
+    long long err = period_error_ns < 0 ? -period_error_ns : period_error_ns;
+    long long us = err / 1000;
+    int b = 0;
+    while (us > 0 && b < TELEMETRY_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+
+    BUMP(t->error_hist[b], 1);
+    RAISE(t->max_late_ns, late_ns);
+    RAISE(t->max_runtime_ns, runtime_ns);
+    BUMP(t->sum_runtime_ns, runtime_ns);
+    BUMP(t->ticks, 1);
+}
+
+void telemetry_overrun(struct telemetry_task *t, long long missed) {
+    if (t) {
+        BUMP(t->overruns, (uint64_t)missed);
+    }
+}
+
+void telemetry_close(void) {
+    if (!seg) {
+        return;
+    }
+    munmap(seg, sizeof(*seg));
+    seg = NULL;
+    shm_unlink(shm_name);
+}
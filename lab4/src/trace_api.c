@@ -0,0 +1,158 @@
+#define _GNU_SOURCE
+#include "trace_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+int trace_on = 0;
+__thread struct trace_ring *trace_self = NULL;
+
+static struct trace_ring *rings = NULL;     // Registry, newest first
+static char trace_path[256];
+
+static const char *const NAMES[TRACE_NUM_IDS] = {
+    [TRACE_LCD_CMD] = "lcd_cmd",
+    [TRACE_LCD_CHAR] = "lcd_char",
+    [TRACE_KEYP_SCAN] = "keyp_scan",
+    [TRACE_EVENT_READ] = "event_read",
+    [TRACE_ENCODER_READ] = "encoder_read",
+    [TRACE_TIMER_TICK] = "timer_tick",
+    [TRACE_MARK] = "mark",
+};
+
+const char *trace_id_name(unsigned int id) {
+    if (id < TRACE_NUM_IDS && NAMES[id]) {
+        return NAMES[id];
+    }
+    return "unknown";
+}
+
+struct trace_ring *trace_attach(void) {
+    struct trace_ring *ring = calloc(1, sizeof(*ring));
+    if (!ring) {
+        return NULL;
+    }
+
+    ring->tid = (uint32_t)syscall(SYS_gettid);
+    prctl(PR_GET_NAME, ring->name, 0, 0, 0);
+
+    // Lock-free push so a dump from a signal handler never sees a torn list
+    struct trace_ring *old = __atomic_load_n(&rings, __ATOMIC_ACQUIRE);
+    do {
+        ring->next = old;
+    } while (!__atomic_compare_exchange_n(&rings, &old, ring, 0,
+                                          __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+
+    trace_self = ring;
+    return ring;
+}
+
+static int write_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int trace_dump(void) {
+    if (!trace_path[0]) {
+        return -1;
+    }
+
+    int fd = open(trace_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct trace_ring *head = __atomic_load_n(&rings, __ATOMIC_ACQUIRE);
+    struct trace_dump_header hdr = {
+        .magic = TRACE_MAGIC,
+        .version = TRACE_VERSION,
+        .pid = (uint32_t)getpid(),
+        .num_rings = 0,
+    };
+    for (struct trace_ring *r = head; r; r = r->next) {
+        hdr.num_rings++;
+    }
+
+    int ret = write_all(fd, &hdr, sizeof(hdr));
+    for (struct trace_ring *r = head; r && ret == 0; r = r->next) {
+        uint64_t end = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        uint64_t count = end < TRACE_RING_SIZE ? end : TRACE_RING_SIZE;
+        uint64_t start = end - count;
+
+        struct trace_dump_ring rh = {
+            .tid = r->tid,
+            .count = (uint32_t)count,
+            .dropped = start,
+        };
+        memcpy(rh.name, r->name, sizeof(rh.name));
+        ret = write_all(fd, &rh, sizeof(rh));
+
+        // Oldest first: the ring may wrap, so write it in up to two pieces
+        uint64_t first = start & TRACE_RING_MASK;
+        uint64_t n1 = count < TRACE_RING_SIZE - first ? count : TRACE_RING_SIZE - first;
+        if (ret == 0 && n1 > 0) {
+            ret = write_all(fd, &r->buf[first], n1 * sizeof(struct trace_record));
+        }
+        if (ret == 0 && count > n1) {
+            ret = write_all(fd, &r->buf[0], (count - n1) * sizeof(struct trace_record));
+        }
+    }
+
+    close(fd);
+    return ret;
+}
+
+static void dump_at_exit(void) {
+    trace_dump();
+}
+
+static void dump_on_sigusr1(int sig) {
+    (void)sig;
+    int saved = errno;
+    trace_dump();
+    errno = saved;
+}
+
+static void dump_and_die(int sig) {
+    trace_dump();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+// Runs before main() in every program that links the helpers
+__attribute__((constructor))
+static void trace_init(void) {
+    const char *path = getenv("TRACE_FILE");
+    if (!path || !*path) {
+        return;
+    }
+
+    snprintf(trace_path, sizeof(trace_path), "%s", path);
+    atexit(dump_at_exit);
+    signal(SIGUSR1, dump_on_sigusr1);
+
+    // Only take over termination signals nobody else handles
+    struct sigaction old;
+    if (sigaction(SIGINT, NULL, &old) == 0 && old.sa_handler == SIG_DFL) {
+        signal(SIGINT, dump_and_die);
+    }
+    if (sigaction(SIGTERM, NULL, &old) == 0 && old.sa_handler == SIG_DFL) {
+        signal(SIGTERM, dump_and_die);
+    }
+
+    trace_on = 1;
+}
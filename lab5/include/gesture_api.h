@@ -0,0 +1,79 @@
+#ifndef GESTURE_API_H
+#define GESTURE_API_H
+
+/**
+ * @file gesture_api.h
+ * @brief Hold detection and accelerating auto-repeat for push buttons
+ *
+ * A held button first produces one step, then after GESTURE_HOLD_MS starts
+ * repeating. The repeat period shrinks towards GESTURE_MIN_PERIOD_MS and,
+ * once it is there, each repeat carries more steps. The caller arms a timer
+ * for gesture_deadline() and calls gesture_repeat() when it expires, so no
+ * polling is needed while the button is held, and the display is refreshed
+ * at most once per repeat (<= 1000 / GESTURE_MIN_PERIOD_MS times a second)
+ * no matter how fast the index moves.
+ */
+
+#define GESTURE_HOLD_MS         400  // Delay before the first repeat
+#define GESTURE_START_PERIOD_MS 200  // First repeat period
+#define GESTURE_MIN_PERIOD_MS   50   // Fastest repeat (bounds LCD refresh rate)
+#define GESTURE_BOOST_MS        500  // Step size doubles every BOOST_MS at min period
+#define GESTURE_MAX_STEP        32   // Steps per repeat at full speed
+
+/**
+ * @brief State of one button's gesture
+ */
+struct gesture {
+    int held;               /**< Non-zero while the button is down */
+    long long next_ms;      /**< Next repeat deadline */
+    long long fast_ms;      /**< When the minimum period was reached, or 0 */
+    int period_ms;          /**< Current repeat period */
+    int step;               /**< Steps produced per repeat */
+};
+
+/**
+ * @brief Resets a gesture to the released state
+ *
+ * @param g The gesture to reset
+ */
+void gesture_init(struct gesture *g);
+
+/**
+ * @brief Starts a hold
+ *
+ * Call on the (debounced) press. The press itself is worth one step,
+ * which the caller applies immediately.
+ *
+ * @param g The gesture
+ * @param now_ms Current CLOCK_MONOTONIC time in milliseconds
+ */
+void gesture_press(struct gesture *g, long long now_ms);
+
+/**
+ * @brief Ends a hold and cancels any pending repeat
+ *
+ * @param g The gesture
+ */
+void gesture_release(struct gesture *g);
+
+/**
+ * @brief Returns the next repeat deadline
+ *
+ * @param g The gesture
+ * @return Deadline in milliseconds, or -1 if the button is not held
+ */
+long long gesture_deadline(const struct gesture *g);
+
+/**
+ * @brief Fires a repeat whose deadline has passed
+ *
+ * Returns the number of steps to apply and schedules the next deadline,
+ * shortening the period or growing the step size as the hold continues.
+ *
+ * @param g The gesture
+ * @param now_ms Current CLOCK_MONOTONIC time in milliseconds
+ * @return Steps to apply (0 if not held or not yet due)
+ */
+int gesture_repeat(struct gesture *g, long long now_ms);
+
+#endif // GESTURE_API_H
@@ -11,10 +11,25 @@
  */
 
 #include <gpiod.h>
+#include "pinmap_api.h"
 #include <unistd.h>
 #include <stdint.h>
 #include <stdio.h>
 
+/**
+ * @brief Pin table entries for the LCD wiring shared by the lab boards
+ *
+ * Put this in a program's struct pin_desc table, then call
+ * lcd_init_pinmap().
+ */
+#define LCD_PIN_DESCS \
+    { "rs",  5, PIN_OUTPUT, 0, 0, 0 }, \
+    { "e",  16, PIN_OUTPUT, 0, 0, 0 }, \
+    { "d4",  6, PIN_OUTPUT, 0, 0, 0 }, \
+    { "d5", 13, PIN_OUTPUT, 0, 0, 0 }, \
+    { "d6", 19, PIN_OUTPUT, 0, 0, 0 }, \
+    { "d7", 26, PIN_OUTPUT, 0, 0, 0 }
+
 /**
  * @brief Writes 4 bits of data to the LCD
  * 
@@ -80,17 +95,29 @@ void lcd_print_padded(const char *s);
  * Performs the initialization sequence for the LCD including setting
  * 4-bit mode, display configuration, and clearing the screen. Must be
  * called before any other LCD functions.
+ *
+ * The pins come from a pin map (see pinmap_api.h). Keeping D4-D7 and E in
+ * one output group lets each nibble go out as a single group write.
  * 
- * @param chip The gpiod_chip containing the LCD GPIO lines
- * @param rs The GPIO line for the Register Select (RS) pin
- * @param e The GPIO line for the Enable (E) pin
- * @param d4 The GPIO line for the D4 data pin
- * @param d5 The GPIO line for the D5 data pin
- * @param d6 The GPIO line for the D6 data pin  
- * @param d7 The GPIO line for the D7 data pin
+ * @param rs The output for the Register Select (RS) pin
+ * @param e The output for the Enable (E) pin
+ * @param d4 The output for the D4 data pin
+ * @param d5 The output for the D5 data pin
+ * @param d6 The output for the D6 data pin  
+ * @param d7 The output for the D7 data pin
+ */
+void lcd_init(struct pin_out rs, struct pin_out e,
+              struct pin_out d4, struct pin_out d5,
+              struct pin_out d6, struct pin_out d7);
+
+/**
+ * @brief Initializes the LCD from the pins named rs, e and d4-d7
+ *
+ * Looks the pins up in a pin map (see LCD_PIN_DESCS) and calls lcd_init().
+ *
+ * @param pm The program's pin map
+ * @return 0 on success, -1 if a pin is missing (errno = ENOENT)
  */
-void lcd_init(struct gpiod_chip *chip, struct gpiod_line *rs, struct gpiod_line *e,
-              struct gpiod_line *d4, struct gpiod_line *d5,
-              struct gpiod_line *d6, struct gpiod_line *d7);
+int lcd_init_pinmap(struct pinmap *pm);
 
 #endif // LCD_API_H
\ No newline at end of file
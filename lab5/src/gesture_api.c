@@ -0,0 +1,55 @@
+#include "gesture_api.h"
+
+void gesture_init(struct gesture *g) {
+    g->held = 0;
+    g->next_ms = 0;
+    g->fast_ms = 0;
+    g->period_ms = GESTURE_START_PERIOD_MS;
+    g->step = 1;
+}
+
+void gesture_press(struct gesture *g, long long now_ms) {
+    gesture_init(g);
+    g->held = 1;
+    g->next_ms = now_ms + GESTURE_HOLD_MS;
+}
+
+void gesture_release(struct gesture *g) {
+    gesture_init(g);
+}
+
+long long gesture_deadline(const struct gesture *g) {
+    return g->held ? g->next_ms : -1;
+}
+
+int gesture_repeat(struct gesture *g, long long now_ms) {
+    if (!g->held || now_ms < g->next_ms) {
+        return 0;
+    }
+
+    int steps = g->step;
+
+    if (g->period_ms > GESTURE_MIN_PERIOD_MS) {
+        // Phase 1: speed up by shortening the period (x3/4 per repeat)
+        g->period_ms = g->period_ms * 3 / 4;
+        if (g->period_ms <= GESTURE_MIN_PERIOD_MS) {
+            g->period_ms = GESTURE_MIN_PERIOD_MS;
+            g->fast_ms = now_ms;
+        }
+    } else if (g->step < GESTURE_MAX_STEP &&
+               now_ms - g->fast_ms >= GESTURE_BOOST_MS) {
+        // Phase 2: period is pinned, so move further per refresh instead
+        g->step *= 2;
+        if (g->step > GESTURE_MAX_STEP) g->step = GESTURE_MAX_STEP;
+        g->fast_ms = now_ms;
+    }
+
+    // Schedule from the old deadline so late wake-ups do not stretch the
+    // cadence, but never schedule into the past after a long stall
+    g->next_ms += g->period_ms;
+    if (g->next_ms <= now_ms) {
+        g->next_ms = now_ms + g->period_ms;
+    }
+
+    return steps;
+}
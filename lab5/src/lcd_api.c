@@ -1,42 +1,50 @@
 #include "lcd_api.h"
+#include "trace_api.h"
 #include <gpiod.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
-static struct gpiod_chip *chip;
-static struct gpiod_line *rs, *e, *d4, *d5, *d6, *d7;
+static struct pin_out rs, e, d4, d5, d6, d7;
 
-static void pulse_enable(void) {
-    gpiod_line_set_value(e, 1);
+void write4(uint8_t v) {
+    // Data and E rise in one group write: the controller latches the
+    // data on E's falling edge, so it only has to be stable before that
+    pin_stage(d4, (v >> 0) & 1);
+    pin_stage(d5, (v >> 1) & 1);
+    pin_stage(d6, (v >> 2) & 1);
+    pin_stage(d7, (v >> 3) & 1);
+    pin_stage(e, 1);
+    // One write per group; pins sharing a group are already clean
+    pin_commit(d4);
+    pin_commit(d5);
+    pin_commit(d6);
+    pin_commit(d7);
+    pin_commit(e);
     usleep(1);
-    gpiod_line_set_value(e, 0);
+    pin_write(e, 0);
     usleep(50);
 }
 
-void write4(uint8_t v) {
-    gpiod_line_set_value(d4, (v >> 0) & 1);
-    gpiod_line_set_value(d5, (v >> 1) & 1);
-    gpiod_line_set_value(d6, (v >> 2) & 1);
-    gpiod_line_set_value(d7, (v >> 3) & 1);
-    pulse_enable();
-}
-
 void lcd_cmd(uint8_t cmd) {
-    gpiod_line_set_value(rs, 0);
+    TRACE_BEGIN(TRACE_LCD_CMD, cmd);
+    pin_write(rs, 0);
     write4(cmd >> 4);
     write4(cmd & 0x0F);
 
     if (cmd == 0x01 || cmd == 0x02) usleep(2000);
     else usleep(50);
+    TRACE_END(TRACE_LCD_CMD, cmd);
 }
 
 void lcd_char(char c) {
-    gpiod_line_set_value(rs, 1);
+    TRACE_BEGIN(TRACE_LCD_CHAR, (uint8_t)c);
+    pin_write(rs, 1);
     write4((uint8_t)c >> 4);
     write4((uint8_t)c & 0x0F);
     usleep(50);
+    TRACE_END(TRACE_LCD_CHAR, (uint8_t)c);
 }
 
 void lcd_set_cursor(int row, int col) {
@@ -59,15 +67,9 @@ void lcd_print_padded(const char *s) {
     for (int i = 0; i < 16; i++) lcd_char(buf[i]);
 }
 
-void lcd_init(struct gpiod_chip *chip_arg, 
-              struct gpiod_line *rs_arg, 
-              struct gpiod_line *e_arg,
-              struct gpiod_line *d4_arg, 
-              struct gpiod_line *d5_arg,
-              struct gpiod_line *d6_arg, 
-              struct gpiod_line *d7_arg
-          ) {
-    chip = chip_arg;
+void lcd_init(struct pin_out rs_arg, struct pin_out e_arg,
+              struct pin_out d4_arg, struct pin_out d5_arg,
+              struct pin_out d6_arg, struct pin_out d7_arg) {
     rs = rs_arg;
     e = e_arg;
     d4 = d4_arg;
@@ -77,8 +79,8 @@ void lcd_init(struct gpiod_chip *chip_arg,
 
     usleep(50000);
 
-    gpiod_line_set_value(rs, 0);
-    gpiod_line_set_value(e, 0);
+    pin_write(rs, 0);
+    pin_write(e, 0);
 
     write4(0x03); usleep(5000);
     write4(0x03); usleep(200);
@@ -90,4 +92,15 @@ void lcd_init(struct gpiod_chip *chip_arg,
     lcd_cmd(0x06);
     lcd_cmd(0x01);
     usleep(2000);
+}
+
+int lcd_init_pinmap(struct pinmap *pm) {
+    struct pin_out rs_pin, e_pin, d4_pin, d5_pin, d6_pin, d7_pin;
+    if (pinmap_out(pm, "rs", &rs_pin) < 0 || pinmap_out(pm, "e", &e_pin) < 0 ||
+        pinmap_out(pm, "d4", &d4_pin) < 0 || pinmap_out(pm, "d5", &d5_pin) < 0 ||
+        pinmap_out(pm, "d6", &d6_pin) < 0 || pinmap_out(pm, "d7", &d7_pin) < 0) {
+        return -1;
+    }
+    lcd_init(rs_pin, e_pin, d4_pin, d5_pin, d6_pin, d7_pin);
+    return 0;
 }
\ No newline at end of file
@@ -3,21 +3,27 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/timerfd.h>
 
 #include "lcd_api.h"
+#include "gesture_api.h"
+#include "pinmap_api.h"
 
 #define CHIP        "/dev/gpiochip4"
-#define LED_TEST    21
-#define RS          5
-#define E           16
-#define D4          6
-#define D5          13
-#define D6          19
-#define D7          26
-#define SCROLL_UP   14
-#define SCROLL_DOWN 15
-
-static struct gpiod_line *rs, *e, *d4, *d5, *d6, *d7;
+#define MAX_EVENTS  16 /* edge events pulled per line per wake-up */
+
+/* Scroll buttons are active-low: falling edge = press */
+static const struct pin_desc PINS[] = {
+    {"led", 21, PIN_OUTPUT, 0, 1, 0}, /* LED test, on while running */
+    LCD_PIN_DESCS,
+    {"scroll_up", 14, PIN_EDGE_FALLING, 0, 0, 10000}, /* 10 ms kernel debounce (v2) */
+    {"scroll_down", 15, PIN_EDGE_FALLING, 0, 0, 10000},
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
 
 static long long now_ms(void)
 {
@@ -26,6 +32,59 @@ static long long now_ms(void)
     return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
 }
 
+/* Drain a button's edge burst; returns 1 if it holds a debounced press */
+static int button_pressed(struct pin_edge btn, long long *last_ms,
+                          int debounce_ms)
+{
+    struct pin_event evs[MAX_EVENTS];
+    int n = pin_edge_read(btn, evs, MAX_EVENTS);
+    int pressed = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        long long t = (long long)(evs[i].ts_ns / 1000000ULL);
+        if (t - *last_ms >= debounce_ms)
+        {
+            *last_ms = t;
+            pressed = 1;
+        }
+    }
+    return pressed;
+}
+
+/* Fire a due auto-repeat, or end the hold if the button was let go */
+static int button_repeat(struct pin_edge btn, struct gesture *g,
+                         long long t)
+{
+    long long deadline = gesture_deadline(g);
+    if (deadline < 0 || deadline > t)
+        return 0;
+
+    if (pin_edge_value(btn) != 0) /* active-low: released */
+    {
+        gesture_release(g);
+        return 0;
+    }
+    return gesture_repeat(g, t);
+}
+
+/* Arm the timer for the nearest hold deadline, or disarm it */
+static void arm_repeat_timer(int tfd, const struct gesture *a,
+                             const struct gesture *b)
+{
+    long long da = gesture_deadline(a);
+    long long db = gesture_deadline(b);
+    long long next = (da < 0) ? db : (db < 0) ? da : (da < db ? da : db);
+
+    struct itimerspec its = {0};
+    if (next >= 0)
+    {
+        its.it_value.tv_sec = next / 1000;
+        its.it_value.tv_nsec = (next % 1000) * 1000000L;
+    }
+    timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
 int main(void)
 {
     const int debounce_ms = 50;
@@ -37,71 +96,39 @@ int main(void)
         "Message 16", "Message 17", "Message 18", "Message 19", "Message 20"};
     const int num_messages = sizeof(messages) / sizeof(messages[0]);
 
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip)
+    /* Every pin of the board in one pass: one bulk request per group */
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "scroll_interrupt", PINS, NUM_PINS) < 0)
     {
-        perror("gpiod_chip_open");
+        perror("pinmap_open");
         return 1;
     }
 
-    /* LED */
-    struct gpiod_line *led = gpiod_chip_get_line(chip, LED_TEST);
-    if (!led || gpiod_line_request_output(led, "led", 0) < 0)
-    {
-        perror("led");
-        return 1;
-    }
-    gpiod_line_set_value(led, 1);
-
-    /* LCD */
-    rs = gpiod_chip_get_line(chip, RS);
-    e = gpiod_chip_get_line(chip, E);
-    d4 = gpiod_chip_get_line(chip, D4);
-    d5 = gpiod_chip_get_line(chip, D5);
-    d6 = gpiod_chip_get_line(chip, D6);
-    d7 = gpiod_chip_get_line(chip, D7);
-    if (!rs || !e || !d4 || !d5 || !d6 || !d7)
-    {
-        perror("lcd lines");
-        return 1;
-    }
-    if (gpiod_line_request_output(rs, "rs", 0) < 0 ||
-        gpiod_line_request_output(e, "e", 0) < 0 ||
-        gpiod_line_request_output(d4, "d4", 0) < 0 ||
-        gpiod_line_request_output(d5, "d5", 0) < 0 ||
-        gpiod_line_request_output(d6, "d6", 0) < 0 ||
-        gpiod_line_request_output(d7, "d7", 0) < 0)
+    struct pin_edge btn_up, btn_down;
+    if (pinmap_edge(&pm, "scroll_up", &btn_up) < 0 ||
+        pinmap_edge(&pm, "scroll_down", &btn_down) < 0)
     {
-        perror("lcd setup");
+        perror("button pins");
+        pinmap_close(&pm);
         return 1;
     }
 
-    /* Scroll buttons — falling-edge interrupt (active-low) */
-    struct gpiod_line *btn_up = gpiod_chip_get_line(chip, SCROLL_UP);
-    struct gpiod_line *btn_down = gpiod_chip_get_line(chip, SCROLL_DOWN);
-    if (!btn_up || !btn_down)
+    /* Auto-repeat timer, armed only while a button is held */
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tfd < 0)
     {
-        perror("button lines");
+        perror("timerfd_create");
+        pinmap_close(&pm);
         return 1;
     }
-    if (gpiod_line_request_falling_edge_events(btn_up, "scroll_up") < 0)
-    {
-        perror("scroll_up");
-        return 1;
-    }
-    if (gpiod_line_request_falling_edge_events(btn_down, "scroll_down") < 0)
+
+    if (lcd_init_pinmap(&pm) < 0)
     {
-        perror("scroll_down");
+        perror("lcd_init_pinmap");
+        close(tfd);
+        pinmap_close(&pm);
         return 1;
     }
-
-    /* Group both buttons so we can block-wait on either simultaneously */
-    struct gpiod_line_bulk btn_bulk;
-    gpiod_line_bulk_init(&btn_bulk);
-    gpiod_line_bulk_add(&btn_bulk, btn_up);
-    gpiod_line_bulk_add(&btn_bulk, btn_down);
-
-    lcd_init(chip, rs, e, d4, d5, d6, d7);
     lcd_clear();
 
     int current_index = 0;
@@ -114,48 +141,64 @@ int main(void)
     lcd_print_padded(messages[(current_index + 1) % num_messages]);
     printf("Displaying: %s\n", messages[current_index]);
 
+    struct gesture g_up, g_down;
+    gesture_init(&g_up);
+    gesture_init(&g_down);
+
+    struct pollfd pfd[3] = {
+        {.fd = pin_edge_fd(btn_up), .events = POLLIN},
+        {.fd = pin_edge_fd(btn_down), .events = POLLIN},
+        {.fd = tfd, .events = POLLIN},
+    };
+
     while (1)
     {
-        struct gpiod_line_bulk event_bulk;
-        gpiod_line_bulk_init(&event_bulk);
-
-        /* Block indefinitely until a button is pressed — CPU sleeps */
-        int ret = gpiod_line_event_wait_bulk(&btn_bulk, NULL, &event_bulk);
-        if (ret < 0)
+        /* Block until a press or a repeat deadline — CPU sleeps */
+        if (poll(pfd, 3, -1) < 0)
         {
-            perror("event_wait_bulk");
+            if (errno == EINTR)
+                continue;
+            perror("poll");
             break;
         }
 
         long long t = now_ms();
-        int changed = 0;
+        int steps = 0;
 
-        unsigned int n = gpiod_line_bulk_num_lines(&event_bulk);
-        for (unsigned int i = 0; i < n; i++)
+        if ((pfd[0].revents & POLLIN) &&
+            button_pressed(btn_up, &last_up_ms, debounce_ms))
         {
-            struct gpiod_line *line = gpiod_line_bulk_get_line(&event_bulk, i);
-            struct gpiod_line_event ev;
-            gpiod_line_event_read(line, &ev);
-
-            if (line == btn_up && t - last_up_ms >= debounce_ms)
-            {
-                last_up_ms = t;
-                current_index =
-                    (current_index - 1 + num_messages) % num_messages;
-                printf("Up: %s\n", messages[current_index]);
-                changed = 1;
-            }
-            else if (line == btn_down && t - last_down_ms >= debounce_ms)
-            {
-                last_down_ms = t;
-                current_index = (current_index + 1) % num_messages;
-                printf("Down: %s\n", messages[current_index]);
-                changed = 1;
-            }
+            gesture_press(&g_up, t);
+            steps--;
+        }
+        if ((pfd[1].revents & POLLIN) &&
+            button_pressed(btn_down, &last_down_ms, debounce_ms))
+        {
+            gesture_press(&g_down, t);
+            steps++;
         }
 
-        if (changed)
+        if (pfd[2].revents & POLLIN)
         {
+            uint64_t expirations;
+            if (read(tfd, &expirations, sizeof(expirations)) < 0 &&
+                errno != EAGAIN)
+                perror("timerfd read");
+
+            steps -= button_repeat(btn_up, &g_up, t);
+            steps += button_repeat(btn_down, &g_down, t);
+        }
+
+        arm_repeat_timer(tfd, &g_up, &g_down);
+
+        if (steps != 0)
+        {
+            current_index =
+                ((current_index + steps) % num_messages + num_messages) %
+                num_messages;
+            printf("%s %d: %s\n", steps < 0 ? "Up" : "Down",
+                   steps < 0 ? -steps : steps, messages[current_index]);
+
             lcd_set_cursor(0, 0);
             lcd_print_padded(messages[current_index]);
             lcd_set_cursor(1, 0);
@@ -164,9 +207,7 @@ int main(void)
         }
     }
 
-    gpiod_line_release(led);
-    gpiod_line_release(btn_up);
-    gpiod_line_release(btn_down);
-    gpiod_chip_close(chip);
+    close(tfd);
+    pinmap_close(&pm);
     return 0;
 }
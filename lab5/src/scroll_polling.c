@@ -6,18 +6,18 @@
 #include <unistd.h>
 
 #include "lcd_api.h"
+#include "gesture_api.h"
+#include "pinmap_api.h"
 
-#define CHIP        "/dev/gpiochip4"
-#define RS          5
-#define E           16
-#define D4          6
-#define D5          13
-#define D6          19
-#define D7          26
-#define SCROLL_UP   14
-#define SCROLL_DOWN 15
+#define CHIP "/dev/gpiochip4"
 
-static struct gpiod_line *rs, *e, *d4, *d5, *d6, *d7;
+/* Scroll buttons are active-low plain inputs, sampled every millisecond */
+static const struct pin_desc PINS[] = {
+    LCD_PIN_DESCS,
+    {"scroll_up", 14, PIN_INPUT, 0, 0, 0},
+    {"scroll_down", 15, PIN_INPUT, 0, 0, 0},
+};
+#define NUM_PINS (sizeof(PINS) / sizeof(PINS[0]))
 
 static long long now_ms(void)
 {
@@ -37,63 +37,40 @@ int main(void)
         "Message 16", "Message 17", "Message 18", "Message 19", "Message 20"};
     const int num_messages = sizeof(messages) / sizeof(messages[0]);
 
-    struct gpiod_chip *chip = gpiod_chip_open(CHIP);
-    if (!chip)
+    /* Every pin of the board in one pass: one bulk request per group */
+    struct pinmap pm;
+    if (pinmap_open(&pm, CHIP, "scroll_polling", PINS, NUM_PINS) < 0)
     {
-        perror("gpiod_chip_open");
+        perror("pinmap_open");
         return 1;
     }
 
-    /* LCD */
-    rs = gpiod_chip_get_line(chip, RS);
-    e = gpiod_chip_get_line(chip, E);
-    d4 = gpiod_chip_get_line(chip, D4);
-    d5 = gpiod_chip_get_line(chip, D5);
-    d6 = gpiod_chip_get_line(chip, D6);
-    d7 = gpiod_chip_get_line(chip, D7);
-    if (!rs || !e || !d4 || !d5 || !d6 || !d7)
+    struct pin_in btn_up, btn_down;
+    if (pinmap_in(&pm, "scroll_up", &btn_up) < 0 ||
+        pinmap_in(&pm, "scroll_down", &btn_down) < 0)
     {
-        perror("lcd lines");
-        return 1;
-    }
-    if (gpiod_line_request_output(rs, "rs", 0) < 0 ||
-        gpiod_line_request_output(e, "e", 0) < 0 ||
-        gpiod_line_request_output(d4, "d4", 0) < 0 ||
-        gpiod_line_request_output(d5, "d5", 0) < 0 ||
-        gpiod_line_request_output(d6, "d6", 0) < 0 ||
-        gpiod_line_request_output(d7, "d7", 0) < 0)
-    {
-        perror("lcd setup");
+        perror("button pins");
+        pinmap_close(&pm);
         return 1;
     }
 
-    /* Scroll buttons — active-low, plain input (polling) */
-    struct gpiod_line *btn_up = gpiod_chip_get_line(chip, SCROLL_UP);
-    struct gpiod_line *btn_down = gpiod_chip_get_line(chip, SCROLL_DOWN);
-    if (!btn_up || !btn_down)
+    if (lcd_init_pinmap(&pm) < 0)
     {
-        perror("button lines");
+        perror("lcd_init_pinmap");
+        pinmap_close(&pm);
         return 1;
     }
-    if (gpiod_line_request_input(btn_up, "scroll_up") < 0)
-    {
-        perror("scroll_up");
-        return 1;
-    }
-    if (gpiod_line_request_input(btn_down, "scroll_down") < 0)
-    {
-        perror("scroll_down");
-        return 1;
-    }
-
-    lcd_init(chip, rs, e, d4, d5, d6, d7);
     lcd_clear();
 
     int current_index = 0;
     long long last_up_ms = 0;
     long long last_down_ms = 0;
-    int prev_up = gpiod_line_get_value(btn_up);
-    int prev_down = gpiod_line_get_value(btn_down);
+    int prev_up = pin_read(btn_up);
+    int prev_down = pin_read(btn_down);
+
+    struct gesture g_up, g_down;
+    gesture_init(&g_up);
+    gesture_init(&g_down);
 
     lcd_set_cursor(0, 0);
     lcd_print_padded(messages[current_index]);
@@ -103,30 +80,42 @@ int main(void)
 
     while (1)
     {
-        int up = gpiod_line_get_value(btn_up);
-        int down = gpiod_line_get_value(btn_down);
+        int up = pin_read(btn_up);
+        int down = pin_read(btn_down);
         long long t = now_ms();
-        int changed = 0;
+        int steps = 0;
 
         /* falling edge = button pressed (active-low) */
         if (prev_up == 1 && up == 0 && t - last_up_ms >= debounce_ms)
         {
             last_up_ms = t;
-            current_index = (current_index - 1 + num_messages) % num_messages;
-            printf("Up: %s\n", messages[current_index]);
-            changed = 1;
+            gesture_press(&g_up, t);
+            steps--;
         }
 
         if (prev_down == 1 && down == 0 && t - last_down_ms >= debounce_ms)
         {
             last_down_ms = t;
-            current_index = (current_index + 1) % num_messages;
-            printf("Down: %s\n", messages[current_index]);
-            changed = 1;
+            gesture_press(&g_down, t);
+            steps++;
         }
 
-        if (changed)
+        /* released: stop repeating; held: fire any due auto-repeat */
+        if (up == 1)
+            gesture_release(&g_up);
+        if (down == 1)
+            gesture_release(&g_down);
+        steps -= gesture_repeat(&g_up, t);
+        steps += gesture_repeat(&g_down, t);
+
+        if (steps != 0)
         {
+            current_index =
+                ((current_index + steps) % num_messages + num_messages) %
+                num_messages;
+            printf("%s %d: %s\n", steps < 0 ? "Up" : "Down",
+                   steps < 0 ? -steps : steps, messages[current_index]);
+
             lcd_set_cursor(0, 0);
             lcd_print_padded(messages[current_index]);
             lcd_set_cursor(1, 0);
@@ -139,8 +128,6 @@ int main(void)
         usleep(1000); /* 1 ms poll interval */
     }
 
-    gpiod_line_release(btn_up);
-    gpiod_line_release(btn_down);
-    gpiod_chip_close(chip);
+    pinmap_close(&pm);
     return 0;
 }
@@ -0,0 +1,72 @@
+#ifndef EDGE_QUEUE_H
+#define EDGE_QUEUE_H
+
+#include <stdint.h>
+
+// ── Lock-free ISR → loop edge queue ─────────────────────────────────────────
+// Single producer (one GPIO ISR, or several ISRs on the same core, which
+// cannot preempt each other) and single consumer (the experiment loop).
+// The producer only writes `head`, the consumer only writes `tail`, so no
+// lock or critical section is needed. Each press keeps its own record and
+// timestamp instead of collapsing into one volatile bool.
+
+#define EDGE_QUEUE_SIZE 32   // Must be a power of two
+#define EDGE_QUEUE_MASK (EDGE_QUEUE_SIZE - 1)
+
+typedef struct {
+    uint8_t  pin;            // GPIO number that fired
+    uint8_t  edge;           // RISING or FALLING (Arduino constants)
+    uint32_t timestamp_us;   // micros() when the ISR ran
+} EdgeEvent;
+
+typedef struct {
+    EdgeEvent buf[EDGE_QUEUE_SIZE];
+    uint32_t  head;          // Next slot to write (producer only)
+    uint32_t  tail;          // Next slot to read (consumer only)
+    uint32_t  overflows;     // Events dropped because the queue was full
+} EdgeQueue;
+
+// Producer side. Always inlined so it lands inside the IRAM_ATTR ISR and
+// never touches flash; the queue itself is a plain global (DRAM).
+static inline __attribute__((always_inline))
+bool edge_queue_push(EdgeQueue *q, uint8_t pin, uint8_t edge, uint32_t ts) {
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= EDGE_QUEUE_SIZE) {
+        __atomic_store_n(&q->overflows, q->overflows + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    EdgeEvent *ev = &q->buf[head & EDGE_QUEUE_MASK];
+    ev->pin          = pin;
+    ev->edge         = edge;
+    ev->timestamp_us = ts;
+
+    // Publish the record only after it is fully written
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Consumer side: copy up to `max` pending events into `out` in one pass.
+// Returns the number of events copied.
+static inline int edge_queue_drain(EdgeQueue *q, EdgeEvent *out, int max) {
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    int n = 0;
+
+    while (tail != head && n < max) {
+        out[n++] = q->buf[tail & EDGE_QUEUE_MASK];
+        tail++;
+    }
+
+    // Hand the slots back to the producer
+    __atomic_store_n(&q->tail, tail, __ATOMIC_RELEASE);
+    return n;
+}
+
+static inline uint32_t edge_queue_overflows(const EdgeQueue *q) {
+    return __atomic_load_n(&q->overflows, __ATOMIC_RELAXED);
+}
+
+#endif // EDGE_QUEUE_H
@@ -0,0 +1,32 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+
+// Hold detection with accelerating auto-repeat for a push button.
+// A press is worth one step; after GESTURE_HOLD_MS the button repeats, the
+// period shrinks to GESTURE_MIN_PERIOD_MS and then each repeat carries more
+// steps. The display is redrawn at most once per repeat, so LCD traffic stays
+// bounded (<= 20 refreshes/s) while the index moves hundreds of steps/s.
+
+#define GESTURE_HOLD_MS         400  // Delay before the first repeat
+#define GESTURE_START_PERIOD_MS 200  // First repeat period
+#define GESTURE_MIN_PERIOD_MS   50   // Fastest repeat (bounds LCD refresh rate)
+#define GESTURE_BOOST_MS        500  // Step size doubles every BOOST_MS at min period
+#define GESTURE_MAX_STEP        32   // Steps per repeat at full speed
+
+typedef struct {
+    bool     held;
+    uint32_t nextMs;     // Next repeat deadline (millis())
+    uint32_t fastMs;     // When the minimum period was reached
+    uint16_t periodMs;   // Current repeat period
+    uint16_t step;       // Steps per repeat
+} Gesture;
+
+void gesture_init(Gesture *g);
+void gesture_press(Gesture *g, uint32_t nowMs);
+void gesture_release(Gesture *g);
+bool gesture_due(const Gesture *g, uint32_t nowMs);
+int  gesture_repeat(Gesture *g, uint32_t nowMs);   // Steps to apply, 0 if not due
+
+#endif // GESTURE_H
@@ -0,0 +1,50 @@
+#include "gesture.h"
+
+void gesture_init(Gesture *g) {
+    g->held     = false;
+    g->nextMs   = 0;
+    g->fastMs   = 0;
+    g->periodMs = GESTURE_START_PERIOD_MS;
+    g->step     = 1;
+}
+
+void gesture_press(Gesture *g, uint32_t nowMs) {
+    gesture_init(g);
+    g->held   = true;
+    g->nextMs = nowMs + GESTURE_HOLD_MS;
+}
+
+void gesture_release(Gesture *g) {
+    gesture_init(g);
+}
+
+// Signed difference handles millis() rollover
+bool gesture_due(const Gesture *g, uint32_t nowMs) {
+    return g->held && (int32_t)(nowMs - g->nextMs) >= 0;
+}
+
+int gesture_repeat(Gesture *g, uint32_t nowMs) {
+    if (!gesture_due(g, nowMs)) return 0;
+
+    int steps = g->step;
+
+    if (g->periodMs > GESTURE_MIN_PERIOD_MS) {
+        // Phase 1: speed up by shortening the period (x3/4 per repeat)
+        g->periodMs = g->periodMs * 3 / 4;
+        if (g->periodMs <= GESTURE_MIN_PERIOD_MS) {
+            g->periodMs = GESTURE_MIN_PERIOD_MS;
+            g->fastMs   = nowMs;
+        }
+    } else if (g->step < GESTURE_MAX_STEP && nowMs - g->fastMs >= GESTURE_BOOST_MS) {
+        // Phase 2: period is pinned, so move further per refresh instead
+        g->step *= 2;
+        if (g->step > GESTURE_MAX_STEP) g->step = GESTURE_MAX_STEP;
+        g->fastMs = nowMs;
+    }
+
+    // Keep the cadence from the old deadline, but never fall behind after a stall
+    g->nextMs += g->periodMs;
+    if ((int32_t)(nowMs - g->nextMs) >= 0) g->nextMs = nowMs + g->periodMs;
+
+    return steps;
+}
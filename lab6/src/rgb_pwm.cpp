@@ -1,4 +1,5 @@
 #include "rgb_pwm.h"
+#include "edge_queue.h"
 #include <Arduino.h>
 #include "esp_sleep.h"
 #include "driver/gpio.h"
@@ -17,6 +18,9 @@
 #define PWM_FREQ   1000  // 1000 Hz
 #define PWM_BITS   8     // 8-bit resolution → 0–255
 
+#define DEBOUNCE_US 50000 // 50 ms between accepted presses
+#define BTN_BATCH   8     // Max queued presses handled per wake-up
+
 // ── Color look-up table (Table 6.4) ─────────────────────────────────────────
 //   Each row: { R, G, B }
 //   255 → 100% duty cycle, 0 → 0% duty cycle
@@ -33,13 +37,15 @@ static const uint8_t COLOR_TABLE[][3] = {
 static const int NUM_COLORS = sizeof(COLOR_TABLE) / sizeof(COLOR_TABLE[0]);
 
 static int colorIndex = 0;
+static uint32_t lastPressUs = 0;
+static uint32_t reportedOverflows = 0;
 
-// Volatile flag set inside ISR, consumed in the loop
-static volatile bool colorChangeFlag = false;
+// Presses queued by the ISR with their timestamps, drained in the loop
+static EdgeQueue btnQueue;
 
 // ── ISR: fires on falling edge (button press) ────────────────────────────────
 void IRAM_ATTR isr_btn(void) {
-    colorChangeFlag = true;
+    edge_queue_push(&btnQueue, BTN_PIN, FALLING, micros());
 }
 
 // ── Apply the current color to the three PWM channels ───────────────────────
@@ -86,10 +92,26 @@ void rgb_pwm_loop(void) {
     // Enter light sleep; CPU halts here until the button pulls BTN_PIN LOW
     esp_light_sleep_start();
 
-    // CPU resumes here after wakeup — check if it was a real button press
-    if (colorChangeFlag) {
-        colorChangeFlag = false;
-        colorIndex = (colorIndex + 1) % NUM_COLORS;
+    // CPU resumes here after wakeup — drain every queued press and keep the
+    // ones that are far enough apart to be real presses, not bounces
+    EdgeEvent events[BTN_BATCH];
+    int n = edge_queue_drain(&btnQueue, events, BTN_BATCH);
+    int presses = 0;
+    for (int i = 0; i < n; i++) {
+        if (events[i].timestamp_us - lastPressUs >= DEBOUNCE_US) {
+            lastPressUs = events[i].timestamp_us;
+            presses++;
+        }
+    }
+
+    uint32_t overflows = edge_queue_overflows(&btnQueue);
+    if (overflows != reportedOverflows) {
+        reportedOverflows = overflows;
+        Serial.printf("Button queue overflows: %u\n", (unsigned)overflows);
+    }
+
+    if (presses > 0) {
+        colorIndex = (colorIndex + presses) % NUM_COLORS;
         applyColor();
 
         // Wait for the button to be released before sleeping again
@@ -1,6 +1,9 @@
 #include "scroll_interrupt.h"
 #include "lcd.h"
+#include "edge_queue.h"
+#include "gesture.h"
 #include <Arduino.h>
+#include <esp_timer.h>
 
 #define SI_RS          42
 #define SI_E           40
@@ -11,6 +14,8 @@
 #define SI_SCROLL_UP   48
 #define SI_SCROLL_DOWN 47
 #define SI_DEBOUNCE_MS 50
+#define SI_BATCH       8   // Max queued edges handled per loop pass
+#define SI_GESTURE_TICK 0xFF // Queue "pin" posted when a gesture deadline passes
 
 static const char *messages[] = {
     "Message 01", "Message 02", "Message 03", "Message 04", "Message 05",
@@ -21,15 +26,66 @@ static const char *messages[] = {
 static const int NUM_MESSAGES = sizeof(messages) / sizeof(messages[0]);
 
 static int currentIndex = 0;
-static unsigned long lastUpMs = 0;
-static unsigned long lastDownMs = 0;
+static uint32_t lastUpUs = 0;
+static uint32_t lastDownUs = 0;
+static uint32_t reportedOverflows = 0;
+static Gesture gUp, gDown;
 
-// Volatile flags set inside ISRs, consumed in the loop
-static volatile bool upPressed   = false;
-static volatile bool downPressed = false;
+// Every press is queued with its pin and timestamp, and so is every
+// gesture deadline. The ISRs and the esp_timer task (which may run on the
+// other core) take producerMux around the push, so together they are the
+// queue's single producer.
+static EdgeQueue edgeQueue;
+static portMUX_TYPE producerMux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t gestureTimer;
 
-void IRAM_ATTR isr_up(void)   { upPressed   = true; }
-void IRAM_ATTR isr_down(void) { downPressed = true; }
+void IRAM_ATTR isr_up(void) {
+    portENTER_CRITICAL_ISR(&producerMux);
+    edge_queue_push(&edgeQueue, SI_SCROLL_UP, FALLING, micros());
+    portEXIT_CRITICAL_ISR(&producerMux);
+}
+
+void IRAM_ATTR isr_down(void) {
+    portENTER_CRITICAL_ISR(&producerMux);
+    edge_queue_push(&edgeQueue, SI_SCROLL_DOWN, FALLING, micros());
+    portEXIT_CRITICAL_ISR(&producerMux);
+}
+
+static void gestureTimerFired(void *) {
+    portENTER_CRITICAL(&producerMux);
+    bool posted = edge_queue_push(&edgeQueue, SI_GESTURE_TICK, 0, micros());
+    portEXIT_CRITICAL(&producerMux);
+
+    // A lost tick would stall the hold, so retry once the loop has drained
+    if (!posted) esp_timer_start_once(gestureTimer, 1000);
+}
+
+// Arm the one-shot timer for the earliest pending repeat, or leave it
+// stopped when neither button is held
+static void armGestureTimer(uint32_t nowMs) {
+    esp_timer_stop(gestureTimer);
+
+    const Gesture *next = NULL;
+    if (gUp.held) next = &gUp;
+    if (gDown.held && (!next || (int32_t)(gDown.nextMs - next->nextMs) < 0)) next = &gDown;
+    if (!next) return;
+
+    int32_t waitMs = (int32_t)(next->nextMs - nowMs);
+    if (waitMs < 1) waitMs = 1;
+    esp_timer_start_once(gestureTimer, (uint64_t)waitMs * 1000ULL);
+}
+
+// Fire a due auto-repeat, or end the hold if the button was let go.
+// Release is sampled only when the timer reports a deadline, so no CHANGE
+// interrupt or per-pass polling is needed while the button is up.
+static int buttonRepeat(int pin, Gesture *g, uint32_t t) {
+    if (!gesture_due(g, t)) return 0;
+    if (digitalRead(pin) == HIGH) {
+        gesture_release(g);
+        return 0;
+    }
+    return gesture_repeat(g, t);
+}
 
 static void displayMessages(void) {
     lcd_set_cursor(0, 0);
@@ -51,33 +107,69 @@ void scroll_interrupt_setup(void) {
     attachInterrupt(digitalPinToInterrupt(SI_SCROLL_UP),   isr_up,   FALLING);
     attachInterrupt(digitalPinToInterrupt(SI_SCROLL_DOWN), isr_down, FALLING);
 
+    gesture_init(&gUp);
+    gesture_init(&gDown);
+
+    const esp_timer_create_args_t timerArgs = {
+        .callback = gestureTimerFired,
+        .arg      = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name     = "gesture",
+        .skip_unhandled_events = false,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timerArgs, &gestureTimer));
+
     displayMessages();
     Serial.println(messages[currentIndex]);
 }
 
 void scroll_interrupt_loop(void) {
-    unsigned long t = millis();
-    bool changed = false;
-
-    if (upPressed) {
-        upPressed = false;
-        if (t - lastUpMs >= SI_DEBOUNCE_MS) {
-            lastUpMs = t;
-            currentIndex = (currentIndex - 1 + NUM_MESSAGES) % NUM_MESSAGES;
-            Serial.print("Up: "); Serial.println(messages[currentIndex]);
-            changed = true;
+    EdgeEvent events[SI_BATCH];
+    int n = edge_queue_drain(&edgeQueue, events, SI_BATCH);
+    uint32_t nowMs = millis();
+    int steps = 0;
+    bool rearm = false;
+
+    // Debounce on each edge's own ISR timestamp, so presses that queued up
+    // while the LCD was busy still count individually
+    for (int i = 0; i < n; i++) {
+        uint32_t t = events[i].timestamp_us;
+
+        if (events[i].pin == SI_SCROLL_UP) {
+            if (t - lastUpUs >= SI_DEBOUNCE_MS * 1000UL) {
+                lastUpUs = t;
+                gesture_press(&gUp, nowMs);
+                rearm = true;
+                steps--;
+            }
+        } else if (events[i].pin == SI_SCROLL_DOWN) {
+            if (t - lastDownUs >= SI_DEBOUNCE_MS * 1000UL) {
+                lastDownUs = t;
+                gesture_press(&gDown, nowMs);
+                rearm = true;
+                steps++;
+            }
+        } else if (events[i].pin == SI_GESTURE_TICK) {
+            // A deadline passed: repeat or release, then re-arm below
+            steps -= buttonRepeat(SI_SCROLL_UP,   &gUp,   nowMs);
+            steps += buttonRepeat(SI_SCROLL_DOWN, &gDown, nowMs);
+            rearm = true;
         }
     }
 
-    if (downPressed) {
-        downPressed = false;
-        if (t - lastDownMs >= SI_DEBOUNCE_MS) {
-            lastDownMs = t;
-            currentIndex = (currentIndex + 1) % NUM_MESSAGES;
-            Serial.print("Down: "); Serial.println(messages[currentIndex]);
-            changed = true;
-        }
+    if (rearm) armGestureTimer(nowMs);
+
+    uint32_t overflows = edge_queue_overflows(&edgeQueue);
+    if (overflows != reportedOverflows) {
+        reportedOverflows = overflows;
+        Serial.printf("Edge queue overflows: %u\n", (unsigned)overflows);
     }
 
-    if (changed) displayMessages();
+    // One LCD refresh per batch / repeat
+    if (steps != 0) {
+        currentIndex = ((currentIndex + steps) % NUM_MESSAGES + NUM_MESSAGES) % NUM_MESSAGES;
+        Serial.printf("%s %d: %s\n", steps < 0 ? "Up" : "Down",
+                      steps < 0 ? -steps : steps, messages[currentIndex]);
+        displayMessages();
+    }
 }
@@ -1,5 +1,6 @@
 #include "scroll_polling.h"
 #include "lcd.h"
+#include "gesture.h"
 #include <Arduino.h>
 
 #define SP_RS          42
@@ -24,6 +25,11 @@ static int currentIndex = 0;
 static unsigned long lastUpMs = 0;
 static unsigned long lastDownMs = 0;
 static int prevUp, prevDown;
+static Gesture gUp, gDown;
+
+static void scrollBy(int steps) {
+    currentIndex = ((currentIndex + steps) % NUM_MESSAGES + NUM_MESSAGES) % NUM_MESSAGES;
+}
 
 static void displayMessages(void) {
     lcd_set_cursor(0, 0);
@@ -44,6 +50,9 @@ void scroll_polling_setup(void) {
     prevUp   = digitalRead(SP_SCROLL_UP);
     prevDown = digitalRead(SP_SCROLL_DOWN);
 
+    gesture_init(&gUp);
+    gesture_init(&gDown);
+
     displayMessages();
     Serial.println(messages[currentIndex]);
 }
@@ -52,24 +61,33 @@ void scroll_polling_loop(void) {
     int up   = digitalRead(SP_SCROLL_UP);
     int down = digitalRead(SP_SCROLL_DOWN);
     unsigned long t = millis();
-    bool changed = false;
+    int steps = 0;
 
     // Falling edge = button pressed (active-low with pull-up)
     if (prevUp == HIGH && up == LOW && t - lastUpMs >= SP_DEBOUNCE_MS) {
         lastUpMs = t;
-        currentIndex = (currentIndex - 1 + NUM_MESSAGES) % NUM_MESSAGES;
-        Serial.print("Up: "); Serial.println(messages[currentIndex]);
-        changed = true;
+        gesture_press(&gUp, t);
+        steps--;
     }
 
     if (prevDown == HIGH && down == LOW && t - lastDownMs >= SP_DEBOUNCE_MS) {
         lastDownMs = t;
-        currentIndex = (currentIndex + 1) % NUM_MESSAGES;
-        Serial.print("Down: "); Serial.println(messages[currentIndex]);
-        changed = true;
+        gesture_press(&gDown, t);
+        steps++;
     }
 
-    if (changed) displayMessages();
+    // Released: stop repeating; held: fire any due auto-repeat
+    if (up == HIGH)   gesture_release(&gUp);
+    if (down == HIGH) gesture_release(&gDown);
+    steps -= gesture_repeat(&gUp, t);
+    steps += gesture_repeat(&gDown, t);
+
+    if (steps != 0) {
+        scrollBy(steps);
+        Serial.printf("%s %d: %s\n", steps < 0 ? "Up" : "Down",
+                      steps < 0 ? -steps : steps, messages[currentIndex]);
+        displayMessages();
+    }
 
     prevUp   = up;
     prevDown = down;
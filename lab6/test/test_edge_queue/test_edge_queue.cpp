@@ -0,0 +1,101 @@
+// Host test for the ISR -> loop edge queue: a producer thread stands in
+// for the GPIO ISR and pushes as fast as it can while the main thread
+// drains in batches, as the experiment loops do.
+//
+// Run: pio test -e native
+
+#include <unity.h>
+#include <atomic>
+#include <thread>
+
+#include "edge_queue.h"
+
+#define PRODUCER_PUSHES 1000000u
+#define DRAIN_BATCH 8
+
+static EdgeQueue queue;
+
+void setUp(void) {
+    queue = EdgeQueue();
+}
+
+void tearDown(void) {}
+
+// Fills and empties the ring without a second thread: the push after the
+// last free slot is refused and counted
+static void test_full_queue_counts_overflow(void) {
+    for (uint32_t i = 0; i < EDGE_QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(edge_queue_push(&queue, 1, 2, i));
+    }
+    TEST_ASSERT_FALSE(edge_queue_push(&queue, 1, 2, EDGE_QUEUE_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(1, edge_queue_overflows(&queue));
+
+    EdgeEvent out[EDGE_QUEUE_SIZE];
+    TEST_ASSERT_EQUAL_INT(EDGE_QUEUE_SIZE, edge_queue_drain(&queue, out, EDGE_QUEUE_SIZE));
+    for (uint32_t i = 0; i < EDGE_QUEUE_SIZE; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, out[i].timestamp_us);
+    }
+    TEST_ASSERT_EQUAL_INT(0, edge_queue_drain(&queue, out, EDGE_QUEUE_SIZE));
+}
+
+// Each push carries its attempt number as the timestamp, and pin/edge
+// derived from it, so a torn or reordered record shows up in the drain.
+// The producer yields once every 48 pushes, at a shifting point, so it
+// pushes in bursts (a bouncing contact) of varying length, some longer
+// than the ring, and the two sides also interleave on a single-core host
+static void test_concurrent_producer(void) {
+    std::atomic<bool> done(false);
+    uint32_t accepted = 0;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < PRODUCER_PUSHES; i++) {
+            if (edge_queue_push(&queue, (uint8_t)i, (uint8_t)(i >> 8), i)) {
+                accepted++;
+            }
+            if (i % 48 == (i / 48) % 48) {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint32_t drained = 0;
+    uint32_t last = 0;
+    bool first = true;
+    EdgeEvent out[DRAIN_BATCH];
+    for (;;) {
+        // Read the flag first, so a final drain after it sees every push
+        bool finished = done.load(std::memory_order_acquire);
+        int n = edge_queue_drain(&queue, out, DRAIN_BATCH);
+        for (int k = 0; k < n; k++) {
+            uint32_t seq = out[k].timestamp_us;
+            TEST_ASSERT_EQUAL_UINT8((uint8_t)seq, out[k].pin);
+            TEST_ASSERT_EQUAL_UINT8((uint8_t)(seq >> 8), out[k].edge);
+            if (!first) {
+                TEST_ASSERT_TRUE_MESSAGE(seq > last, "events out of order");
+            }
+            last = seq;
+            first = false;
+        }
+        drained += (uint32_t)n;
+        if (finished && n == 0) {
+            break;
+        }
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(accepted, drained);
+    TEST_ASSERT_EQUAL_UINT32(PRODUCER_PUSHES, drained + edge_queue_overflows(&queue));
+}
+
+int main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_full_queue_counts_overflow);
+    RUN_TEST(test_concurrent_producer);
+    return UNITY_END();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+// ── Bit-parallel (vertical counter) debouncer ────────────────────────────────
+// Debounces up to 32 inputs at once. Bit i of each word belongs to input i,
+// and every input has a 2-bit counter spread across ct0/ct1 ("vertical").
+// An input's debounced level flips only after it has differed from the
+// stable level for 4 consecutive ticks; any agreeing sample resets its
+// counter. One tick is a handful of ALU operations for all 32 inputs.
+// Host tests and a cycles-per-tick comparison with the old per-pin loop
+// live in test/test_debounce*; run them with `pio test -e native`.
+
+typedef struct {
+    uint32_t state;      // Debounced levels (1 = HIGH)
+    uint32_t ct0, ct1;   // Vertical 2-bit counters
+    uint32_t pressed;    // HIGH → LOW transitions from the last tick
+    uint32_t released;   // LOW → HIGH transitions from the last tick
+} Debouncer;
+
+static inline void debounce_reset(Debouncer *d, uint32_t levels) {
+    d->state    = levels;
+    d->ct0      = ~0u;
+    d->ct1      = ~0u;
+    d->pressed  = 0;
+    d->released = 0;
+}
+
+static inline void debounce_tick(Debouncer *d, uint32_t sample) {
+    uint32_t delta = sample ^ d->state;      // Inputs that disagree
+    d->ct0 = ~(d->ct0 & delta);              // Count, or reset to 11
+    d->ct1 = d->ct0 ^ (d->ct1 & delta);
+    uint32_t toggle = delta & d->ct0 & d->ct1; // Rolled over after 4 ticks
+    d->state ^= toggle;
+    d->pressed  = toggle & ~d->state;        // Buttons are active-low
+    d->released = toggle &  d->state;
+}
+
+// ── Button set on one GPIO bank ──────────────────────────────────────────────
+// Samples the whole GPIO input register once per tick (GPIO 0–31 or 32–48,
+// all pins of a set must share a bank) and calls millis() once per poll.
+
+#define DEBOUNCE_TICK_MS 12   // 4 stable ticks ≈ the former 50 ms window
+
+typedef struct {
+    uint8_t   bank;          // 0: GPIO_IN_REG, 1: GPIO_IN1_REG
+    uint32_t  mask;          // Bits of this set's pins in the bank word
+    uint32_t  lastTickMs;
+    Debouncer deb;
+} ButtonSet;
+
+void     buttons_begin(ButtonSet *b, const uint8_t *pins, int count);
+void     buttons_poll(ButtonSet *b);
+uint32_t gpio_bank_read(uint8_t bank);
+
+static inline uint32_t button_bit(uint8_t pin) { return 1u << (pin & 31); }
+
+// True on the tick where the button's debounced level went LOW
+static inline bool button_pressed(const ButtonSet *b, uint8_t pin) {
+    return (b->deb.pressed & button_bit(pin)) != 0;
+}
+
+// True while the debounced level is LOW
+static inline bool button_held(const ButtonSet *b, uint8_t pin) {
+    return (b->deb.state & button_bit(pin)) == 0;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+void debounce_bench_setup(void);
+void debounce_bench_loop(void);
@@ -0,0 +1,38 @@
+#include <Arduino.h>
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "debounce.hpp"
+
+uint32_t gpio_bank_read(uint8_t bank) {
+    return bank ? REG_READ(GPIO_IN1_REG) : REG_READ(GPIO_IN_REG);
+}
+
+void buttons_begin(ButtonSet *b, const uint8_t *pins, int count) {
+    b->bank = pins[0] >> 5;
+    b->mask = 0;
+    for (int i = 0; i < count; i++) {
+        pinMode(pins[i], INPUT_PULLUP);
+        if ((pins[i] >> 5) != b->bank) {
+            Serial.printf("buttons: GPIO %u not on bank %u, ignored\n", pins[i], b->bank);
+            continue;
+        }
+        b->mask |= button_bit(pins[i]);
+    }
+
+    // Start from "all released" like the old per-button HIGH defaults
+    debounce_reset(&b->deb, ~0u);
+    b->lastTickMs = millis();
+}
+
+void buttons_poll(ButtonSet *b) {
+    uint32_t now = millis();
+
+    // Edges are reported for exactly one poll
+    b->deb.pressed  = 0;
+    b->deb.released = 0;
+    if (now - b->lastTickMs < DEBOUNCE_TICK_MS) return;
+    b->lastTickMs = now;
+
+    // Unused bits are forced HIGH so they never report presses
+    debounce_tick(&b->deb, gpio_bank_read(b->bank) | ~b->mask);
+}
@@ -0,0 +1,71 @@
+#include <Arduino.h>
+#include "debounce.hpp"
+#include "debounce_bench.hpp"
+
+// ── Debouncer cost benchmark ─────────────────────────────────────────────────
+// Prints the average CPU cycles per debounce tick for:
+//   legacy   – the former per-button buttons_update() (digitalRead + millis
+//              per button, four arrays per button)
+//   vertical – one GPIO_IN_REG snapshot + vertical-counter tick (32 inputs)
+// Cycles come from the Xtensa CCOUNT register via ESP.getCycleCount().
+// test/test_debounce_bench runs the same comparison on the host.
+
+#define BENCH_ITERS  10000
+#define LEGACY_COUNT 3
+#define DEBOUNCE_MS  50
+
+static const uint8_t BENCH_PINS[LEGACY_COUNT] = {10, 11, 12};
+
+// ── Legacy per-button debouncer (verbatim from the motor experiments) ────────
+static unsigned long debounce_timer[LEGACY_COUNT];
+static bool          raw_state[LEGACY_COUNT];
+static bool          stable_state[LEGACY_COUNT];
+static bool          prev_stable[LEGACY_COUNT];
+
+static void legacy_update(void) {
+    unsigned long now = millis();
+    for (int i = 0; i < LEGACY_COUNT; i++) {
+        bool raw = (bool)digitalRead(BENCH_PINS[i]);
+        if (raw != raw_state[i]) {
+            raw_state[i]      = raw;
+            debounce_timer[i] = now;
+        }
+        prev_stable[i] = stable_state[i];
+        if ((now - debounce_timer[i]) >= DEBOUNCE_MS) {
+            stable_state[i] = raw_state[i];
+        }
+    }
+}
+
+static Debouncer deb;
+
+void debounce_bench_setup(void) {
+    Serial.begin(115200);
+    for (int i = 0; i < LEGACY_COUNT; i++) {
+        pinMode(BENCH_PINS[i], INPUT_PULLUP);
+        raw_state[i] = stable_state[i] = prev_stable[i] = HIGH;
+        debounce_timer[i] = 0;
+    }
+    debounce_reset(&deb, ~0u);
+}
+
+void debounce_bench_loop(void) {
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < BENCH_ITERS; i++) legacy_update();
+    uint32_t legacy = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < BENCH_ITERS; i++) debounce_tick(&deb, gpio_bank_read(0));
+    uint32_t vertical = ESP.getCycleCount() - start;
+
+    // Keep the results observable so the loops are not optimised away
+    volatile uint32_t sink = deb.state ^ (uint32_t)stable_state[0];
+    (void)sink;
+
+    Serial.printf("legacy:   %5.1f cycles/tick (%d buttons, %.1f per button)\n",
+                  (float)legacy / BENCH_ITERS, LEGACY_COUNT,
+                  (float)legacy / BENCH_ITERS / LEGACY_COUNT);
+    Serial.printf("vertical: %5.1f cycles/tick (32 inputs incl. register read)\n",
+                  (float)vertical / BENCH_ITERS);
+    delay(2000);
+}
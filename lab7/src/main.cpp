@@ -6,6 +6,7 @@
 // #define EXPERIMENT_SERVO_MOTOR
 // #define EXPERIMENT_STEPPER_MOTOR
 #define EXPERIMENT_STEPPER_CHAR
+// #define EXPERIMENT_DEBOUNCE_BENCH
 // ─────────────────────────────────────────────────────────────────────────────
 
 #if defined(EXPERIMENT_DC_H_BRIDGE_MOTOR)
@@ -33,6 +34,11 @@
     #define EXP_SETUP  stepper_char_setup
     #define EXP_LOOP   stepper_char_loop
 
+#elif defined(EXPERIMENT_DEBOUNCE_BENCH)
+    #include "debounce_bench.hpp"
+    #define EXP_SETUP  debounce_bench_setup
+    #define EXP_LOOP   debounce_bench_loop
+
 #else
     #error "No experiment selected. Uncomment one #define above."
 #endif
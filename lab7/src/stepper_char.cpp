@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include "debounce.hpp"
 #include "stepper_char.hpp"
 
 // ── Stepper pin definitions ───────────────────────────────────────────────────
@@ -64,45 +65,25 @@ static const uint32_t PERIODS_US[] = {
 #define SPEED_LEVELS  (sizeof(PERIODS_US) / sizeof(PERIODS_US[0]))
 
 // ── Debounce ──────────────────────────────────────────────────────────────────
-#define DEBOUNCE_MS 50
 #define BTN_COUNT   3
 
 static const uint8_t BTN_PINS[BTN_COUNT] = {
     PIN_BTN_UP, PIN_BTN_DOWN, PIN_BTN_STARTSTOP
 };
 
-static unsigned long debounce_timer[BTN_COUNT];
-static bool          raw_state[BTN_COUNT];
-static bool          stable_state[BTN_COUNT];
-static bool          prev_stable[BTN_COUNT];
+// One register snapshot + vertical-counter tick covers all buttons
+static ButtonSet buttons;
 
 static void buttons_init(void) {
-    for (int i = 0; i < BTN_COUNT; i++) {
-        pinMode(BTN_PINS[i], INPUT_PULLUP);
-        raw_state[i]      = HIGH;
-        stable_state[i]   = HIGH;
-        prev_stable[i]    = HIGH;
-        debounce_timer[i] = 0;
-    }
+    buttons_begin(&buttons, BTN_PINS, BTN_COUNT);
 }
 
 static void buttons_update(void) {
-    unsigned long now = millis();
-    for (int i = 0; i < BTN_COUNT; i++) {
-        bool raw = (bool)digitalRead(BTN_PINS[i]);
-        if (raw != raw_state[i]) {
-            raw_state[i]      = raw;
-            debounce_timer[i] = now;
-        }
-        prev_stable[i] = stable_state[i];
-        if ((now - debounce_timer[i]) >= DEBOUNCE_MS) {
-            stable_state[i] = raw_state[i];
-        }
-    }
+    buttons_poll(&buttons);
 }
 
 static bool btn_just_pressed(int idx) {
-    return (stable_state[idx] == LOW && prev_stable[idx] == HIGH);
+    return button_pressed(&buttons, BTN_PINS[idx]);
 }
 
 // ── Coil output helpers ───────────────────────────────────────────────────────
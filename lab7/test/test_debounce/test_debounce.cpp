@@ -0,0 +1,102 @@
+// Host tests for the vertical-counter debouncer in debounce.hpp.
+//
+// Run: pio test -e native -f test_debounce
+
+#include <unity.h>
+
+#include "debounce.hpp"
+
+#define ALL_HIGH 0xFFFFFFFFu
+#define BIT0 (1u << 0)
+#define BIT5 (1u << 5)
+
+static Debouncer deb;
+
+void setUp(void) {
+    debounce_reset(&deb, ALL_HIGH);
+}
+
+void tearDown(void) {}
+
+// Feeds the same sample n times and returns the presses seen
+static int feed(uint32_t sample, int n, uint32_t bit) {
+    int presses = 0;
+    for (int i = 0; i < n; i++) {
+        debounce_tick(&deb, sample);
+        if (deb.pressed & bit) presses++;
+    }
+    return presses;
+}
+
+// The level flips on the 4th differing sample, not before, and the edge
+// is reported for that one tick only
+static void test_rollover_after_four_samples(void) {
+    for (int i = 0; i < 3; i++) {
+        debounce_tick(&deb, ALL_HIGH & ~BIT0);
+        TEST_ASSERT_EQUAL_UINT32(ALL_HIGH, deb.state);
+        TEST_ASSERT_EQUAL_UINT32(0, deb.pressed);
+    }
+    debounce_tick(&deb, ALL_HIGH & ~BIT0);
+    TEST_ASSERT_EQUAL_UINT32(ALL_HIGH & ~BIT0, deb.state);
+    TEST_ASSERT_EQUAL_UINT32(BIT0, deb.pressed);
+    TEST_ASSERT_EQUAL_UINT32(0, deb.released);
+
+    debounce_tick(&deb, ALL_HIGH & ~BIT0);
+    TEST_ASSERT_EQUAL_UINT32(0, deb.pressed);
+
+    // Back up: again four samples
+    for (int i = 0; i < 3; i++) {
+        debounce_tick(&deb, ALL_HIGH);
+        TEST_ASSERT_EQUAL_UINT32(ALL_HIGH & ~BIT0, deb.state);
+    }
+    debounce_tick(&deb, ALL_HIGH);
+    TEST_ASSERT_EQUAL_UINT32(ALL_HIGH, deb.state);
+    TEST_ASSERT_EQUAL_UINT32(BIT0, deb.released);
+    TEST_ASSERT_EQUAL_UINT32(0, deb.pressed);
+}
+
+// One agreeing sample restarts the count
+static void test_agreeing_sample_resets_counter(void) {
+    TEST_ASSERT_EQUAL_INT(0, feed(ALL_HIGH & ~BIT0, 3, BIT0));
+    TEST_ASSERT_EQUAL_INT(0, feed(ALL_HIGH, 1, BIT0));
+    TEST_ASSERT_EQUAL_INT(0, feed(ALL_HIGH & ~BIT0, 3, BIT0));
+    TEST_ASSERT_EQUAL_UINT32(ALL_HIGH, deb.state);
+    TEST_ASSERT_EQUAL_INT(1, feed(ALL_HIGH & ~BIT0, 1, BIT0));
+}
+
+// A bouncing press and release give exactly one press and one release,
+// and an input that stays HIGH alongside it never changes
+static void test_press_release_under_bounce(void) {
+    static const uint8_t press_bounce[] = {0, 1, 0, 0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0};
+    static const uint8_t release_bounce[] = {1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1};
+    int presses = 0, releases = 0;
+
+    for (unsigned i = 0; i < sizeof(press_bounce); i++) {
+        debounce_tick(&deb, press_bounce[i] ? ALL_HIGH : ALL_HIGH & ~BIT5);
+        if (deb.pressed & BIT5) presses++;
+        if (deb.released) releases++;
+        TEST_ASSERT_EQUAL_UINT32(0, deb.pressed & ~BIT5);
+    }
+    TEST_ASSERT_EQUAL_INT(1, presses);
+    TEST_ASSERT_EQUAL_UINT32(ALL_HIGH & ~BIT5, deb.state);
+
+    for (unsigned i = 0; i < sizeof(release_bounce); i++) {
+        debounce_tick(&deb, release_bounce[i] ? ALL_HIGH : ALL_HIGH & ~BIT5);
+        if (deb.pressed) presses++;
+        if (deb.released & BIT5) releases++;
+        TEST_ASSERT_EQUAL_UINT32(0, deb.released & ~BIT5);
+    }
+    TEST_ASSERT_EQUAL_INT(1, presses);
+    TEST_ASSERT_EQUAL_INT(1, releases);
+    TEST_ASSERT_EQUAL_UINT32(ALL_HIGH, deb.state);
+}
+
+int main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_rollover_after_four_samples);
+    RUN_TEST(test_agreeing_sample_resets_counter);
+    RUN_TEST(test_press_release_under_bounce);
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+// Host cycles-per-tick comparison of the two debouncers, the off-target
+// counterpart of EXPERIMENT_DEBOUNCE_BENCH (src/debounce_bench.cpp):
+//   legacy   – the former per-button loop (digitalRead + millis per
+//              button, four arrays per button), for 3 and 32 buttons
+//   vertical – debounce_tick() over all 32 inputs of a bank word
+// digitalRead() and millis() are host stand-ins reading a simulated
+// bouncing bank, so both sides see the same inputs. Cycles are TSC ticks
+// on x86 (ns elsewhere); only the ratio means anything.
+//
+// Run: pio test -e native -f test_debounce_bench -v
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "debounce.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t bench_cycles(void) { return __rdtsc(); }
+#define CYCLE_UNIT "TSC cycles"
+#else
+static inline uint64_t bench_cycles(void) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#define CYCLE_UNIT "ns"
+#endif
+
+#define BENCH_ITERS 200000
+#define BENCH_RUNS 5
+#define MAX_BUTTONS 32
+#define DEBOUNCE_MS 50
+
+// ── Simulated GPIO bank ──────────────────────────────────────────────────────
+// The bouncing input stream is generated up front; each timed iteration
+// only loads its word, the same for every debouncer and the empty loop
+static uint32_t stream[BENCH_ITERS];
+static volatile uint32_t bank_levels = 0xFFFFFFFFu;
+static volatile unsigned long fake_ms = 0;
+
+static int digitalRead(uint8_t pin) { return (bank_levels >> pin) & 1; }
+static unsigned long millis(void) { return fake_ms; }
+
+// Every 64 ticks a few inputs chatter for 8 ticks, then settle on the
+// opposite level
+static void make_stream(void) {
+    uint32_t levels = 0xFFFFFFFFu;
+    for (uint32_t i = 0; i < BENCH_ITERS; i++) {
+        uint32_t phase = i & 63;
+        uint32_t chatter = 0x00010421u << (i >> 6 & 7);
+        if (phase < 8) {
+            levels ^= (i & 1) ? chatter : 0;
+        } else if (phase == 8) {
+            levels = (i >> 6 & 1) ? 0xFFFFFFFFu : ~chatter;
+        }
+        stream[i] = levels;
+    }
+}
+
+static inline void bank_step(uint32_t i) {
+    bank_levels = stream[i];
+    fake_ms = fake_ms + 12;
+}
+
+// ── Legacy per-button debouncer (as in src/debounce_bench.cpp) ───────────────
+static unsigned long debounce_timer[MAX_BUTTONS];
+static bool          raw_state[MAX_BUTTONS];
+static bool          stable_state[MAX_BUTTONS];
+static bool          prev_stable[MAX_BUTTONS];
+
+static void legacy_reset(void) {
+    for (int i = 0; i < MAX_BUTTONS; i++) {
+        raw_state[i] = stable_state[i] = prev_stable[i] = true;
+        debounce_timer[i] = 0;
+    }
+}
+
+static void legacy_update(int count) {
+    unsigned long now = millis();
+    for (int i = 0; i < count; i++) {
+        bool raw = (bool)digitalRead((uint8_t)i);
+        if (raw != raw_state[i]) {
+            raw_state[i]      = raw;
+            debounce_timer[i] = now;
+        }
+        prev_stable[i] = stable_state[i];
+        if ((now - debounce_timer[i]) >= DEBOUNCE_MS) {
+            stable_state[i] = raw_state[i];
+        }
+    }
+}
+
+static double bench_empty(void) {
+    fake_ms = 0;
+    uint64_t t0 = bench_cycles();
+    for (uint32_t i = 0; i < BENCH_ITERS; i++) {
+        bank_step(i);
+    }
+    return (double)(bench_cycles() - t0) / BENCH_ITERS;
+}
+
+static double bench_legacy(int count) {
+    legacy_reset();
+    fake_ms = 0;
+    uint64_t t0 = bench_cycles();
+    for (uint32_t i = 0; i < BENCH_ITERS; i++) {
+        bank_step(i);
+        legacy_update(count);
+    }
+    return (double)(bench_cycles() - t0) / BENCH_ITERS;
+}
+
+static double bench_vertical(uint32_t *presses) {
+    Debouncer deb;
+    debounce_reset(&deb, 0xFFFFFFFFu);
+    fake_ms = 0;
+    uint32_t count = 0;
+    uint64_t t0 = bench_cycles();
+    for (uint32_t i = 0; i < BENCH_ITERS; i++) {
+        bank_step(i);
+        debounce_tick(&deb, bank_levels);
+        count += deb.pressed != 0;
+    }
+    double cycles = (double)(bench_cycles() - t0) / BENCH_ITERS;
+    *presses = count;
+    return cycles;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Best of a few runs, less the loop that only steps the bank
+static void test_cycles_per_tick(void) {
+    make_stream();
+    double empty = 1e30, legacy3 = 1e30, legacy32 = 1e30, vertical = 1e30;
+    uint32_t presses = 0;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        double t;
+        if ((t = bench_empty()) < empty) empty = t;
+        if ((t = bench_legacy(3)) < legacy3) legacy3 = t;
+        if ((t = bench_legacy(MAX_BUTTONS)) < legacy32) legacy32 = t;
+        if ((t = bench_vertical(&presses)) < vertical) vertical = t;
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line), "legacy 3 pins %.1f, legacy 32 pins %.1f, vertical 32 pins %.1f "
+             CYCLE_UNIT " per tick (loop overhead %.1f subtracted)",
+             legacy3 - empty, legacy32 - empty, vertical - empty, empty);
+    TEST_MESSAGE(line);
+
+    // The simulated bank does press buttons, so the loop did real work
+    TEST_ASSERT_TRUE(presses > 0);
+}
+
+int main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_cycles_per_tick);
+    return UNITY_END();
+}